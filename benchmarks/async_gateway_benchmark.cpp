@@ -0,0 +1,61 @@
+#include <benchmark/benchmark.h>
+#include "async_order_gateway.h"
+#include "order.h"
+#include "order_events.h"
+#include "orderbook.h"
+#include "tradehistory.h"
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace ob;
+
+// ============================================================================
+// ASYNC GATEWAY - producers -> ingress ring -> matching thread -> response ring
+// ============================================================================
+
+constexpr int kAsyncOrdersPerIteration = 100'000;
+
+// state.range(0) producer threads split the orders between them, alternating resting sells
+// with buys that cross them. The benchmark thread drains the response ring, so an iteration
+// ends once every order has been matched.
+static void BM_AsyncGateway_Throughput(benchmark::State& state) {
+    const int producers = static_cast<int>(state.range(0));
+    AsyncOrderGateway<> gateway(std::make_unique<OrderBook>(), std::make_unique<RingTradeHistory>(1024));
+    gateway.start();
+
+    OrderId nextId = 1;
+    for (auto _ : state) {
+        std::vector<std::thread> threads;
+        const int perProducer = kAsyncOrdersPerIteration / producers;
+        for (int p = 0; p < producers; ++p) {
+            OrderId firstId = nextId + static_cast<OrderId>(p * perProducer);
+            threads.emplace_back([&gateway, firstId, perProducer] {
+                for (int i = 0; i < perProducer; ++i) {
+                    OrderSide side = (i % 2 == 0) ? OrderSide::Sell : OrderSide::Buy;
+                    gateway.submitOrder(OrderRequest{firstId + i, 0, OrderType::Limit, side,
+                                                     TimeInForce::GoodTillCancel, 100, 10});
+                }
+            });
+        }
+
+        OrderResult result;
+        for (int received = 0; received < perProducer * producers; ) {
+            if (gateway.pollResponse(result)) {
+                ++received;
+            }
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        nextId += static_cast<OrderId>(perProducer * producers);
+    }
+
+    gateway.stop();
+    state.SetItemsProcessed(state.iterations() * kAsyncOrdersPerIteration);
+}
+BENCHMARK(BM_AsyncGateway_Throughput)
+    ->Arg(1)->Arg(2)->Arg(4)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
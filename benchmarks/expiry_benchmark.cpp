@@ -0,0 +1,113 @@
+#include <benchmark/benchmark.h>
+#include "matching_engine.h"
+#include "order.h"
+#include "orderbook.h"
+#include "tradehistory.h"
+#include "utils/object_pool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using namespace ob;
+
+// ============================================================================
+// EXPIRY - a million good-till-date orders expiring as the clock moves
+// ============================================================================
+
+enum class ExpiryMode {
+    Wheel,  // advanceTime: the book's ExpiryWheel hands over exactly the orders that are due
+    Scan    // what the wheel replaces: walk the order index for expired orders at every step
+};
+
+constexpr std::uint32_t kExpiryOrders = 1'000'000;
+constexpr Timestamp kExpiryHorizon = 1'000'000'000;     // expiries fall anywhere in the first second (ns)
+constexpr int kExpirySteps = 100;
+
+// 1M resting buys over 100k levels, each with a random expiry, then the clock moves to the end
+// of the horizon in kExpirySteps equal steps. Only the steps are timed; slowest_step_ms is the
+// longest the matching thread was held up in one go.
+template <ExpiryMode Mode>
+static void BM_Expiry_1M(benchmark::State& state) {
+    std::vector<Timestamp> expiries(kExpiryOrders);
+    std::mt19937_64 rng(42);
+    for (Timestamp& expiry : expiries) {
+        expiry = 1 + rng() % kExpiryHorizon;
+    }
+
+    ObjectPool pool(kExpiryOrders);
+    std::vector<OrderId> due;
+    double slowest = 0;
+    for (auto _ : state) {
+        LadderOrderBook book{PriceBand{1, 100'000, 1}, kExpiryOrders};
+        TradeHistory history;
+        LadderMatchingEngine engine(book, history);
+        for (std::uint32_t i = 0; i < kExpiryOrders; ++i) {
+            OrderPointer order = ObjectPool::allocate(i, OrderType::Limit, OrderSide::Buy, TimeInForce::GoodTillDate,
+                                                      1 + i % 100'000, 10);
+            order->setExpireTime(expiries[i]);
+            engine.onNewOrder(order);
+        }
+
+        double seconds = 0;
+        std::size_t expired = 0;
+        for (int step = 1; step <= kExpirySteps; ++step) {
+            const Timestamp now = kExpiryHorizon / kExpirySteps * step;
+            auto start = std::chrono::steady_clock::now();
+            if constexpr (Mode == ExpiryMode::Wheel) {
+                expired += engine.advanceTime(now);
+            } else {
+                due.clear();
+                for (const auto& [id, order] : book.getOrders()) {
+                    if (order->getExpireTime() <= now) {
+                        due.push_back(id);
+                    }
+                }
+                engine.onCancelOrders(due);
+                expired += due.size();
+            }
+            auto end = std::chrono::steady_clock::now();
+            double stepSeconds = std::chrono::duration<double>(end - start).count();
+            seconds += stepSeconds;
+            slowest = std::max(slowest, stepSeconds);
+        }
+        state.SetIterationTime(seconds);
+        if (expired != kExpiryOrders) {
+            state.SkipWithError("not every order expired");
+        }
+    }
+    state.counters["slowest_step_ms"] = slowest * 1e3;
+    state.SetItemsProcessed(state.iterations() * kExpiryOrders);
+}
+BENCHMARK_TEMPLATE(BM_Expiry_1M, ExpiryMode::Wheel)->UseManualTime()->Iterations(3)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_Expiry_1M, ExpiryMode::Scan)->UseManualTime()->Iterations(3)->Unit(benchmark::kMillisecond);
+
+// Scheduling cost on the insert path: the same 1M orders resting as GoodTillCancel or GoodTillDate
+template <TimeInForce Tif>
+static void BM_Expiry_Rest1M(benchmark::State& state) {
+    ObjectPool pool(kExpiryOrders);
+    std::mt19937_64 rng(42);
+    for (auto _ : state) {
+        state.PauseTiming();
+        {
+            LadderOrderBook book{PriceBand{1, 100'000, 1}, kExpiryOrders};
+            TradeHistory history;
+            LadderMatchingEngine engine(book, history);
+            state.ResumeTiming();
+            for (std::uint32_t i = 0; i < kExpiryOrders; ++i) {
+                OrderPointer order = ObjectPool::allocate(i, OrderType::Limit, OrderSide::Buy, Tif, 1 + i % 100'000, 10);
+                if constexpr (Tif == TimeInForce::GoodTillDate) {
+                    order->setExpireTime(1 + rng() % kExpiryHorizon);
+                }
+                engine.onNewOrder(order);
+            }
+            state.PauseTiming();
+        }
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * kExpiryOrders);
+}
+BENCHMARK_TEMPLATE(BM_Expiry_Rest1M, TimeInForce::GoodTillCancel)->Iterations(3)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_Expiry_Rest1M, TimeInForce::GoodTillDate)->Iterations(3)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,74 @@
+#include <benchmark/benchmark.h>
+#include "journal.h"
+#include "matching_engine.h"
+#include "order.h"
+#include "orderbook.h"
+#include "tradehistory.h"
+
+#include <filesystem>
+#include <string>
+
+using namespace ob;
+
+// ============================================================================
+// JOURNAL - appending inbound events and replaying them into a fresh book
+// ============================================================================
+
+constexpr OrderId kJournalEvents = 1'000'000;
+
+static std::string benchmarkJournalPath() {
+    return (std::filesystem::temp_directory_path() / "orderbook_benchmark.journal").string();
+}
+
+// Every third event crosses a resting order, every tenth cancels one, the rest add depth
+static JournalRecord journalEvent(OrderId id) {
+    if (id % 10 == 0) {
+        return JournalRecord::cancelOrder(id - 7);
+    }
+    OrderSide side = (id % 3 == 0) ? OrderSide::Buy : OrderSide::Sell;
+    Price price = (side == OrderSide::Buy) ? 1100 : 1000 + static_cast<Price>(id % 100);
+    Order order { id, OrderType::Limit, side, TimeInForce::GoodTillCancel, price, 10 };
+    return JournalRecord::newOrder(order);
+}
+
+static void writeJournal(const std::string& path, OrderId events) {
+    std::filesystem::remove(path);
+    JournalWriter journal(path);
+    for (OrderId id = 1; id <= events; ++id) {
+        journal.append(journalEvent(id));
+    }
+}
+
+static void BM_Journal_Append(benchmark::State& state) {
+    std::string path = benchmarkJournalPath();
+    for (auto _ : state) {
+        writeJournal(path, kJournalEvents);
+    }
+    std::filesystem::remove(path);
+    state.SetItemsProcessed(state.iterations() * kJournalEvents);
+}
+BENCHMARK(BM_Journal_Append)->Unit(benchmark::kMillisecond);
+
+// items_per_second is the replay rate in events per second
+static void BM_Journal_Replay(benchmark::State& state) {
+    std::string path = benchmarkJournalPath();
+    writeJournal(path, kJournalEvents);
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto book = std::make_unique<OrderBook>(kJournalEvents);
+        auto history = std::make_unique<RingTradeHistory>(1 << 16);
+        BasicMatchingEngine<OrderBook, RingTradeHistory> engine(*book, *history);
+        JournalReader reader(path);
+        state.ResumeTiming();
+
+        benchmark::DoNotOptimize(replayJournal(reader, engine));
+
+        state.PauseTiming();
+        book.reset();
+        state.ResumeTiming();
+    }
+    std::filesystem::remove(path);
+    state.SetItemsProcessed(state.iterations() * kJournalEvents);
+}
+BENCHMARK(BM_Journal_Replay)->Unit(benchmark::kMillisecond);
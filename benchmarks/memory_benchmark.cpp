@@ -0,0 +1,87 @@
+#include <benchmark/benchmark.h>
+#include "execution_report.h"
+#include "matching_engine.h"
+#include "order.h"
+#include "orderbook.h"
+#include "utils/engine_memory.h"
+#include "utils/object_pool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using namespace ob;
+
+// ============================================================================
+// STARTUP - the first million orders into a freshly built engine
+// ============================================================================
+
+enum class StartupMemory {
+    Default,        // nothing reserved: arena, index and levels grow as orders arrive
+    Reserved,       // capacity reserved up front on the ordinary heap
+    HugePages       // reserved up front in pre-faulted, locked transparent huge pages
+};
+
+constexpr std::uint32_t kStartupOrders = 1'000'000;
+
+// Three orders in four rest, spread over a wide band so the index and the ladder both fill up;
+// every fourth order crosses the best level. Each iteration runs on a new thread, so the order
+// arena starts empty as it would at the open. Reports per-order latency percentiles.
+template <StartupMemory Memory>
+static void BM_Startup_FirstMillionOrders(benchmark::State& state) {
+    const MemoryConfig previous = memoryConfig();
+    if constexpr (Memory == StartupMemory::HugePages) {
+        configureMemory({ HugePages::Transparent, true, true });
+    }
+    constexpr bool reserve = Memory != StartupMemory::Default;
+
+    std::vector<std::uint32_t> latencies(kStartupOrders);
+    double p50 = 0, p99 = 0, p999 = 0, worst = 0;
+    MemoryFootprint footprint;
+    for (auto _ : state) {
+        double seconds = 0;
+        std::thread([&] {
+            ObjectPool pool(reserve ? kStartupOrders : 10);
+            LadderOrderBook book{PriceBand{1, 200'000, 1}, reserve ? kStartupOrders : LadderOrderBook::kDefaultCapacityHint};
+            RingExecutionSink sink(1 << 20);
+            BasicMatchingEngine<LadderOrderBook, RingExecutionSink> engine(book, sink);
+
+            for (std::uint32_t i = 0; i < kStartupOrders; ++i) {
+                OrderSide side = i % 2 == 0 ? OrderSide::Buy : OrderSide::Sell;
+                // Buys rest in [1, 100'000], sells in [100'001, 200'000]; a crossing order takes the best level
+                Price price = side == OrderSide::Buy ? 1 + (i * 7919u) % 100'000 : 100'001 + (i * 7919u) % 100'000;
+                if (i % 4 == 3) {
+                    price = side == OrderSide::Buy ? 200'000 : 1;
+                }
+                // Allocation counts too: the first touch of an arena slot is part of the cost
+                auto start = std::chrono::steady_clock::now();
+                engine.onNewOrder(ObjectPool::allocate(i, OrderType::Limit, side, TimeInForce::GoodTillCancel, price, 10));
+                auto end = std::chrono::steady_clock::now();
+                latencies[i] = static_cast<std::uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+                seconds += std::chrono::duration<double>(end - start).count();
+            }
+            footprint = memoryFootprint();
+        }).join();
+        state.SetIterationTime(seconds);
+
+        std::sort(latencies.begin(), latencies.end());
+        p50 = latencies[kStartupOrders / 2];
+        p99 = latencies[kStartupOrders / 100 * 99];
+        p999 = latencies[kStartupOrders / 1000 * 999];
+        worst = latencies.back();
+    }
+
+    configureMemory(previous);
+    state.counters["p50_ns"] = p50;
+    state.counters["p99_ns"] = p99;
+    state.counters["p999_ns"] = p999;
+    state.counters["max_ns"] = worst;
+    state.counters["mapped_MB"] = static_cast<double>(footprint.mappedBytes >> 20);
+    state.counters["locked_MB"] = static_cast<double>(footprint.lockedBytes >> 20);
+    state.SetItemsProcessed(state.iterations() * kStartupOrders);
+}
+BENCHMARK_TEMPLATE(BM_Startup_FirstMillionOrders, StartupMemory::Default)->UseManualTime()->Iterations(3)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_Startup_FirstMillionOrders, StartupMemory::Reserved)->UseManualTime()->Iterations(3)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_Startup_FirstMillionOrders, StartupMemory::HugePages)->UseManualTime()->Iterations(3)->Unit(benchmark::kMillisecond);
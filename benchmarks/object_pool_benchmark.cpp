@@ -0,0 +1,86 @@
+#include <benchmark/benchmark.h>
+#include "order.h"
+#include "utils/mpsc_queue.h"
+#include "utils/object_pool.h"
+#include "utils/thread_utils.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace ob;
+
+// ============================================================================
+// ORDER POOL - per-thread arenas, orders handed back across threads in batches
+// ============================================================================
+
+constexpr int kPoolBurst = 64;
+
+// Every benchmark thread allocates and releases a burst of orders on its own arena; with no
+// shared state the time per order should not move as threads are added
+static void BM_Pool_LocalAllocRelease(benchmark::State& state) {
+    ObjectPool pool(kPoolBurst);
+    std::vector<OrderPointer> orders(kPoolBurst);
+
+    OrderId orderId = 0;
+    for (auto _ : state) {
+        for (OrderPointer& order : orders) {
+            order = ObjectPool::allocate(orderId++, OrderType::Limit, OrderSide::Buy, TimeInForce::GoodTillCancel, 100, 10);
+        }
+        for (OrderPointer order : orders) {
+            ObjectPool::release(order);
+        }
+        benchmark::DoNotOptimize(orders.data());
+    }
+    state.SetItemsProcessed(state.iterations() * kPoolBurst);
+}
+BENCHMARK(BM_Pool_LocalAllocRelease)->ThreadRange(1, 4)->UseRealTime();
+
+constexpr int kPoolOrdersPerIteration = 100'000;
+
+// state.range(0) producer threads allocate orders and pass them through a queue to the benchmark
+// thread, which releases them: the gateway-allocates, matching-thread-frees pattern. Producers
+// keep reusing the slots that come back to them, so their arenas stop growing after warm-up.
+static void BM_Pool_CrossThreadRelease(benchmark::State& state) {
+    const int producers = static_cast<int>(state.range(0));
+    const int perProducer = kPoolOrdersPerIteration / producers;
+    MpscQueue<OrderPointer> queue(4096);
+
+    for (auto _ : state) {
+        std::atomic<bool> released { false };
+        std::vector<std::thread> threads;
+        for (int p = 0; p < producers; ++p) {
+            threads.emplace_back([&queue, &released, perProducer] {
+                unsigned idleSpins = 0;
+                for (int i = 0; i < perProducer; ++i) {
+                    OrderPointer order = ObjectPool::allocate(i, OrderType::Limit, OrderSide::Buy, TimeInForce::GoodTillCancel, 100, 10);
+                    while (!queue.tryPush(order)) {
+                        backoff(idleSpins);
+                    }
+                }
+                // The arena has to outlive its orders, so stay until all of them are back
+                while (!released.load(std::memory_order_acquire)) {
+                    backoff(idleSpins);
+                }
+            });
+        }
+
+        OrderPointer order;
+        for (int received = 0; received < perProducer * producers; ) {
+            if (queue.tryPop(order)) {
+                ObjectPool::release(order);
+                ++received;
+            }
+        }
+        ObjectPool::flushReleases();
+        released.store(true, std::memory_order_release);
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * perProducer * producers);
+}
+BENCHMARK(BM_Pool_CrossThreadRelease)
+    ->Arg(1)->Arg(2)->Arg(4)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
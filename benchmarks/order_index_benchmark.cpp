@@ -0,0 +1,73 @@
+#include <benchmark/benchmark.h>
+#include "orderbook.h"
+#include "utils/flat_hash_map.h"
+
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+using namespace ob;
+
+// ============================================================================
+// ORDER ID INDEX - OrderIndex (flat, linear probing) vs std::unordered_map
+// ============================================================================
+
+constexpr std::size_t kLiveOrders = 1'000'000;
+
+// Any non-null pointer works as a value, the benchmarks never dereference it
+static OrderPointer fakeOrder(OrderId id) {
+    return reinterpret_cast<OrderPointer>((id + 1) * alignof(Order));
+}
+
+template <typename Index>
+static Index makeIndex() {
+    if constexpr (std::is_same_v<Index, OrderIndex>) {
+        return Index{kLiveOrders};
+    } else {
+        Index index;
+        index.reserve(kLiveOrders);
+        return index;
+    }
+}
+
+// Lookups of random live ids, as cancelOrder does
+template <typename Index>
+static void BM_OrderIndex_Find(benchmark::State& state) {
+    Index index = makeIndex<Index>();
+    for (OrderId id = 0; id < kLiveOrders; ++id) {
+        index.emplace(id, fakeOrder(id));
+    }
+
+    std::mt19937_64 rng(7);
+    std::vector<OrderId> ids(4096);
+    for (auto& id : ids) {
+        id = rng() % kLiveOrders;
+    }
+
+    std::size_t i = 0;
+    for (auto _ : state) {
+        auto it = index.find(ids[i++ & 4095]);
+        benchmark::DoNotOptimize(it->second);
+    }
+}
+BENCHMARK_TEMPLATE(BM_OrderIndex_Find, OrderIndex);
+BENCHMARK_TEMPLATE(BM_OrderIndex_Find, std::unordered_map<OrderId, OrderPointer>);
+
+// Steady state churn: the oldest order leaves and a new one arrives, 1M stay live
+template <typename Index>
+static void BM_OrderIndex_Churn(benchmark::State& state) {
+    Index index = makeIndex<Index>();
+    OrderId next = 0;
+    for (; next < kLiveOrders; ++next) {
+        index.emplace(next, fakeOrder(next));
+    }
+
+    OrderId oldest = 0;
+    for (auto _ : state) {
+        index.erase(index.find(oldest++));
+        index.emplace(next, fakeOrder(next));
+        ++next;
+    }
+}
+BENCHMARK_TEMPLATE(BM_OrderIndex_Churn, OrderIndex);
+BENCHMARK_TEMPLATE(BM_OrderIndex_Churn, std::unordered_map<OrderId, OrderPointer>);
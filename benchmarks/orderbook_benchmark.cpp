@@ -5,13 +5,28 @@
 #include "utils/object_pool.h"
 #include "tradehistory.h"
 
+#include <array>
+#include <limits>
+#include <vector>
+
 using namespace ob;
 
+// Ladder books cover every price the benchmarks below use
+template <typename Book>
+static Book makeBook() {
+    if constexpr (std::is_same_v<Book, LadderOrderBook>) {
+        return Book{PriceBand{1, 100'000, 1}};
+    } else {
+        return Book{};
+    }
+}
+
 // Single order add to empty book
+template <typename Book>
 static void BM_AddOrder_Empty(benchmark::State& state) {
-    OrderBook book;
+    Book book = makeBook<Book>();
     TradeHistory history;
-    MatchingEngine engine(book, history);
+    BasicMatchingEngine<Book> engine(book, history);
     ObjectPool pool(10);
     
     int order_id = 0;
@@ -28,13 +43,15 @@ static void BM_AddOrder_Empty(benchmark::State& state) {
         benchmark::DoNotOptimize(order);
     }
 }
-BENCHMARK(BM_AddOrder_Empty);
+BENCHMARK_TEMPLATE(BM_AddOrder_Empty, OrderBook);
+BENCHMARK_TEMPLATE(BM_AddOrder_Empty, LadderOrderBook);
 
 // Single order add with existing orders (no match)
+template <typename Book>
 static void BM_AddOrder_NoMatch(benchmark::State& state) {
-    OrderBook book;
+    Book book = makeBook<Book>();
     TradeHistory history;
-    MatchingEngine engine(book, history);
+    BasicMatchingEngine<Book> engine(book, history);
     ObjectPool pool(10);
     
     for (int i = 0; i < 50; ++i) {
@@ -63,13 +80,15 @@ static void BM_AddOrder_NoMatch(benchmark::State& state) {
         benchmark::DoNotOptimize(buy);
     }
 }
-BENCHMARK(BM_AddOrder_NoMatch);
+BENCHMARK_TEMPLATE(BM_AddOrder_NoMatch, OrderBook);
+BENCHMARK_TEMPLATE(BM_AddOrder_NoMatch, LadderOrderBook);
 
 // Single order match (best case - instant fill)
+template <typename Book>
 static void BM_Match_SingleLevel(benchmark::State& state) {
-    OrderBook book;
+    Book book = makeBook<Book>();
     TradeHistory history;
-    MatchingEngine engine(book, history);
+    BasicMatchingEngine<Book> engine(book, history);
     ObjectPool pool(10);
     
     int buy_id = 1000;
@@ -96,13 +115,15 @@ static void BM_Match_SingleLevel(benchmark::State& state) {
         benchmark::DoNotOptimize(buy);
     }
 }
-BENCHMARK(BM_Match_SingleLevel);
+BENCHMARK_TEMPLATE(BM_Match_SingleLevel, OrderBook);
+BENCHMARK_TEMPLATE(BM_Match_SingleLevel, LadderOrderBook);
 
 // Match across multiple price levels and add to book
+template <typename Book, ValidationLevel Checks = ValidationLevel::Debug>
 static void BM_Match_MultiLevel(benchmark::State& state) {
-    OrderBook book;
+    Book book = makeBook<Book>();
     TradeHistory history;
-    MatchingEngine engine(book, history);
+    BasicMatchingEngine<Book, TradeHistory, Checks> engine(book, history);
     ObjectPool pool(10);
     
     int order_id = 0;
@@ -138,7 +159,9 @@ static void BM_Match_MultiLevel(benchmark::State& state) {
         benchmark::DoNotOptimize(buy);
     }
 }
-BENCHMARK(BM_Match_MultiLevel);
+BENCHMARK_TEMPLATE(BM_Match_MultiLevel, OrderBook);
+BENCHMARK_TEMPLATE(BM_Match_MultiLevel, LadderOrderBook);
+BENCHMARK_TEMPLATE(BM_Match_MultiLevel, OrderBook, ValidationLevel::Full);
 
 // Market order execution
 static void BM_MarketOrder(benchmark::State& state) {
@@ -181,10 +204,11 @@ static void BM_MarketOrder(benchmark::State& state) {
 BENCHMARK(BM_MarketOrder);
 
 // IOC (Immediate-or-Cancel) order
+template <ValidationLevel Checks>
 static void BM_IOC_Order(benchmark::State& state) {
     OrderBook book;
     TradeHistory history;
-    MatchingEngine engine(book, history);
+    BasicMatchingEngine<OrderBook, TradeHistory, Checks> engine(book, history);
     ObjectPool pool(10);
     
     int order_id = 0;
@@ -218,7 +242,48 @@ static void BM_IOC_Order(benchmark::State& state) {
         benchmark::DoNotOptimize(ioc_buy);
     }
 }
-BENCHMARK(BM_IOC_Order);
+BENCHMARK_TEMPLATE(BM_IOC_Order, ValidationLevel::Debug);
+BENCHMARK_TEMPLATE(BM_IOC_Order, ValidationLevel::Full);
+
+// FOK that cannot fill against a deep book: pure feasibility check, the book is left untouched
+template <typename Book>
+static void BM_FOK_Reject_DeepBook(benchmark::State& state) {
+    int num_levels = state.range(0);        // 10, 50
+    int orders_per_level = state.range(1);  // 100, 1000
+
+    Book book = makeBook<Book>();
+    TradeHistory history;
+    BasicMatchingEngine<Book> engine(book, history);
+    ObjectPool pool(num_levels * orders_per_level);
+
+    int order_id = 0;
+    for (int level = 0; level < num_levels; ++level) {
+        for (int i = 0; i < orders_per_level; ++i) {
+            book.addOrder(pool.allocate(order_id++, OrderType::Limit, OrderSide::Sell, TimeInForce::GoodTillCancel, 100 + level, 10));
+        }
+    }
+
+    for (auto _ : state) {
+        auto fok_buy = pool.allocate(
+            order_id++,
+            OrderType::Limit,
+            OrderSide::Buy,
+            TimeInForce::FillOrKill,
+            100 + num_levels,
+            num_levels * orders_per_level * 10 + 1  // one more than the whole book
+        );
+        engine.onNewOrder(fok_buy);
+        benchmark::DoNotOptimize(fok_buy);
+    }
+}
+BENCHMARK_TEMPLATE(BM_FOK_Reject_DeepBook, OrderBook)
+    ->Args({10, 100})
+    ->Args({10, 1000})
+    ->Args({50, 1000});
+BENCHMARK_TEMPLATE(BM_FOK_Reject_DeepBook, LadderOrderBook)
+    ->Args({10, 100})
+    ->Args({10, 1000})
+    ->Args({50, 1000});
 
 // Cancel operation
 static void BM_Cancel_Order(benchmark::State& state) {
@@ -251,6 +316,90 @@ static void BM_Cancel_Order(benchmark::State& state) {
 }
 BENCHMARK(BM_Cancel_Order);
 
+// Cancel from the middle of a deep price level, topping the level back up off the clock
+template <typename Book>
+static void BM_Cancel_DeepLevel(benchmark::State& state) {
+    int depth = state.range(0);    // 100, 1000, 10000
+
+    Book book = makeBook<Book>();
+    TradeHistory history;
+    BasicMatchingEngine<Book> engine(book, history);
+    ObjectPool pool(10);
+
+    int order_id = 0;
+    for (; order_id < depth; ++order_id) {
+        book.addOrder(pool.allocate(order_id, OrderType::Limit, OrderSide::Buy, TimeInForce::GoodTillCancel, 100, 100));
+    }
+
+    // Ids are cancelled in the order they were added, so the target always sits depth / 2 deep
+    int cancel_id = depth / 2;
+    for (auto _ : state) {
+        engine.onCancelOrder(cancel_id++);
+
+        state.PauseTiming();
+        book.addOrder(pool.allocate(order_id++, OrderType::Limit, OrderSide::Buy, TimeInForce::GoodTillCancel, 100, 100));
+        state.ResumeTiming();
+    }
+}
+BENCHMARK_TEMPLATE(BM_Cancel_DeepLevel, OrderBook)
+    ->Arg(100)
+    ->Arg(1000)
+    ->Arg(10000);
+BENCHMARK_TEMPLATE(BM_Cancel_DeepLevel, LadderOrderBook)
+    ->Arg(100)
+    ->Arg(1000)
+    ->Arg(10000);
+
+enum class BulkCancel {
+    OneByOne,       // onCancelOrders with every id
+    Everything,     // onMassCancel with an empty filter
+    Participant     // onMassCancel of one participant's orders, interleaved with another's
+};
+
+constexpr int kBulkCancelOrders = 100'000;
+
+// Cancels 100k resting buys spread over 1000 levels, rebuilding the book off the clock
+template <typename Book, BulkCancel Mode>
+static void BM_MassCancel_100k(benchmark::State& state) {
+    Book book = makeBook<Book>();
+    TradeHistory history;
+    BasicMatchingEngine<Book> engine(book, history);
+    // The participant run rests a second, untouched order behind every one it cancels
+    constexpr int resting = Mode == BulkCancel::Participant ? 2 * kBulkCancelOrders : kBulkCancelOrders;
+    ObjectPool pool(resting);
+
+    std::vector<OrderId> ids(kBulkCancelOrders);
+    for (auto _ : state) {
+        state.PauseTiming();
+        engine.onMassCancel({});
+        for (int i = 0; i < resting; ++i) {
+            OrderPointer order = pool.allocate(i, OrderType::Limit, OrderSide::Buy, TimeInForce::GoodTillCancel,
+                                               1000 + (i / 2) % 1000, 100);
+            order->setParticipant(1 + i % 2);
+            book.addOrder(order);
+        }
+        for (int i = 0; i < kBulkCancelOrders; ++i) {
+            ids[i] = Mode == BulkCancel::Participant ? 2 * i : i;
+        }
+        state.ResumeTiming();
+
+        if constexpr (Mode == BulkCancel::OneByOne) {
+            engine.onCancelOrders(ids);
+        } else if constexpr (Mode == BulkCancel::Everything) {
+            benchmark::DoNotOptimize(engine.onMassCancel({}));
+        } else {
+            benchmark::DoNotOptimize(engine.onMassCancel({ std::nullopt, 0, std::numeric_limits<Price>::max(), 1 }));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * kBulkCancelOrders);
+}
+BENCHMARK_TEMPLATE(BM_MassCancel_100k, OrderBook, BulkCancel::OneByOne)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_MassCancel_100k, OrderBook, BulkCancel::Everything)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_MassCancel_100k, OrderBook, BulkCancel::Participant)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_MassCancel_100k, LadderOrderBook, BulkCancel::OneByOne)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_MassCancel_100k, LadderOrderBook, BulkCancel::Everything)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_MassCancel_100k, LadderOrderBook, BulkCancel::Participant)->Unit(benchmark::kMillisecond);
+
 // OrderGateway validation (checks overhead)
 static void BM_Gateway_Validation(benchmark::State& state) {
     OrderBook book;
@@ -279,17 +428,290 @@ static void BM_Gateway_Validation(benchmark::State& state) {
 }
 BENCHMARK(BM_Gateway_Validation);
 
+// Packets of state.range(0) orders through submitOrders, alternating resting sells with buys
+// that fill them, so at most one order rests between packets. Compare items_per_second.
+static void BM_Gateway_SubmitBatch(benchmark::State& state) {
+    const std::size_t batchSize = static_cast<std::size_t>(state.range(0));
+    OrderBook book;
+    RingTradeHistory history(1024);
+    BasicMatchingEngine<OrderBook, RingTradeHistory> engine(book, history);
+    BasicOrderGateway<BasicMatchingEngine<OrderBook, RingTradeHistory>> gateway(engine);
+    ObjectPool pool(batchSize);
+
+    std::vector<OrderPointer> orders(batchSize);
+    std::vector<OrderResult> results(batchSize);
+    OrderId orderId = 0;
+
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < batchSize; ++i, ++orderId) {
+            OrderSide side = (orderId % 2 == 0) ? OrderSide::Sell : OrderSide::Buy;
+            orders[i] = pool.allocate(orderId, OrderType::Limit, side, TimeInForce::GoodTillCancel, 100, 100);
+        }
+        gateway.submitOrders(orders, results);
+        benchmark::DoNotOptimize(results.data());
+    }
+    state.SetItemsProcessed(state.iterations() * batchSize);
+}
+BENCHMARK(BM_Gateway_SubmitBatch)
+    ->Arg(1)
+    ->Arg(8)
+    ->Arg(64)
+    ->Arg(512);
+
+// Market-maker flow against 1000 resting bids over 10 levels: every iteration changes one order,
+// three times in four shrinking it by one lot at its price, otherwise repricing it a tick (and
+// topping it back up). Amend does it in place; CancelReplace is the old cancel + new order route.
+struct AmendStep {
+    std::size_t slot;
+    Price price;
+    Quantity quantity;
+};
+
+class AmendFlow {
+public:
+    static constexpr std::size_t kOrders = 1000;
+
+    template <typename Gateway>
+    void seed(Gateway& gateway, ObjectPool& pool) {
+        for (std::size_t i = 0; i < kOrders; ++i) {
+            prices_[i] = static_cast<Price>(90 + i % 10);
+            quantities_[i] = 1000;
+            ids_[i] = nextId_++;
+            gateway.submitOrder(pool.allocate(ids_[i], OrderType::Limit, OrderSide::Buy, TimeInForce::GoodTillCancel, prices_[i], quantities_[i]));
+        }
+    }
+
+    AmendStep next() {
+        std::size_t slot = step_ % kOrders;
+        if (step_++ % 4 != 3 && quantities_[slot] > 1) {
+            --quantities_[slot];
+        } else {
+            prices_[slot] = prices_[slot] % 2 == 0 ? prices_[slot] + 1 : prices_[slot] - 1;
+            quantities_[slot] = 1000;
+        }
+        return { slot, prices_[slot], quantities_[slot] };
+    }
+
+    OrderId& idOf(std::size_t slot) { return ids_[slot]; }
+    OrderId newId() { return nextId_++; }
+
+private:
+    std::array<OrderId, kOrders> ids_ {};
+    std::array<Price, kOrders> prices_ {};
+    std::array<Quantity, kOrders> quantities_ {};
+    std::size_t step_ = 0;
+    OrderId nextId_ = 0;
+};
+
+template <typename Book>
+static void BM_Amend_Flow(benchmark::State& state) {
+    Book book = makeBook<Book>();
+    TradeHistory history;
+    BasicMatchingEngine<Book> engine(book, history);
+    BasicOrderGateway<BasicMatchingEngine<Book>> gateway(engine);
+    ObjectPool pool(AmendFlow::kOrders);
+    AmendFlow flow;
+    flow.seed(gateway, pool);
+
+    for (auto _ : state) {
+        AmendStep step = flow.next();
+        benchmark::DoNotOptimize(gateway.amendOrder(flow.idOf(step.slot), step.price, step.quantity));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_Amend_Flow, OrderBook);
+BENCHMARK_TEMPLATE(BM_Amend_Flow, LadderOrderBook);
+
+template <typename Book>
+static void BM_CancelReplace_Flow(benchmark::State& state) {
+    Book book = makeBook<Book>();
+    TradeHistory history;
+    BasicMatchingEngine<Book> engine(book, history);
+    BasicOrderGateway<BasicMatchingEngine<Book>> gateway(engine);
+    ObjectPool pool(AmendFlow::kOrders);
+    AmendFlow flow;
+    flow.seed(gateway, pool);
+
+    for (auto _ : state) {
+        AmendStep step = flow.next();
+        OrderId& id = flow.idOf(step.slot);
+        gateway.cancelOrder(id);
+        id = flow.newId();
+        benchmark::DoNotOptimize(gateway.submitOrder(
+            pool.allocate(id, OrderType::Limit, OrderSide::Buy, TimeInForce::GoodTillCancel, step.price, step.quantity)));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_CancelReplace_Flow, OrderBook);
+BENCHMARK_TEMPLATE(BM_CancelReplace_Flow, LadderOrderBook);
+
+// Fills against a book holding state.range(0) dormant stops, half buy stops far above the market
+// and half sell stops far below it. Every trade checks the trigger book, so this should not move
+// with the number of stops.
+template <typename Book>
+static void seedDormantStops(Book& book, std::int64_t count, OrderId firstId) {
+    for (std::int64_t i = 0; i < count; ++i) {
+        bool buy = i % 2 == 0;
+        OrderPointer stop = ObjectPool::allocate(firstId + i, OrderType::Stop, buy ? OrderSide::Buy : OrderSide::Sell,
+                                                 TimeInForce::GoodTillCancel, 1, 10);
+        stop->setStopPrice(buy ? static_cast<Price>(1000 + i % 5000) : static_cast<Price>(1 + i % 50));
+        book.getStops().add(stop);
+    }
+}
+
+template <typename Book>
+static void BM_Match_DormantStops(benchmark::State& state) {
+    Book book = makeBook<Book>();
+    TradeHistory history;
+    BasicMatchingEngine<Book> engine(book, history);
+    ObjectPool pool(static_cast<std::uint32_t>(state.range(0) + 10));
+    seedDormantStops(book, state.range(0), 1'000'000'000);
+
+    OrderId orderId = 0;
+    for (auto _ : state) {
+        engine.onNewOrder(pool.allocate(orderId++, OrderType::Limit, OrderSide::Sell, TimeInForce::GoodTillCancel, 100, 100));
+        auto buy = pool.allocate(orderId++, OrderType::Limit, OrderSide::Buy, TimeInForce::GoodTillCancel, 100, 100);
+        engine.onNewOrder(buy);
+        benchmark::DoNotOptimize(buy);
+    }
+}
+BENCHMARK_TEMPLATE(BM_Match_DormantStops, OrderBook)->Arg(0)->Arg(100'000);
+BENCHMARK_TEMPLATE(BM_Match_DormantStops, LadderOrderBook)->Arg(0)->Arg(100'000);
+
+// One trade that triggers a stop, which trades in turn, next to 100k stops that stay dormant
+template <typename Book>
+static void BM_Stop_Trigger(benchmark::State& state) {
+    Book book = makeBook<Book>();
+    TradeHistory history;
+    BasicMatchingEngine<Book> engine(book, history);
+    ObjectPool pool(100'010);
+    seedDormantStops(book, 100'000, 1'000'000'000);
+
+    OrderId orderId = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        book.getStops().setLastTradePrice(0);
+        engine.onNewOrder(pool.allocate(orderId++, OrderType::Limit, OrderSide::Sell, TimeInForce::GoodTillCancel, 100, 2));
+        OrderPointer stop = pool.allocate(orderId++, OrderType::Stop, OrderSide::Buy, TimeInForce::GoodTillCancel, 1, 1);
+        stop->setStopPrice(100);
+        engine.onNewOrder(stop);
+        state.ResumeTiming();
+
+        auto buy = pool.allocate(orderId++, OrderType::Limit, OrderSide::Buy, TimeInForce::GoodTillCancel, 100, 1);
+        engine.onNewOrder(buy);
+        benchmark::DoNotOptimize(buy);
+    }
+}
+BENCHMARK_TEMPLATE(BM_Stop_Trigger, OrderBook);
+BENCHMARK_TEMPLATE(BM_Stop_Trigger, LadderOrderBook);
+
+// One buy for half of a level of state.range(0) sells of mixed sizes, so every algorithm other
+// than FIFO has to share it out across the whole level
+template <MatchingAlgorithm Algorithm>
+static void BM_Match_ProRata_DeepLevel(benchmark::State& state) {
+    const int depth = static_cast<int>(state.range(0));
+    OrderBook book;
+    RingTradeHistory history(1024);
+    BasicMatchingEngine<OrderBook, RingTradeHistory> engine(book, history);
+    engine.setMatchingAlgorithm(Algorithm);
+    ObjectPool pool(static_cast<std::uint32_t>(depth + 10));
+
+    OrderId orderId = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        while (!book.getSellOrders().empty()) {
+            book.cancelOrder(book.getSellOrders().begin()->second.front()->getOrderId());
+        }
+        for (int i = 0; i < depth; ++i) {
+            book.addOrder(pool.allocate(orderId++, OrderType::Limit, OrderSide::Sell, TimeInForce::GoodTillCancel, 100, 10 + i % 90));
+        }
+        Quantity half = static_cast<Quantity>(book.getSellOrders().begin()->second.totalQuantity() / 2);
+        auto buy = pool.allocate(orderId++, OrderType::Limit, OrderSide::Buy, TimeInForce::GoodTillCancel, 100, half);
+        state.ResumeTiming();
+
+        engine.onNewOrder(buy);
+        benchmark::DoNotOptimize(buy);
+    }
+    state.SetItemsProcessed(state.iterations() * depth);
+}
+BENCHMARK_TEMPLATE(BM_Match_ProRata_DeepLevel, MatchingAlgorithm::Fifo)->Arg(100)->Arg(1000)->Arg(10000);
+BENCHMARK_TEMPLATE(BM_Match_ProRata_DeepLevel, MatchingAlgorithm::ProRata)->Arg(100)->Arg(1000)->Arg(10000);
+BENCHMARK_TEMPLATE(BM_Match_ProRata_DeepLevel, MatchingAlgorithm::ProRataTopOrder)->Arg(100)->Arg(1000)->Arg(10000);
+
+// A buy sweeping 100 sells from other participants: with prevention on, every fill pays the
+// participant compare but none of them is a self-match
+template <SelfTradePrevention Mode>
+static void BM_Match_SelfTradeCheck(benchmark::State& state) {
+    OrderBook book;
+    RingTradeHistory history(1024);
+    BasicMatchingEngine<OrderBook, RingTradeHistory> engine(book, history);
+    engine.setSelfTradePrevention(Mode);
+    ObjectPool pool(110);
+
+    OrderId orderId = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        for (int i = 0; i < 100; ++i) {
+            auto sell = pool.allocate(orderId++, OrderType::Limit, OrderSide::Sell, TimeInForce::GoodTillCancel, 100 + i / 10, 10);
+            sell->setParticipant(static_cast<ParticipantId>(2 + i % 7));
+            book.addOrder(sell);
+        }
+        auto buy = pool.allocate(orderId++, OrderType::Limit, OrderSide::Buy, TimeInForce::GoodTillCancel, 109, 1000);
+        buy->setParticipant(1);
+        state.ResumeTiming();
+
+        engine.onNewOrder(buy);
+        benchmark::DoNotOptimize(buy);
+    }
+    state.SetItemsProcessed(state.iterations() * 100);
+}
+BENCHMARK_TEMPLATE(BM_Match_SelfTradeCheck, SelfTradePrevention::None);
+BENCHMARK_TEMPLATE(BM_Match_SelfTradeCheck, SelfTradePrevention::CancelResting);
+BENCHMARK_TEMPLATE(BM_Match_SelfTradeCheck, SelfTradePrevention::Decrement);
+
+template <typename Sink>
+static Sink makeSink() {
+    if constexpr (std::is_same_v<Sink, RingTradeHistory> || std::is_same_v<Sink, RingExecutionSink>) {
+        return Sink{1024};
+    } else {
+        return Sink{};
+    }
+}
+
+// A resting sell taken by a buy, reported to each kind of sink: the heap-allocated Trade vector,
+// the trade ring, no reports at all, and the execution-report ring (four reports per iteration)
+template <typename Sink>
+static void BM_Match_ReportSink(benchmark::State& state) {
+    OrderBook book;
+    Sink sink = makeSink<Sink>();
+    BasicMatchingEngine<OrderBook, Sink> engine(book, sink);
+    ObjectPool pool(10);
+
+    OrderId orderId = 0;
+    for (auto _ : state) {
+        engine.onNewOrder(pool.allocate(orderId++, OrderType::Limit, OrderSide::Sell, TimeInForce::GoodTillCancel, 100, 100));
+        auto buy = pool.allocate(orderId++, OrderType::Limit, OrderSide::Buy, TimeInForce::GoodTillCancel, 100, 100);
+        engine.onNewOrder(buy);
+        benchmark::DoNotOptimize(buy);
+    }
+}
+BENCHMARK_TEMPLATE(BM_Match_ReportSink, TradeHistory);
+BENCHMARK_TEMPLATE(BM_Match_ReportSink, RingTradeHistory);
+BENCHMARK_TEMPLATE(BM_Match_ReportSink, NullExecutionSink);
+BENCHMARK_TEMPLATE(BM_Match_ReportSink, RingExecutionSink);
+
 // ============================================================================
 // PARAMETERIZED BENCHMARKS - Test with different sizes
 // ============================================================================
 
 // Varying price levels
+template <typename Book>
 static void BM_Match_VaryLevels(benchmark::State& state) {
     int num_levels = state.range(0);    // 1, 5, 10, 50
     
-    OrderBook book;
+    Book book = makeBook<Book>();
     TradeHistory history;
-    MatchingEngine engine(book, history);
+    BasicMatchingEngine<Book> engine(book, history);
     ObjectPool pool(10);
     
     int order_id = 0;
@@ -325,19 +747,25 @@ static void BM_Match_VaryLevels(benchmark::State& state) {
         benchmark::DoNotOptimize(buy);
     }
 }
-BENCHMARK(BM_Match_VaryLevels)
+BENCHMARK_TEMPLATE(BM_Match_VaryLevels, OrderBook)
+    ->Arg(1)
+    ->Arg(5)
+    ->Arg(10)
+    ->Arg(50);
+BENCHMARK_TEMPLATE(BM_Match_VaryLevels, LadderOrderBook)
     ->Arg(1)
     ->Arg(5)
     ->Arg(10)
     ->Arg(50);
 
 // Vary quantity size
+template <typename Book>
 static void BM_Match_VaryQuantity(benchmark::State& state) {
     int qty = state.range(0);  // 100, 1000, 10000
     
-    OrderBook book;
+    Book book = makeBook<Book>();
     TradeHistory history;
-    MatchingEngine engine(book, history);
+    BasicMatchingEngine<Book> engine(book, history);
     ObjectPool pool(10);
     
     int order_id = 0;
@@ -371,9 +799,123 @@ static void BM_Match_VaryQuantity(benchmark::State& state) {
         benchmark::DoNotOptimize(buy);
     }
 }
-BENCHMARK(BM_Match_VaryQuantity)
+BENCHMARK_TEMPLATE(BM_Match_VaryQuantity, OrderBook)
     ->Arg(100)
     ->Arg(1000)
     ->Arg(10000);
+BENCHMARK_TEMPLATE(BM_Match_VaryQuantity, LadderOrderBook)
+    ->Arg(100)
+    ->Arg(1000)
+    ->Arg(10000);
+
+// ============================================================================
+// TRADE HISTORY
+// ============================================================================
+
+template <typename History>
+static History makeHistory() {
+    if constexpr (std::is_same_v<History, RingTradeHistory>) {
+        return History{1 << 16};
+    } else {
+        return History{};
+    }
+}
+
+// Sweep of 100 resting orders, so each iteration records 100 trades
+template <typename History>
+static void BM_RecordTrades_MultiLevel(benchmark::State& state) {
+    OrderBook book;
+    History history = makeHistory<History>();
+    BasicMatchingEngine<OrderBook, History> engine(book, history);
+    ObjectPool pool(10);
+
+    int order_id = 0;
+
+    for (auto _ : state) {
+        state.PauseTiming();
+
+        for (int level = 0; level < 10; ++level) {
+            for (int i = 0; i < 10; ++i) {
+                book.addOrder(pool.allocate(order_id++, OrderType::Limit, OrderSide::Sell, TimeInForce::GoodTillCancel, 100 + level, 10));
+            }
+        }
+
+        state.ResumeTiming();
+
+        auto buy = pool.allocate(order_id++, OrderType::Limit, OrderSide::Buy, TimeInForce::ImmediateOrCancel, 110, 1000);
+        engine.onNewOrder(buy);
+        benchmark::DoNotOptimize(buy);
+    }
+}
+BENCHMARK_TEMPLATE(BM_RecordTrades_MultiLevel, TradeHistory);
+BENCHMARK_TEMPLATE(BM_RecordTrades_MultiLevel, RingTradeHistory);
+
+// ============================================================================
+// MARKET DEPTH - cached top-N vs aggregating the book on every read
+// ============================================================================
+
+// Book with 1000 sell levels of 5 orders each
+static void fillDepthBook(OrderBook& book) {
+    OrderId id = 0;
+    for (Price price = 1000; price < 2000; ++price) {
+        for (int i = 0; i < 5; ++i) {
+            book.addOrder(ObjectPool::allocate(id++, OrderType::Limit, OrderSide::Sell, TimeInForce::GoodTillCancel, price, 10));
+        }
+    }
+}
+
+static void BM_Depth_TopN_Cached(benchmark::State& state) {
+    OrderBook book;
+    fillDepthBook(book);
+    for (auto _ : state) {
+        std::uint64_t total = 0;
+        for (const DepthLevel& level : book.getSellDepth()) {
+            total += level.quantity;
+        }
+        benchmark::DoNotOptimize(total);
+    }
+}
+BENCHMARK(BM_Depth_TopN_Cached);
+
+static void BM_Depth_TopN_Scan(benchmark::State& state) {
+    OrderBook book;
+    fillDepthBook(book);
+    for (auto _ : state) {
+        std::uint64_t total = 0;
+        std::size_t levels = 0;
+        for (auto it = book.getSellOrders().begin(); it != book.getSellOrders().end() && levels < OrderBook::kDefaultDepthLevels; ++it, ++levels) {
+            // what a consumer had to do before the book kept per-level totals
+            for (OrderPointer order : it->second) {
+                total += order->getRemainingQuantity();
+            }
+        }
+        benchmark::DoNotOptimize(total);
+    }
+}
+BENCHMARK(BM_Depth_TopN_Scan);
+
+// ============================================================================
+// ORDER ALLOCATION
+// ============================================================================
+
+// Bursts of allocations followed by releasing all of them, per order
+static void BM_ObjectPool_Burst(benchmark::State& state) {
+    int burst = state.range(0);    // 1000, 100000
+    ObjectPool pool(burst);
+
+    std::vector<OrderHandle> handles(burst);
+    for (auto _ : state) {
+        for (int i = 0; i < burst; ++i) {
+            handles[i] = pool.allocateHandle(i, OrderType::Limit, OrderSide::Buy, TimeInForce::GoodTillCancel, 100, 100);
+        }
+        for (int i = 0; i < burst; ++i) {
+            pool.release(handles[i]);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * burst);
+}
+BENCHMARK(BM_ObjectPool_Burst)
+    ->Arg(1000)
+    ->Arg(100000);
 
 BENCHMARK_MAIN();
@@ -0,0 +1,48 @@
+#include <benchmark/benchmark.h>
+#include "order.h"
+#include "order_events.h"
+#include "orderbook.h"
+#include "sharded_matching_engine.h"
+#include "tradehistory.h"
+
+#include <memory>
+
+using namespace ob;
+
+// ============================================================================
+// SHARDED ENGINE - throughput from 1 to N shards
+// ============================================================================
+
+constexpr SymbolId kSymbols = 64;
+constexpr int kOrdersPerIteration = 100'000;
+
+// One producer feeds every shard. Orders alternate between a resting sell and a buy that
+// fully crosses it, round-robin over the symbols, so each shard sees the same mix of adds and
+// matches. Scaling tops out at the number of cores (and at the producer's own rate).
+static void BM_Sharded_Throughput(benchmark::State& state) {
+    ShardedEngineConfig config;
+    config.numShards = static_cast<std::size_t>(state.range(0));
+    ShardedMatchingEngine<> engine(config);
+    for (SymbolId symbol = 0; symbol < kSymbols; ++symbol) {
+        engine.addInstrument(symbol, std::make_unique<OrderBook>(), std::make_unique<RingTradeHistory>(1024));
+    }
+    engine.start();
+
+    OrderId nextId = 1;
+    for (auto _ : state) {
+        for (int i = 0; i < kOrdersPerIteration; ++i) {
+            SymbolId symbol = static_cast<SymbolId>((i / 2) % kSymbols);
+            OrderSide side = (i % 2 == 0) ? OrderSide::Sell : OrderSide::Buy;
+            engine.onNewOrder(OrderRequest{nextId++, symbol, OrderType::Limit, side,
+                                           TimeInForce::GoodTillCancel, 100, 10});
+        }
+        engine.waitUntilIdle();
+    }
+
+    engine.stop();
+    state.SetItemsProcessed(state.iterations() * kOrdersPerIteration);
+}
+BENCHMARK(BM_Sharded_Throughput)
+    ->Arg(1)->Arg(2)->Arg(4)->Arg(8)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,75 @@
+#include <benchmark/benchmark.h>
+#include "order.h"
+#include "orderbook.h"
+#include "snapshot.h"
+#include "utils/mapped_file.h"
+
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+
+using namespace ob;
+
+// ============================================================================
+// SNAPSHOT - restart time for a deep book
+// ============================================================================
+
+// Writes a snapshot of orderCount resting orders spread over 1000 levels per side directly,
+// since building a 50M order book first would need twice the memory
+static std::string writeSyntheticSnapshot(std::uint64_t orderCount) {
+    std::string path = (std::filesystem::temp_directory_path() / "orderbook_benchmark.snapshot").string();
+    MappedFile file(path, sizeof(SnapshotHeader) + orderCount * sizeof(SnapshotOrder));
+    auto bytes = file.writableData();
+
+    SnapshotHeader header {};
+    std::memcpy(header.magic, kSnapshotMagic, sizeof(header.magic));
+    header.orderCount = orderCount;
+    std::memcpy(bytes.data(), &header, sizeof(header));
+
+    auto* records = reinterpret_cast<SnapshotOrder*>(bytes.data() + sizeof(SnapshotHeader));
+    std::uint64_t perSide = orderCount / 2;
+    std::uint64_t perLevel = std::max<std::uint64_t>(perSide / 1000, 1);
+    for (std::uint64_t i = 0; i < orderCount; ++i) {
+        bool buy = i < perSide;
+        std::uint64_t rank = buy ? i : i - perSide;
+        Price price = buy ? 10000 - static_cast<Price>(rank / perLevel) : 10001 + static_cast<Price>(rank / perLevel);
+        // Value-initialized, so fields added to the record later start out zeroed
+        SnapshotOrder& record = records[i];
+        record = {};
+        record.orderId = i + 1;
+        record.price = price;
+        record.initialQuantity = 10;
+        record.remainingQuantity = 10;
+        record.orderType = static_cast<std::uint8_t>(OrderType::Limit);
+        record.orderSide = static_cast<std::uint8_t>(buy ? OrderSide::Buy : OrderSide::Sell);
+        record.timeInForce = static_cast<std::uint8_t>(TimeInForce::GoodTillCancel);
+        record.orderStatus = static_cast<std::uint8_t>(OrderStatus::New);
+    }
+    return path;
+}
+
+static void BM_Snapshot_Load(benchmark::State& state) {
+    const auto orderCount = static_cast<std::uint64_t>(state.range(0));
+    std::string path = writeSyntheticSnapshot(orderCount);
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto book = std::make_unique<OrderBook>();
+        state.ResumeTiming();
+
+        benchmark::DoNotOptimize(loadSnapshot(*book, path));
+
+        state.PauseTiming();
+        book.reset();
+        state.ResumeTiming();
+    }
+    std::filesystem::remove(path);
+    state.SetItemsProcessed(state.iterations() * orderCount);
+}
+BENCHMARK(BM_Snapshot_Load)
+    ->Arg(1'000'000)
+    ->Arg(10'000'000)
+    ->Arg(50'000'000)
+    ->Unit(benchmark::kMillisecond)
+    ->Iterations(3);
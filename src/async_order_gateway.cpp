@@ -0,0 +1,232 @@
+#include "async_order_gateway.h"
+
+#include "order_gateway.h"
+#include "utils/object_pool.h"
+
+#include <stdexcept>
+
+namespace ob {
+
+template <typename Book, typename History>
+AsyncOrderGateway<Book, History>::AsyncOrderGateway(std::unique_ptr<Book> book, std::unique_ptr<History> history, AsyncGatewayConfig config)
+    : book_ { std::move(book) }
+    , history_ { std::move(history) }
+    , priceBand_ { book_->getPriceBand() }
+    , config_ { config }
+    , ingress_ { config.ingressCapacity }
+    , responses_ { config.responseCapacity }
+{
+    engine_.emplace(*book_, *history_);
+}
+
+template <typename Book, typename History>
+AsyncOrderGateway<Book, History>::~AsyncOrderGateway() {
+    stop();
+}
+
+template <typename Book, typename History>
+void AsyncOrderGateway<Book, History>::start() {
+    if (started_) {
+        throw std::logic_error("AsyncOrderGateway can only be started once");
+    }
+    started_ = true;
+    running_.store(true, std::memory_order_release);
+    matchingThread_ = std::thread([this] { run(); });
+}
+
+template <typename Book, typename History>
+void AsyncOrderGateway<Book, History>::stop() {
+    // Every caller either sees stopped_ or is counted in enqueuing_ (both seq_cst), so once the
+    // count drains nothing else can reach the ring and the final drain in run() sees it all
+    stopped_.store(true);
+    unsigned idleSpins = 0;
+    while (enqueuing_.load() != 0) {
+        backoff(idleSpins);
+    }
+    running_.store(false, std::memory_order_release);
+    if (matchingThread_.joinable()) {
+        matchingThread_.join();
+    }
+}
+
+template <typename Book, typename History>
+OrderResult AsyncOrderGateway<Book, History>::submitOrder(const OrderRequest& request) {
+    if (auto reason = validateOrder(request.orderType, request.timeInForce, request.price, request.quantity, request.stopPrice,
+                                    request.displayQuantity, request.expireTime);
+        reason != OrderRejectionReason::None) {
+        return {request.orderId, false, reason};
+    }
+
+    // The book itself belongs to the matching thread, and is gone after stop()
+    if (hasLimitPrice(request.orderType) && priceBand_ && !priceBand_->contains(request.price)) {
+        return {request.orderId, false, OrderRejectionReason::InvalidPrice};
+    }
+
+    if (!tryEnqueue(Command{ Command::Kind::NewOrder, request })) {
+        return {request.orderId, false, OrderRejectionReason::Other};
+    }
+    return {request.orderId, true, OrderRejectionReason::None};
+}
+
+template <typename Book, typename History>
+OrderResult AsyncOrderGateway<Book, History>::cancelOrder(OrderId orderId) {
+    OrderRequest request {};
+    request.orderId = orderId;
+    if (!tryEnqueue(Command{ Command::Kind::CancelOrder, request })) {
+        return {orderId, false, OrderRejectionReason::Other};
+    }
+    return {orderId, true, OrderRejectionReason::None};
+}
+
+template <typename Book, typename History>
+bool AsyncOrderGateway<Book, History>::advanceTime(Timestamp now) {
+    OrderRequest request {};
+    request.expireTime = now;
+    return tryEnqueue(Command{ Command::Kind::AdvanceTime, request });
+}
+
+template <typename Book, typename History>
+bool AsyncOrderGateway<Book, History>::setSessionEnd(Timestamp time) {
+    OrderRequest request {};
+    request.expireTime = time;
+    return tryEnqueue(Command{ Command::Kind::SessionEnd, request });
+}
+
+// False once stop() has been called; anything queued before then is matched by the final drain
+template <typename Book, typename History>
+bool AsyncOrderGateway<Book, History>::tryEnqueue(const Command& command) {
+    enqueuing_.fetch_add(1);
+    if (stopped_.load()) {
+        enqueuing_.fetch_sub(1, std::memory_order_release);
+        return false;
+    }
+    // Back-pressure: wait for the matching thread rather than drop the request
+    unsigned idleSpins = 0;
+    while (!ingress_.tryPush(command)) {
+        backoff(idleSpins);
+    }
+    enqueuing_.fetch_sub(1, std::memory_order_release);
+    return true;
+}
+
+template <typename Book, typename History>
+void AsyncOrderGateway<Book, History>::run() {
+    if (config_.pinThread) {
+        pinCurrentThread(config_.cpu);
+    }
+
+    auto handle = [this](const Command& command) {
+        if (command.kind == Command::Kind::AdvanceTime || command.kind == Command::Kind::SessionEnd) {
+            processClock(command);
+            return;
+        }
+        OrderResult result = process(command);
+        // Wait for the reader until stop(): it may never poll again, and stop() itself may be
+        // waiting for a caller blocked on a full ingress ring
+        unsigned idleSpins = 0;
+        while (!responses_.tryPush(result)) {
+            if (stopped_.load(std::memory_order_acquire)) {
+                droppedResponses_.fetch_add(1, std::memory_order_release);
+                break;
+            }
+            backoff(idleSpins);
+        }
+    };
+
+    Command command;
+    unsigned idleSpins = 0;
+    while (true) {
+        if (ingress_.tryPop(command)) {
+            handle(command);
+            idleSpins = 0;
+        } else if (running_.load(std::memory_order_acquire)) {
+            backoff(idleSpins);
+        } else {
+            break;
+        }
+    }
+
+    // Final drain, then free the resting orders while this thread's pool still exists
+    while (ingress_.tryPop(command)) {
+        handle(command);
+    }
+    if (journal_ != nullptr) {
+        try {
+            journal_->flush();
+        } catch (std::exception& e) {
+            // the journal keeps whatever reached the file; stop() has nobody to report to
+        }
+    }
+    engine_.reset();
+    book_.reset();
+}
+
+template <typename Book, typename History>
+OrderResult AsyncOrderGateway<Book, History>::process(const Command& command) {
+    const OrderRequest& request = command.request;
+    try {
+        if (command.kind == Command::Kind::CancelOrder) {
+            if (journal_ != nullptr) {
+                journal_->append(JournalRecord::cancelOrder(request.orderId));
+            }
+            engine_->onCancelOrder(request.orderId);
+            return {request.orderId, true, OrderRejectionReason::None};
+        }
+
+        if (journal_ != nullptr) {
+            journal_->append(JournalRecord::newOrder(request));
+        }
+        OrderPointer order = ObjectPool::allocate(request.orderId, request.orderType, request.orderSide,
+                                                  request.timeInForce, request.price, request.quantity);
+        order->setSymbol(request.symbol);
+        order->setStopPrice(request.stopPrice);
+        order->setDisplayQuantity(request.displayQuantity);
+        order->setParticipant(request.participant);
+        order->setExpireTime(request.expireTime);
+        // A filled or cancelled order is back in the pool when this returns; its outcome comes from status
+        OrderStatus status;
+        if (OrderError error = engine_->onNewOrder(order, status); error != OrderError::None) {
+            ObjectPool::release(order);
+            return {request.orderId, false, error == OrderError::InvalidExpiry ? OrderRejectionReason::InvalidExpiry
+                                                                                : OrderRejectionReason::Other};
+        }
+
+        if ((request.timeInForce == TimeInForce::FillOrKill || request.timeInForce == TimeInForce::ImmediateOrCancel)
+            && status == OrderStatus::Cancelled) {
+            return {request.orderId, false, OrderRejectionReason::InsufficientLiquidity};
+        }
+    } catch (std::exception& e) {
+        return {request.orderId, false, OrderRejectionReason::Other};
+    }
+
+    return {request.orderId, true, OrderRejectionReason::None};
+}
+
+template <typename Book, typename History>
+void AsyncOrderGateway<Book, History>::processClock(const Command& command) {
+    const Timestamp time = command.request.expireTime;
+    try {
+        if (command.kind == Command::Kind::AdvanceTime) {
+            if (journal_ != nullptr) {
+                journal_->append(JournalRecord::advanceTime(time));
+            }
+            engine_->advanceTime(time);
+        } else {
+            if (journal_ != nullptr) {
+                journal_->append(JournalRecord::sessionEnd(time));
+            }
+            engine_->setSessionEnd(time);
+        }
+    } catch (std::exception& e) {
+        // nothing to report to: the clock has no response
+    }
+}
+
+template class AsyncOrderGateway<OrderBook, TradeHistory>;
+template class AsyncOrderGateway<LadderOrderBook, TradeHistory>;
+template class AsyncOrderGateway<OrderBook, RingTradeHistory>;
+template class AsyncOrderGateway<LadderOrderBook, RingTradeHistory>;
+template class AsyncOrderGateway<OrderBook, RingExecutionSink>;
+template class AsyncOrderGateway<LadderOrderBook, RingExecutionSink>;
+
+} // namespace ob
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "journal.h"
+#include "matching_engine.h"
+#include "order.h"
+#include "order_events.h"
+#include "orderbook.h"
+#include "tradehistory.h"
+#include "utils/mpsc_queue.h"
+#include "utils/spsc_queue.h"
+#include "utils/thread_utils.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <thread>
+
+namespace ob {
+
+struct AsyncGatewayConfig {
+    std::size_t ingressCapacity = 1 << 16;    // orders and cancels waiting for the matching thread
+    std::size_t responseCapacity = 1 << 16;   // results waiting for pollResponse
+    bool pinThread = false;
+    unsigned cpu = 0;
+};
+
+// Gateway that decouples order entry from matching. Any number of threads call submitOrder and
+// cancelOrder: requests are validated on the calling thread and rejections are returned right
+// away, while accepted requests go through a lock-free ring to one busy-polling matching thread,
+// which is the only thread that ever touches the book. Every accepted request produces exactly
+// one OrderResult on the response ring once it has been matched:
+//  - accepted for an order that traded or rests, and for a cancel
+//  - InsufficientLiquidity for an IOC/FOK order that was killed
+//  - InvalidExpiry for a GoodTillDate or Day order already past its expiry on the engine clock
+//  - Other if the engine threw
+//
+// The gateway owns its book so that the matching thread can allocate orders from its own
+// ObjectPool and free the resting ones in stop(); the trade history stays readable afterwards.
+template <typename Book = OrderBook, typename History = RingTradeHistory>
+class AsyncOrderGateway {
+public:
+    AsyncOrderGateway(std::unique_ptr<Book> book, std::unique_ptr<History> history, AsyncGatewayConfig config = {});
+    ~AsyncOrderGateway();
+
+    AsyncOrderGateway(const AsyncOrderGateway&) = delete;
+    AsyncOrderGateway& operator=(const AsyncOrderGateway&) = delete;
+
+    // Accepted requests are journaled by the matching thread, in the order they are matched.
+    // Set before start().
+    void setJournal(JournalWriter* journal) { journal_ = journal; }
+
+    void start();
+    // Matches everything already queued, then frees the book on the matching thread. Once it has
+    // been called every request is rejected, and results the response ring has no room for are
+    // dropped (see getDroppedResponses) instead of waiting for a pollResponse that may never come.
+    void stop();
+
+    // Any thread
+    OrderResult submitOrder(const OrderRequest& request);
+    OrderResult cancelOrder(OrderId orderId);
+    // Any thread; queued behind the requests already submitted. Produce no OrderResult; false
+    // once the gateway has been stopped.
+    bool advanceTime(Timestamp now);
+    bool setSessionEnd(Timestamp time);
+
+    // Single reader: pops the next result, oldest first
+    bool pollResponse(OrderResult& result) { return responses_.tryPop(result); }
+    // Results of accepted requests that stop() found no room for on the response ring
+    std::uint64_t getDroppedResponses() const { return droppedResponses_.load(std::memory_order_acquire); }
+
+    // Only safe to read while the matching thread is idle, and the book only until stop()
+    Book& getBook() { return *book_; }
+    History& getHistory() { return *history_; }
+
+private:
+    struct Command {
+        enum class Kind : std::uint8_t { NewOrder, CancelOrder, AdvanceTime, SessionEnd };
+
+        Kind kind;
+        OrderRequest request;   // only orderId is used for a cancel, only expireTime for the clock
+    };
+
+    std::unique_ptr<Book> book_;
+    std::unique_ptr<History> history_;
+    std::optional<PriceBand> priceBand_;    // the book's, copied so callers never touch book_
+    std::optional<BasicMatchingEngine<Book, History>> engine_;
+    AsyncGatewayConfig config_;
+    JournalWriter* journal_ = nullptr;
+
+    MpscQueue<Command> ingress_;
+    SpscQueue<OrderResult> responses_;
+    std::thread matchingThread_;
+    std::atomic<bool> running_ { false };
+    std::atomic<bool> stopped_ { false };   // requests are rejected with Other once set
+    std::atomic<std::size_t> enqueuing_ { 0 };   // callers past the stopped_ check, not yet queued
+    std::atomic<std::uint64_t> droppedResponses_ { 0 };
+    bool started_ = false;
+
+    bool tryEnqueue(const Command& command);
+    void run();
+    OrderResult process(const Command& command);
+    void processClock(const Command& command);
+};
+
+} // namespace ob
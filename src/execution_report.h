@@ -0,0 +1,98 @@
+#pragma once
+
+#include "order.h"
+#include "utils/engine_memory.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ob {
+
+enum class ExecutionType : std::uint8_t {
+    Accepted,           // passed the engine's checks; a stop is now waiting for its trigger
+    PartiallyFilled,
+    Filled,
+    Cancelled,          // by request, as an IOC/FOK/market leftover, or by self-trade prevention
+    Replaced,           // price or open quantity changed by an amend or self-trade decrement
+    Rejected            // turned away by the engine; reason says why
+};
+
+// One change to one order, as the engine hands it to an execution sink. A trade produces two
+// reports, one for each order, incoming order first.
+struct ExecutionReport {
+    OrderId orderId;
+    OrderId counterOrderId;     // the other order of a fill, 0 otherwise
+    Price price;                // the trade price for fills, the order's price otherwise
+    Quantity quantity;          // filled by a fill, taken away by a cancel, open after anything else
+    Quantity leavesQuantity;    // still open afterwards; 0 once filled, cancelled or rejected
+    SymbolId symbol;
+    ExecutionType type;
+    std::uint8_t orderSide;
+    OrderError reason;          // Rejected only
+    std::uint8_t reserved;
+
+    OrderSide getOrderSide() const { return static_cast<OrderSide>(orderSide); }
+};
+
+static_assert(sizeof(ExecutionReport) == 40 && std::is_trivially_copyable_v<ExecutionReport>);
+
+// Reports nothing: an engine built with it does no reporting work at all
+struct NullExecutionSink {
+    void onExecution(const ExecutionReport&) { }
+};
+
+// Keeps the most recent reports by value in a buffer allocated once at construction, dropping the
+// oldest once every slot is taken, so reporting never allocates. Readers get the buffered reports
+// oldest first as at most two contiguous spans.
+class RingExecutionSink {
+public:
+    // capacity is rounded up to a power of two
+    explicit RingExecutionSink(std::size_t capacity)
+        : reports_(std::bit_ceil(std::max<std::size_t>(capacity, 1)))
+        , mask_ { reports_.size() - 1 }
+    { }
+
+    void onExecution(const ExecutionReport& report) {
+        if (size() == reports_.size()) {
+            ++head_;
+        }
+        reports_[tail_++ & mask_] = report;
+        ++totalRecorded_;
+    }
+
+    // Buffered reports oldest first; the second span is non-empty when they wrap around the end
+    std::pair<std::span<const ExecutionReport>, std::span<const ExecutionReport>> getReports() const {
+        std::size_t start = head_ & mask_;
+        std::size_t count = size();
+        std::size_t firstCount = std::min(count, reports_.size() - start);
+        return { std::span<const ExecutionReport>(reports_.data() + start, firstCount),
+                 std::span<const ExecutionReport>(reports_.data(), count - firstCount) };
+    }
+
+    // Report i positions after the oldest buffered report
+    const ExecutionReport& operator[](std::size_t i) const { return reports_[(head_ + i) & mask_]; }
+
+    // Drops the buffered reports, e.g. once a reader has consumed them
+    void clear() { head_ = tail_; }
+
+    std::size_t size() const { return tail_ - head_; }
+    bool empty() const { return size() == 0; }
+    std::size_t capacity() const { return reports_.size(); }
+    // Every report ever recorded, including ones overwritten or cleared
+    std::size_t totalRecorded() const { return totalRecorded_; }
+
+private:
+    std::vector<ExecutionReport, EngineAllocator<ExecutionReport>> reports_;
+    std::size_t mask_;
+    std::size_t head_ = 0;  // position of the oldest buffered report, only ever increases
+    std::size_t tail_ = 0;  // position the next report is written to
+    std::size_t totalRecorded_ = 0;
+};
+
+} // namespace ob
@@ -0,0 +1,125 @@
+#include "expiry_wheel.h"
+
+#include <algorithm>
+#include <bit>
+#include <format>
+#include <stdexcept>
+
+namespace ob {
+
+void ExpiryWheel::schedule(OrderPointer order) {
+    cancel(order);
+    link(order, slotFor(order->getExpireTime()));
+    ++size_;
+}
+
+void ExpiryWheel::start(Timestamp now) {
+    if (size_ > 0) {
+        throw std::logic_error(std::format("Cannot restart the clock of an expiry wheel holding {} orders", size_));
+    }
+    now_ = now;
+}
+
+bool ExpiryWheel::advance(Timestamp now, OrderPointers& expired, std::size_t limit) {
+    std::size_t taken = 0;
+    while (size_ > 0) {
+        Timestamp due = nextDue();
+        if (due > now) {
+            break;
+        }
+        now_ = due;
+
+        // Slots whose range starts here hand their orders down, highest level first, so an order
+        // can fall through several levels in one go
+        for (std::size_t level = kLevels - 1; level > 0; --level) {
+            std::size_t slot = level * kSlots + digit(now_, level);
+            if (slots_[slot].empty()) {
+                continue;
+            }
+            // The emptied slot keeps cascading_'s capacity and vice versa, so nothing allocates
+            cascading_.swap(slots_[slot]);
+            occupied_[level] &= ~(std::uint64_t{1} << digit(now_, level));
+            const std::size_t count = cascading_.size();
+            for (std::size_t i = 0; i < count; ++i) {
+                if (i + kPrefetchDistance < count) {
+                    __builtin_prefetch(cascading_[i + kPrefetchDistance]);
+                }
+                Order* order = cascading_[i];
+                link(order, slotFor(order->getExpireTime()));
+            }
+            cascading_.clear();
+        }
+
+        // Everything left in the level 0 slot expires exactly now
+        std::vector<Order*>& expiring = slots_[digit(now_, 0)];
+        const std::size_t count = std::min(expiring.size(), limit - taken);
+        for (std::size_t i = 0; i < count; ++i) {
+            expiring[i]->expirySlot_ = Order::kNoExpirySlot;
+            expired.push_back(expiring[i]);
+        }
+        size_ -= count;
+        taken += count;
+        if (count < expiring.size()) {
+            // Cut short by the limit: the rest move to the front, in order
+            expiring.erase(expiring.begin(), expiring.begin() + static_cast<std::ptrdiff_t>(count));
+            for (std::size_t i = 0; i < expiring.size(); ++i) {
+                expiring[i]->expiryIndex_ = static_cast<std::uint32_t>(i);
+            }
+            return false;
+        }
+        expiring.clear();
+        occupied_[0] &= ~(std::uint64_t{1} << digit(now_, 0));
+    }
+    now_ = std::max(now_, now);
+    return true;
+}
+
+std::size_t ExpiryWheel::slotFor(Timestamp expireTime) const {
+    if (expireTime <= now_) {
+        return digit(now_, 0);
+    }
+    std::size_t level = (std::bit_width(expireTime ^ now_) - 1) / kSlotBits;
+    return level * kSlots + digit(expireTime, level);
+}
+
+// An occupied slot always lies ahead of the clock's digit at its level (or on it, for orders left
+// behind by a limit), and every slot of a level comes due before any slot of the level above, so
+// the lowest occupied level decides
+Timestamp ExpiryWheel::nextDue() const {
+    for (std::size_t level = 0; level < kLevels; ++level) {
+        std::uint64_t pending = occupied_[level] & (~std::uint64_t{0} << digit(now_, level));
+        if (pending == 0) {
+            continue;
+        }
+        const unsigned shift = static_cast<unsigned>(level) * kSlotBits;
+        const Timestamp above = shift + kSlotBits >= 64 ? 0 : now_ >> (shift + kSlotBits) << (shift + kSlotBits);
+        const Timestamp start = above | (static_cast<Timestamp>(std::countr_zero(pending)) << shift);
+        return std::max(start, now_);
+    }
+    return std::numeric_limits<Timestamp>::max();
+}
+
+void ExpiryWheel::link(OrderPointer order, std::size_t slot) {
+    std::vector<Order*>& orders = slots_[slot];
+    if (orders.empty()) {
+        occupied_[slot / kSlots] |= std::uint64_t{1} << (slot % kSlots);
+    }
+    order->expirySlot_ = static_cast<std::uint16_t>(slot);
+    order->expiryIndex_ = static_cast<std::uint32_t>(orders.size());
+    orders.push_back(order);
+}
+
+void ExpiryWheel::unlink(OrderPointer order) {
+    const std::size_t slot = order->expirySlot_;
+    std::vector<Order*>& orders = slots_[slot];
+    Order* last = orders.back();
+    orders[order->expiryIndex_] = last;
+    last->expiryIndex_ = order->expiryIndex_;
+    orders.pop_back();
+    if (orders.empty()) {
+        occupied_[slot / kSlots] &= ~(std::uint64_t{1} << (slot % kSlots));
+    }
+    order->expirySlot_ = Order::kNoExpirySlot;
+}
+
+} // namespace ob
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "order.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace ob {
+
+// Resting orders that expire on their own (GoodTillDate and Day), kept in a hierarchical timer
+// wheel so that nothing ever has to scan the book for them. Level l has 64 slots, each covering
+// 64^l units of time. An order waits at the level of the highest base-64 digit in which its
+// expire time differs from the current time, in the slot that digit picks. A slot is an array of
+// order pointers and each order keeps its position in it, so scheduling is an append and
+// cancelling swaps the last entry into the gap. Once time reaches a slot above level 0 its orders
+// are spread over the levels below, so an order moves down at most once per level before it
+// expires; walking an array rather than a list lets that pass fetch orders ahead of use instead
+// of waiting on one cache miss at a time. One bitmap of occupied slots per level lets advance()
+// jump straight to the next slot that needs attention, however far the clock moves at once.
+class ExpiryWheel {
+public:
+    static constexpr unsigned kSlotBits = 6;
+    static constexpr std::size_t kSlots = std::size_t{1} << kSlotBits;
+    static constexpr std::size_t kLevels = (64 + kSlotBits - 1) / kSlotBits;   // enough for any Timestamp
+
+    ExpiryWheel() = default;
+
+    ExpiryWheel(const ExpiryWheel&) = delete;
+    ExpiryWheel& operator=(const ExpiryWheel&) = delete;
+
+    // Schedules the order to expire at its expire time, moving it if it is already scheduled.
+    // An expire time the clock has already reached expires on the next advance().
+    void schedule(OrderPointer order);
+    // Does nothing for an order that is not scheduled
+    void cancel(OrderPointer order) {
+        if (order->isScheduledToExpire()) {
+            unlink(order);
+            --size_;
+        }
+    }
+
+    // Moves the clock forward to now and appends the orders whose expire time it reaches to
+    // expired, earliest expiry first, taking them out of the wheel. Stops early once limit orders
+    // have been taken and returns false if more were due then; the clock is left at their expire
+    // time and the next call carries on from there.
+    bool advance(Timestamp now, OrderPointers& expired, std::size_t limit = std::numeric_limits<std::size_t>::max());
+
+    // Sets the clock of an empty wheel, such as one a snapshot is being loaded into
+    void start(Timestamp now);
+
+    Timestamp now() const { return now_; }
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+private:
+    static constexpr std::size_t kPrefetchDistance = 8;   // orders fetched ahead while cascading
+
+    std::array<std::vector<Order*>, kLevels * kSlots> slots_;
+    std::array<std::uint64_t, kLevels> occupied_ {};   // one bit per non-empty slot
+    std::vector<Order*> cascading_;                    // the slot being spread over lower levels
+    Timestamp now_ = 0;
+    std::size_t size_ = 0;
+
+    static std::size_t digit(Timestamp time, std::size_t level) {
+        return static_cast<std::size_t>(time >> (level * kSlotBits)) & (kSlots - 1);
+    }
+
+    std::size_t slotFor(Timestamp expireTime) const;
+    Timestamp nextDue() const;
+    void link(OrderPointer order, std::size_t slot);
+    void unlink(OrderPointer order);
+};
+
+} // namespace ob
@@ -0,0 +1,144 @@
+#include "journal.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <stdexcept>
+
+#ifdef __unix__
+#include <unistd.h>
+#endif
+
+namespace ob {
+
+namespace {
+
+bool isJournalHeader(const JournalHeader& header) {
+    return std::memcmp(header.magic, kJournalMagic, sizeof(header.magic)) == 0 && header.recordSize == sizeof(JournalRecord);
+}
+
+} // namespace
+
+JournalWriter::JournalWriter(const std::string& path, std::size_t bufferRecords) {
+    // Pick up the sequence where an existing journal left off, dropping a record torn by a crash
+    // mid-write so that new records start on a record boundary. A file too short to hold a
+    // header never got past being created and starts over.
+    constexpr long kHeaderSize = sizeof(JournalHeader);
+    constexpr long kRecordSize = sizeof(JournalRecord);
+    bool writeHeader = true;
+    if (std::FILE* existing = std::fopen(path.c_str(), "rb")) {
+        JournalHeader header;
+        std::fseek(existing, 0, SEEK_END);
+        long size = std::ftell(existing);
+        long keep = 0;
+        if (size >= kHeaderSize) {
+            std::fseek(existing, 0, SEEK_SET);
+            if (std::fread(&header, sizeof(header), 1, existing) != 1 || !isJournalHeader(header)) {
+                std::fclose(existing);
+                throw std::runtime_error(std::format("Journal ({}) was not written in this journal format", path));
+            }
+            long wholeRecords = (size - kHeaderSize) / kRecordSize;
+            if (wholeRecords > 0 && std::fseek(existing, kHeaderSize + (wholeRecords - 1) * kRecordSize, SEEK_SET) == 0) {
+                JournalRecord last;
+                if (std::fread(&last, sizeof(last), 1, existing) == 1) {
+                    lastSequence_ = last.sequence;
+                }
+            }
+            keep = kHeaderSize + wholeRecords * kRecordSize;
+            writeHeader = false;
+        }
+        std::fclose(existing);
+        if (size != keep) {
+            std::filesystem::resize_file(path, static_cast<std::uintmax_t>(keep));
+        }
+    }
+
+    file_ = std::fopen(path.c_str(), "ab");
+    if (file_ == nullptr) {
+        throw std::runtime_error(std::format("Unable to open journal ({}) for writing", path));
+    }
+    // Writes already go out a whole batch at a time, a second buffer would only add a copy
+    std::setvbuf(file_, nullptr, _IONBF, 0);
+    if (writeHeader) {
+        JournalHeader header {};
+        std::memcpy(header.magic, kJournalMagic, sizeof(header.magic));
+        header.recordSize = sizeof(JournalRecord);
+        if (std::fwrite(&header, sizeof(header), 1, file_) != 1) {
+            std::fclose(file_);
+            throw std::runtime_error(std::format("Unable to write the header of journal ({})", path));
+        }
+    }
+    buffer_.reserve(std::max<std::size_t>(bufferRecords, 1));
+}
+
+JournalWriter::~JournalWriter() {
+    try {
+        flush();
+    } catch (std::exception& e) {
+        // nothing left to report to; the reader stops at the last whole record
+    }
+    std::fclose(file_);
+}
+
+void JournalWriter::flush() {
+    if (buffer_.empty()) {
+        return;
+    }
+    if (std::fwrite(buffer_.data(), sizeof(JournalRecord), buffer_.size(), file_) != buffer_.size()) {
+        throw std::runtime_error(std::format("Journal write failed after sequence {}", lastSequence_ - buffer_.size()));
+    }
+    buffer_.clear();
+}
+
+void JournalWriter::sync() {
+    flush();
+#ifdef __unix__
+    ::fsync(fileno(file_));
+#endif
+}
+
+JournalReader::JournalReader(const std::string& path, std::size_t bufferRecords)
+    : buffer_(std::max<std::size_t>(bufferRecords, 1))
+{
+    file_ = std::fopen(path.c_str(), "rb");
+    if (file_ == nullptr) {
+        throw std::runtime_error(std::format("Unable to open journal ({}) for reading", path));
+    }
+    // A file cut short inside its header has no records yet and reads as empty
+    JournalHeader header;
+    if (std::fread(&header, sizeof(header), 1, file_) == 1 && !isJournalHeader(header)) {
+        std::fclose(file_);
+        throw std::runtime_error(std::format("Journal ({}) was not written in this journal format", path));
+    }
+}
+
+JournalReader::~JournalReader() {
+    std::fclose(file_);
+}
+
+void JournalReader::skip(std::uint64_t count) {
+    if (std::fseek(file_, static_cast<long>(sizeof(JournalHeader) + (lastSequence_ + count) * sizeof(JournalRecord)), SEEK_SET) != 0) {
+        throw std::runtime_error(std::format("Unable to skip to journal record {}", lastSequence_ + count + 1));
+    }
+    lastSequence_ += count;
+    position_ = 0;
+    count_ = 0;
+}
+
+bool JournalReader::refill() {
+    // A torn record at the tail (crash mid-write) is ignored
+    count_ = std::fread(buffer_.data(), sizeof(JournalRecord), buffer_.size(), file_);
+    position_ = 0;
+    return count_ > 0;
+}
+
+void JournalReader::checkSequence(const JournalRecord& record) {
+    if (record.sequence != lastSequence_ + 1) {
+        throw std::runtime_error(
+            std::format("Journal sequence gap: expected {}, found {}", lastSequence_ + 1, record.sequence));
+    }
+    lastSequence_ = record.sequence;
+}
+
+} // namespace ob
@@ -0,0 +1,204 @@
+#pragma once
+
+#include "order.h"
+#include "order_events.h"
+#include "utils/object_pool.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace ob {
+
+enum class JournalEvent : std::uint8_t {
+    NewOrder,
+    CancelOrder,
+    AmendOrder,
+    AdvanceTime,
+    SessionEnd
+};
+
+// One inbound event as it is laid out on disk (native byte order). Records are fixed size, so
+// the reader can pull them straight out of its buffer.
+struct JournalRecord {
+    std::uint64_t sequence;     // 1 for the first record of a journal, no gaps
+    OrderId orderId;
+    SymbolId symbol;
+    Price price;
+    Quantity quantity;
+    Price stopPrice;            // Stop and StopLimit only
+    JournalEvent event;
+    std::uint8_t orderType;
+    std::uint8_t orderSide;
+    std::uint8_t timeInForce;
+    Quantity displayQuantity;   // icebergs only
+    ParticipantId participant;
+    std::uint32_t reserved;
+    Timestamp time;             // a GoodTillDate order's expire time, the clock for AdvanceTime and SessionEnd
+
+    static JournalRecord newOrder(const Order& order) {
+        return { 0, order.getOrderId(), order.getSymbol(), order.getPrice(), order.getInitialQuantity(), order.getStopPrice(), JournalEvent::NewOrder,
+                 static_cast<std::uint8_t>(order.getOrderType()),
+                 static_cast<std::uint8_t>(order.getOrderSide()),
+                 static_cast<std::uint8_t>(order.getTimeInForce()), order.getDisplayQuantity(), order.getParticipant(), 0,
+                 order.getExpireTime() };
+    }
+
+    static JournalRecord newOrder(const OrderRequest& request) {
+        return { 0, request.orderId, request.symbol, request.price, request.quantity, request.stopPrice, JournalEvent::NewOrder,
+                 static_cast<std::uint8_t>(request.orderType),
+                 static_cast<std::uint8_t>(request.orderSide),
+                 static_cast<std::uint8_t>(request.timeInForce), request.displayQuantity, request.participant, 0,
+                 request.expireTime };
+    }
+
+    static JournalRecord cancelOrder(OrderId orderId, SymbolId symbol = 0) {
+        return { 0, orderId, symbol, 0, 0, 0, JournalEvent::CancelOrder, 0, 0, 0, 0, 0, 0, 0 };
+    }
+
+    static JournalRecord amendOrder(OrderId orderId, Price price, Quantity quantity, SymbolId symbol = 0) {
+        return { 0, orderId, symbol, price, quantity, 0, JournalEvent::AmendOrder, 0, 0, 0, 0, 0, 0, 0 };
+    }
+
+    static JournalRecord advanceTime(Timestamp now) {
+        return { 0, 0, 0, 0, 0, 0, JournalEvent::AdvanceTime, 0, 0, 0, 0, 0, 0, now };
+    }
+
+    static JournalRecord sessionEnd(Timestamp time) {
+        return { 0, 0, 0, 0, 0, 0, JournalEvent::SessionEnd, 0, 0, 0, 0, 0, 0, time };
+    }
+
+    OrderType getOrderType() const { return static_cast<OrderType>(orderType); }
+    OrderSide getOrderSide() const { return static_cast<OrderSide>(orderSide); }
+    TimeInForce getTimeInForce() const { return static_cast<TimeInForce>(timeInForce); }
+};
+
+// Starts every journal file. The record layout has changed as events gained fields, so a reader
+// or writer refuses a journal whose magic or record size is not its own.
+struct JournalHeader {
+    char magic[8];
+    std::uint32_t recordSize;   // sizeof(JournalRecord) of the writer
+    std::uint32_t reserved;
+};
+
+static_assert(sizeof(JournalRecord) == 56);
+static_assert(std::is_trivially_copyable_v<JournalRecord>);
+static_assert(sizeof(JournalHeader) == 16 && std::is_trivially_copyable_v<JournalHeader>);
+
+inline constexpr char kJournalMagic[8] = { 'O', 'B', 'J', 'R', 'N', 'L', '0', '1' };
+
+// Append-only writer. Records are staged in a buffer allocated once and written to the file a
+// whole buffer at a time; flush() pushes out a partial batch, sync() also asks the OS to put it
+// on disk. Opening an existing journal appends to it and carries on its sequence numbers; one in
+// another format is refused with std::runtime_error rather than appended to.
+class JournalWriter {
+public:
+    static constexpr std::size_t kDefaultBufferRecords = 1 << 14;
+
+    explicit JournalWriter(const std::string& path, std::size_t bufferRecords = kDefaultBufferRecords);
+    ~JournalWriter();
+
+    JournalWriter(const JournalWriter&) = delete;
+    JournalWriter& operator=(const JournalWriter&) = delete;
+
+    void append(JournalRecord record) {
+        record.sequence = ++lastSequence_;
+        buffer_.push_back(record);
+        if (buffer_.size() == buffer_.capacity()) {
+            flush();
+        }
+    }
+
+    void flush();
+    void sync();
+
+    std::uint64_t lastSequence() const { return lastSequence_; }
+
+private:
+    std::FILE* file_;
+    std::vector<JournalRecord> buffer_;
+    std::uint64_t lastSequence_ = 0;
+};
+
+// Reads a journal front to back in buffer-sized chunks; throws std::runtime_error on opening a
+// journal written in another format
+class JournalReader {
+public:
+    static constexpr std::size_t kDefaultBufferRecords = 1 << 14;
+
+    explicit JournalReader(const std::string& path, std::size_t bufferRecords = kDefaultBufferRecords);
+    ~JournalReader();
+
+    JournalReader(const JournalReader&) = delete;
+    JournalReader& operator=(const JournalReader&) = delete;
+
+    // Jumps past the first count records (e.g. the ones a snapshot already reflects). Records
+    // are fixed size and numbered from 1, so this is a single seek.
+    void skip(std::uint64_t count);
+
+    // False at the end of the journal; throws if the sequence numbers have a gap
+    bool next(JournalRecord& record) {
+        if (position_ == count_ && !refill()) {
+            return false;
+        }
+        record = buffer_[position_++];
+        checkSequence(record);
+        return true;
+    }
+
+private:
+    std::FILE* file_;
+    std::vector<JournalRecord> buffer_;
+    std::size_t position_ = 0;
+    std::size_t count_ = 0;
+    std::uint64_t lastSequence_ = 0;
+
+    bool refill();
+    void checkSequence(const JournalRecord& record);
+};
+
+// Feeds one journaled event through the engine the same way the gateway did
+template <typename Engine>
+void replayRecord(const JournalRecord& record, Engine& engine) {
+    if (record.event == JournalEvent::NewOrder) {
+        OrderPointer order = ObjectPool::allocate(record.orderId, record.getOrderType(), record.getOrderSide(),
+                                                  record.getTimeInForce(), record.price, record.quantity);
+        order->setSymbol(record.symbol);
+        order->setStopPrice(record.stopPrice);
+        order->setDisplayQuantity(record.displayQuantity);
+        order->setParticipant(record.participant);
+        order->setExpireTime(record.time);
+        if (engine.onNewOrder(order) != OrderError::None) {
+            ObjectPool::release(order);
+        }
+    } else if (record.event == JournalEvent::AmendOrder) {
+        engine.onAmendOrder(record.orderId, record.price, record.quantity);
+    } else if (record.event == JournalEvent::AdvanceTime) {
+        engine.advanceTime(record.time);
+    } else if (record.event == JournalEvent::SessionEnd) {
+        engine.setSessionEnd(record.time);
+    } else {
+        engine.onCancelOrder(record.orderId);
+    }
+}
+
+// Rebuilds a book by replaying every event in the journal, returns the number of events
+template <typename Engine>
+std::uint64_t replayJournal(JournalReader& reader, Engine& engine) {
+    std::uint64_t replayed = 0;
+    JournalRecord record;
+    while (reader.next(record)) {
+        try {
+            replayRecord(record, engine);
+        } catch (std::exception& e) {
+            // the event failed the same way when it was first processed
+        }
+        ++replayed;
+    }
+    return replayed;
+}
+
+} // namespace ob
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "order.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <span>
+#include <vector>
+
+namespace ob {
+
+// One aggregated price level
+struct DepthLevel {
+    Price price;
+    std::uint64_t quantity;     // open quantity of every order at this price
+    std::uint32_t orderCount;
+};
+
+// A price level whose aggregate changed. orderCount == 0 means the level is gone.
+struct DepthUpdate {
+    OrderSide side;
+    DepthLevel level;
+};
+
+using DepthListener = std::function<void(const DepthUpdate&)>;
+
+// The best maxLevels levels of one side of a book, best first. The book calls update() after
+// every change to a level, so readers get the top of the book without walking the side.
+class DepthCache {
+public:
+    DepthCache(OrderSide side, std::size_t maxLevels)
+        : side_ { side }
+        , maxLevels_ { maxLevels }
+    {
+        levels_.reserve(maxLevels_ + 1);
+    }
+
+    // Levels is the side the cache mirrors and must already reflect the change
+    template <typename Levels>
+    void update(const DepthLevel& changed, const Levels& levels) {
+        std::size_t i = 0;
+        while (i < levels_.size() && isBetter(levels_[i].price, changed.price)) {
+            ++i;
+        }
+        bool cached = i < levels_.size() && levels_[i].price == changed.price;
+
+        if (changed.orderCount == 0) {
+            if (!cached) {
+                return;
+            }
+            levels_.erase(levels_.begin() + i);
+            // A level left the top, so the next one down (if any) moves up into the last slot
+            if (levels_.size() + 1 == maxLevels_) {
+                auto next = levels.begin();
+                std::advance(next, levels_.size());
+                if (next != levels.end()) {
+                    levels_.push_back(toDepthLevel(*next));
+                }
+            }
+        } else if (cached) {
+            levels_[i] = changed;
+        } else if (i < maxLevels_) {
+            levels_.insert(levels_.begin() + i, changed);
+            if (levels_.size() > maxLevels_) {
+                levels_.pop_back();
+            }
+        }
+    }
+
+    template <typename Levels>
+    void rebuild(const Levels& levels, std::size_t maxLevels) {
+        maxLevels_ = maxLevels;
+        levels_.clear();
+        levels_.reserve(maxLevels_ + 1);
+        for (auto it = levels.begin(); it != levels.end() && levels_.size() < maxLevels_; ++it) {
+            levels_.push_back(toDepthLevel(*it));
+        }
+    }
+
+    std::span<const DepthLevel> levels() const { return levels_; }
+    std::size_t maxLevels() const { return maxLevels_; }
+
+private:
+    OrderSide side_;
+    std::size_t maxLevels_;
+    std::vector<DepthLevel> levels_;
+
+    bool isBetter(Price a, Price b) const {
+        return side_ == OrderSide::Buy ? a > b : a < b;
+    }
+
+    template <typename Level>
+    static DepthLevel toDepthLevel(const Level& level) {
+        const auto& [price, orders] = level;
+        return { price, orders.totalQuantity(), static_cast<std::uint32_t>(orders.size()) };
+    }
+};
+
+} // namespace ob
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "order.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace ob {
+
+// How an incoming order that cannot take a whole price level is shared out across it
+enum class MatchingAlgorithm : std::uint8_t {
+    Fifo,               // price-time priority
+    ProRata,            // in proportion to each order's visible size
+    ProRataTopOrder     // the first order in time is filled first, the rest is pro-rata
+};
+
+// What happens when an incoming order would trade with a resting order of the same participant
+enum class SelfTradePrevention : std::uint8_t {
+    None,           // let them trade
+    CancelResting,  // cancel the resting order and keep matching
+    CancelIncoming, // cancel what is left of the incoming order
+    CancelBoth,
+    Decrement       // take the smaller quantity off both without a trade; an order left with nothing is cancelled
+};
+
+// Splits quantity (less than total, the sum of sizes) across sizes. Each share is first rounded
+// down in a single branch-free pass over the sizes; the few lots that leaves over go one each to
+// the orders in time priority. shares must be as long as sizes.
+inline void allocateProRata(std::span<const Quantity> sizes, std::span<Quantity> shares, Quantity quantity, std::uint64_t total) {
+    const double ratio = static_cast<double>(quantity) / static_cast<double>(total);
+    const std::size_t count = sizes.size();
+
+    std::uint64_t allocated = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        shares[i] = static_cast<Quantity>(static_cast<double>(sizes[i]) * ratio);
+        allocated += shares[i];
+    }
+
+    // ratio is rounded, so in rare cases a share comes out a lot too high
+    for (std::size_t i = count; allocated > quantity && i-- > 0;) {
+        Quantity cut = static_cast<Quantity>(std::min<std::uint64_t>(allocated - quantity, shares[i]));
+        shares[i] -= cut;
+        allocated -= cut;
+    }
+
+    std::uint64_t leftover = quantity - allocated;
+    while (leftover > 0) {
+        for (std::size_t i = 0; i < count && leftover > 0; ++i) {
+            if (shares[i] < sizes[i]) {
+                ++shares[i];
+                --leftover;
+            }
+        }
+    }
+}
+
+} // namespace ob
@@ -1,182 +1,537 @@
 #include "matching_engine.h"
 
 #include "order.h"
+#include "utils/latency.h"
 #include "utils/object_pool.h"
 
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
 #include <format>
-#include <numeric>
 
 namespace ob {
 
-void MatchingEngine::onNewOrder(OrderPointer order) {
-    matchOrders(order);
+namespace {
 
-    if (order->getOrderStatus() != OrderStatus::Filled) {
-        if (order->getOrderType() == OrderType::Limit 
-                && order->getTimeInForce() == TimeInForce::GoodTillCancel) {
-            orderBook_.addOrder(order);
+// Whether a resting level at levelPrice can trade with an incoming order limited at limit
+template <OrderSide Side, OrderType Type>
+constexpr bool crosses(Price levelPrice, Price limit) {
+    if constexpr (Type == OrderType::Market) {
+        return true;
+    } else if constexpr (Side == OrderSide::Buy) {
+        return levelPrice <= limit;
+    } else {
+        return levelPrice >= limit;
+    }
+}
+
+constexpr OrderSide oppositeOf(OrderSide side) {
+    return side == OrderSide::Buy ? OrderSide::Sell : OrderSide::Buy;
+}
+
+} // namespace
+
+template <typename Book, typename History, ValidationLevel Checks>
+template <std::size_t Index>
+constexpr typename BasicMatchingEngine<Book, History, Checks>::Routine BasicMatchingEngine<Book, History, Checks>::routineFor() {
+    constexpr auto side = static_cast<OrderSide>(Index / (kOrderTypes * kTimesInForce));
+    constexpr auto type = static_cast<OrderType>(Index / kTimesInForce % kOrderTypes);
+    constexpr auto tif = static_cast<TimeInForce>(Index % kTimesInForce);
+    return &BasicMatchingEngine::processOrder<side, type, tif>;
+}
+
+template <typename Book, typename History, ValidationLevel Checks>
+template <std::size_t... Index>
+constexpr std::array<typename BasicMatchingEngine<Book, History, Checks>::Routine, sizeof...(Index)>
+BasicMatchingEngine<Book, History, Checks>::makeRoutines(std::index_sequence<Index...>) {
+    return { routineFor<Index>()... };
+}
+
+template <typename Book, typename History, ValidationLevel Checks>
+const std::array<typename BasicMatchingEngine<Book, History, Checks>::Routine, BasicMatchingEngine<Book, History, Checks>::kRoutines>
+BasicMatchingEngine<Book, History, Checks>::routines_ = makeRoutines(std::make_index_sequence<kRoutines>{});
+
+template <typename Book, typename History, ValidationLevel Checks>
+OrderError BasicMatchingEngine<Book, History, Checks>::onNewOrder(OrderPointer order) {
+    if (OrderError error = checkOrder(*order); error != OrderError::None) {
+        report(ExecutionType::Rejected, *order, 0, error);
+        return error;
+    }
+    if (order->getTimeInForce() == TimeInForce::Day) {
+        order->setExpireTime(sessionEnd_);
+    }
+    report(ExecutionType::Accepted, *order, order->getRemainingQuantity());
+
+    OrderError error = submit(order);
+    if (error != OrderError::None) {
+        report(ExecutionType::Rejected, *order, 0, error);
+    }
+    return error;
+}
+
+template <typename Book, typename History, ValidationLevel Checks>
+OrderError BasicMatchingEngine<Book, History, Checks>::onNewOrder(OrderPointer order, OrderStatus& status) {
+    tracked_ = order;
+    trackedStatus_ = order->getOrderStatus();
+    OrderError error = onNewOrder(order);
+    tracked_ = nullptr;
+    status = trackedStatus_;
+    return error;
+}
+
+// Out-of-range values (e.g. a corrupt journal record) are turned away before the table lookup;
+// nothing has been matched, so the order still belongs to the caller
+template <typename Book, typename History, ValidationLevel Checks>
+OrderError BasicMatchingEngine<Book, History, Checks>::checkOrder(const Order& order) const {
+    if (static_cast<std::size_t>(order.getTimeInForce()) >= kTimesInForce) {
+        return OrderError::UnsupportedTimeInForce;
+    }
+    if (static_cast<std::size_t>(order.getOrderSide()) >= kSides
+        || (static_cast<std::size_t>(order.getOrderType()) >= kOrderTypes && !isStopOrder(order.getOrderType()))) {
+        return OrderError::UnsupportedOrderType;
+    }
+    if (hasExpiry(order.getTimeInForce())) {
+        // A stop would have to expire from the trigger book too; they are not supported there
+        if (isStopOrder(order.getOrderType())) {
+            return OrderError::UnsupportedTimeInForce;
         }
+        Timestamp expireTime = order.getTimeInForce() == TimeInForce::Day ? sessionEnd_ : order.getExpireTime();
+        if (expireTime <= getTime()) {
+            return OrderError::InvalidExpiry;
+        }
+    }
+    return OrderError::None;
+}
 
-        if (TimeInForce tif = order->getTimeInForce(); 
-            tif == TimeInForce::ImmediateOrCancel || tif == TimeInForce::FillOrKill) {
-            order->cancel();
+template <typename Book, typename History, ValidationLevel Checks>
+OrderError BasicMatchingEngine<Book, History, Checks>::submit(OrderPointer order) {
+    OrderError error = isStopOrder(order->getOrderType()) ? parkStop(order) : dispatch(order);
+    releaseTriggeredStops();
+    return error;
+}
+
+// Only for orders checkOrder has passed; a triggered stop has been turned into a limit or market order
+template <typename Book, typename History, ValidationLevel Checks>
+OrderError BasicMatchingEngine<Book, History, Checks>::dispatch(OrderPointer order) {
+    auto side = static_cast<std::size_t>(order->getOrderSide());
+    auto type = static_cast<std::size_t>(order->getOrderType());
+    auto tif = static_cast<std::size_t>(order->getTimeInForce());
+    return (this->*routines_[(side * kOrderTypes + type) * kTimesInForce + tif])(order);
+}
+
+template <typename Book, typename History, ValidationLevel Checks>
+OrderError BasicMatchingEngine<Book, History, Checks>::parkStop(OrderPointer order) {
+    TriggerBook& stops = orderBook_.getStops();
+    if (!stops.isTriggered(*order)) {
+        stops.add(order);
+        return OrderError::None;
+    }
+    // The market is already through the stop price
+    TriggerBook::activate(order);
+    return dispatch(order);
+}
+
+// Stops triggered while matching join the back of the queue, so a cascade runs in sequence
+template <typename Book, typename History, ValidationLevel Checks>
+void BasicMatchingEngine<Book, History, Checks>::releaseTriggeredStops() {
+    while (OrderPointer stop = orderBook_.getStops().popTriggered()) {
+        if (OrderError error = dispatch(stop); error != OrderError::None) {
+            report(ExecutionType::Rejected, *stop, 0, error);
+            ObjectPool::release(stop); // out of the trigger book, so nobody else holds it
         }
     }
+}
 
-    if (order->getOrderStatus() == OrderStatus::Filled || order->getOrderStatus() == OrderStatus::Cancelled) {
-        ObjectPool::release(order);
+template <typename Book, typename History, ValidationLevel Checks>
+void BasicMatchingEngine<Book, History, Checks>::onCancelOrder(OrderId orderId) {
+    cancelResting(orderId);
+}
+
+template <typename Book, typename History, ValidationLevel Checks>
+OrderError BasicMatchingEngine<Book, History, Checks>::onAmendOrder(OrderId orderId, Price price, Quantity quantity) {
+    auto it = orderBook_.getOrders().find(orderId);
+    if (it == orderBook_.getOrders().end()) {
+        return OrderError::UnknownOrder;
+    }
+    OrderPointer order = it->second;
+
+    if (quantity == 0) {
+        cancelResting(orderId);
+        return OrderError::None;
     }
+    if (price == order->getPrice() && quantity <= order->getRemainingQuantity()) {
+        orderBook_.reduceOrder(order, quantity);
+        report(ExecutionType::Replaced, *order, quantity);
+        return OrderError::None;
+    }
+
+    const bool crosses = order->getOrderSide() == OrderSide::Buy
+        ? !orderBook_.getSellOrders().empty() && orderBook_.getSellOrders().begin()->first <= price
+        : !orderBook_.getBuyOrders().empty() && orderBook_.getBuyOrders().begin()->first >= price;
+    if (!crosses) {
+        orderBook_.moveOrder(order, price, quantity);
+        report(ExecutionType::Replaced, *order, quantity);
+        return OrderError::None;
+    }
+
+    // Out of the book, then in again through the matching routine like any new order
+    orderBook_.takeOrder(orderId);
+    order->setPrice(price);
+    order->setOpenQuantity(quantity);
+    report(ExecutionType::Replaced, *order, quantity);
+    OrderError error = submit(order);
+    if (error != OrderError::None) {
+        report(ExecutionType::Rejected, *order, 0, error);
+        ObjectPool::release(order); // no longer in the book, so nobody else holds it
+    }
+    return error;
 }
 
-void MatchingEngine::onCancelOrder(OrderId orderId) {
-    orderBook_.cancelOrder(orderId);
+template <typename Book, typename History, ValidationLevel Checks>
+void BasicMatchingEngine<Book, History, Checks>::onNewOrders(std::span<const OrderPointer> orders) {
+    for (OrderPointer order : orders) {
+        onNewOrder(order);
+    }
+}
+
+template <typename Book, typename History, ValidationLevel Checks>
+void BasicMatchingEngine<Book, History, Checks>::onCancelOrders(std::span<const OrderId> orderIds) {
+    for (OrderId orderId : orderIds) {
+        cancelResting(orderId);
+    }
 }
 
-void MatchingEngine::matchOrders(OrderPointer incomingOrder) {
-    switch (incomingOrder->getTimeInForce()) {
-        case TimeInForce::GoodTillCancel:
-            [[fallthrough]];
-        case TimeInForce::ImmediateOrCancel:
-            if (incomingOrder->getOrderSide() == OrderSide::Buy) {
-               matchWithBook(incomingOrder, orderBook_.getSellOrders());
+template <typename Book, typename History, ValidationLevel Checks>
+std::size_t BasicMatchingEngine<Book, History, Checks>::onMassCancel(const MassCancelFilter& filter) {
+    massCancelled_.clear();
+    std::size_t count = orderBook_.cancelOrders(filter, massCancelled_);
+    for (OrderPointer order : massCancelled_) {
+        report(ExecutionType::Cancelled, *order, order->getRemainingQuantity());
+    }
+    ObjectPool::release(massCancelled_);
+    massCancelled_.clear();
+    return count;
+}
+
+// The wheel hands over due orders a batch at a time; each then leaves through cancelResting
+template <typename Book, typename History, ValidationLevel Checks>
+std::size_t BasicMatchingEngine<Book, History, Checks>::advanceTime(Timestamp now) {
+    std::size_t count = 0;
+    bool done = false;
+    while (!done) {
+        expired_.clear();
+        done = orderBook_.getExpiries().advance(now, expired_, kExpiryBatch);
+        for (OrderPointer order : expired_) {
+            cancelResting(order->getOrderId());
+        }
+        count += expired_.size();
+    }
+    return count;
+}
+
+template <typename Book, typename History, ValidationLevel Checks>
+template <OrderSide Side, OrderType Type, TimeInForce Tif>
+OrderError BasicMatchingEngine<Book, History, Checks>::processOrder(OrderPointer incomingOrder) {
+    OrderError error = OrderError::None;
+    {
+        OB_LATENCY_SCOPE(LatencyStage::MatchOrders);
+        auto& oppositeBook = [this]() -> auto& {
+            if constexpr (Side == OrderSide::Buy) {
+                return orderBook_.getSellOrders();
             } else {
-                matchWithBook(incomingOrder, orderBook_.getBuyOrders());
+                return orderBook_.getBuyOrders();
             }
-            break;
-        
-        case TimeInForce::FillOrKill:
-            if (incomingOrder->getOrderSide() == OrderSide::Buy) {
-                tryToMatchWithBook(incomingOrder, orderBook_.getSellOrders());
-            } else {
-                tryToMatchWithBook(incomingOrder, orderBook_.getBuyOrders());
+        }();
+
+        // Fill-or-Kill: only sweep the book once the level totals show the whole order can fill
+        if (Tif != TimeInForce::FillOrKill || canFillCompletely<Side, Type>(*incomingOrder, oppositeBook)) {
+            error = sweep<Side, Type>(incomingOrder, oppositeBook);
+        }
+    }
+    if (error != OrderError::None) {
+        return error;
+    }
+
+    // Cancelled here only by self-trade prevention
+    if (OrderStatus status = incomingOrder->getOrderStatus(); status != OrderStatus::Filled && status != OrderStatus::Cancelled) {
+        if constexpr (restsInBook(Tif)) {
+            if constexpr (Type == OrderType::Limit) {
+                incomingOrder->refreshDisplay(); // an iceberg rests with a full slice showing
+                orderBook_.addOrder(incomingOrder);
             }
+            noteStatus(*incomingOrder);
+            // the gateway never lets a market order that could rest this far; it stays with the caller
+            return OrderError::None;
+        } else {
+            cancelIncoming(incomingOrder);
+        }
+    }
+
+    noteStatus(*incomingOrder);
+    ObjectPool::release(incomingOrder);
+    return OrderError::None;
+}
+
+template <typename Book, typename History, ValidationLevel Checks>
+template <OrderSide Side, OrderType Type, typename BookType>
+OrderError BasicMatchingEngine<Book, History, Checks>::sweep(OrderPointer incomingOrder, BookType& oppositeBook) {
+    const Price limit = incomingOrder->getPrice();
+    // Non-zero only when a self-trade is possible at all, so each fill pays one integer compare
+    const ParticipantId self = selfTradePrevention_ != SelfTradePrevention::None ? incomingOrder->getParticipant() : 0;
+
+    while (incomingOrder->getRemainingQuantity() > 0 && !oppositeBook.empty()) {
+        auto& [levelPrice, ordersAtPrice] = *oppositeBook.begin();
+        if (!crosses<Side, Type>(levelPrice, limit)) {
             break;
-        default:
-            throw std::logic_error(
-                std::format("Order ({}) has an unsupported TimeInForce", incomingOrder->getOrderId())); // should not execute
-    }
-}
-
-bool MatchingEngine::canMatch(OrderPointer order) {
-    OrderType type = order->getOrderType();
-    OrderSide side = order->getOrderSide();
-    if (type == OrderType::Market) {
-        return side == OrderSide::Buy 
-                ? !orderBook_.getSellOrders().empty() 
-                : !orderBook_.getBuyOrders().empty();
-    } else if (type == OrderType::Limit) {
-        Price price = order->getPrice();
-        if (side == OrderSide::Buy) {
-            const auto& sellOrders = orderBook_.getSellOrders();
-            if (sellOrders.empty()) {
-                return false;
+        }
+        if (algorithm_ != MatchingAlgorithm::Fifo && incomingOrder->getRemainingQuantity() < ordersAtPrice.totalQuantity()) {
+            // Own orders are dealt with one at a time before the level is shared out
+            if (self != 0) {
+                auto own = std::find_if(ordersAtPrice.begin(), ordersAtPrice.end(),
+                                        [self](OrderPointer order) { return order->getParticipant() == self; });
+                if (own != ordersAtPrice.end()) {
+                    if (!preventSelfTrade(incomingOrder, *own)) {
+                        break;
+                    }
+                    continue;
+                }
             }
-            const auto& [bestAskingPrice, _] = *sellOrders.begin();
-            return price >= bestAskingPrice;
-        } else {
-            const auto& buyOrders = orderBook_.getBuyOrders();
-            if (buyOrders.empty()) {
-                return false;
+            return matchProRata<Side>(incomingOrder, levelPrice, ordersAtPrice); // this level finishes the order
+        }
+
+        auto restingOrder = ordersAtPrice.front();
+        if (OrderError error = checkResting<Side>(*restingOrder); error != OrderError::None) {
+            return error;
+        }
+        if (self != 0 && restingOrder->getParticipant() == self) {
+            if (!preventSelfTrade(incomingOrder, restingOrder)) {
+                break;
             }
-            const auto& [bestBuyingPrice, _] = *buyOrders.begin();
-            return price <= bestBuyingPrice;
+            continue;
+        }
+
+        recordTrade(executeTrade(incomingOrder, restingOrder, ordersAtPrice));
+        orderBook_.getStops().onTrade(levelPrice);
+
+        if (restingOrder->getOrderStatus() == OrderStatus::Filled) {
+            orderBook_.removeOrder(restingOrder->getOrderId());
         }
-    } else {
-        throw std::invalid_argument("Order Type not implemented yet"); // should not execute
     }
+    return OrderError::None;
 }
 
-TradePointer MatchingEngine::executeTrade(const OrderPointer incomingOrder, const OrderPointer restingOrder) {
-    OrderId incomingOrderId = incomingOrder->getOrderId();
-    OrderId restingOrderId = restingOrder->getOrderId();
+// Applies the self-trade prevention mode to a pair of orders of the same participant. Returns
+// whether the incoming order is still live and should keep matching.
+template <typename Book, typename History, ValidationLevel Checks>
+bool BasicMatchingEngine<Book, History, Checks>::preventSelfTrade(OrderPointer incomingOrder, OrderPointer restingOrder) {
+    switch (selfTradePrevention_) {
+        case SelfTradePrevention::CancelResting:
+            cancelResting(restingOrder->getOrderId());
+            return true;
+
+        case SelfTradePrevention::CancelIncoming:
+            cancelIncoming(incomingOrder);
+            return false;
+
+        case SelfTradePrevention::CancelBoth:
+            cancelResting(restingOrder->getOrderId());
+            cancelIncoming(incomingOrder);
+            return false;
 
-    if (incomingOrder->getOrderSide() == restingOrder->getOrderSide()) {
-        throw std::logic_error(
-            std::format(
-                "Unable to execute trade between incoming order ({}) and resting order ({}) as they are of the same side", 
-                incomingOrderId,
-                restingOrderId));
+        case SelfTradePrevention::Decrement: {
+            Quantity quantity = std::min(incomingOrder->getRemainingQuantity(), restingOrder->getVisibleQuantity());
+            if (quantity == restingOrder->getRemainingQuantity()) {
+                cancelResting(restingOrder->getOrderId());
+            } else {
+                orderBook_.decrementOrder(restingOrder, quantity);
+                report(ExecutionType::Replaced, *restingOrder, restingOrder->getRemainingQuantity());
+            }
+            if (quantity == incomingOrder->getRemainingQuantity()) {
+                cancelIncoming(incomingOrder);
+                return false;
+            }
+            incomingOrder->setOpenQuantity(incomingOrder->getRemainingQuantity() - quantity);
+            report(ExecutionType::Replaced, *incomingOrder, incomingOrder->getRemainingQuantity());
+            return true;
+        }
+
+        case SelfTradePrevention::None:
+            break;
     }
+    return true;
+}
 
-    if (incomingOrder->getOrderStatus() == OrderStatus::Cancelled || restingOrder->getOrderStatus() == OrderStatus::Cancelled) {
-        throw std::logic_error(
-            std::format(
-                "Unable to execute trade as one or both orders are cancelled. Incoming order ({}), Resting order ({})",
-                incomingOrderId,
-                restingOrderId));
+// Cancels a resting order or dormant stop, reporting it first while the order is still alive
+template <typename Book, typename History, ValidationLevel Checks>
+void BasicMatchingEngine<Book, History, Checks>::cancelResting(OrderId orderId) {
+    if constexpr (kReportsExecutions) {
+        auto it = orderBook_.getOrders().find(orderId);
+        const Order* order = it != orderBook_.getOrders().end() ? it->second : orderBook_.getStops().find(orderId);
+        if (order == nullptr) {
+            return;
+        }
+        report(ExecutionType::Cancelled, *order, order->getRemainingQuantity());
     }
+    orderBook_.cancelOrder(orderId);
+}
 
-    Quantity orderQuantity = std::min(incomingOrder->getRemainingQuantity(), restingOrder->getRemainingQuantity());
-    Price orderPrice = restingOrder->getPrice();
-    incomingOrder->fill(orderQuantity);
-    restingOrder->fill(orderQuantity);
+// What is left of an incoming order that will not rest
+template <typename Book, typename History, ValidationLevel Checks>
+void BasicMatchingEngine<Book, History, Checks>::cancelIncoming(OrderPointer incomingOrder) {
+    incomingOrder->tryCancel(); // not filled, so this cannot fail
+    report(ExecutionType::Cancelled, *incomingOrder, incomingOrder->getRemainingQuantity());
+}
 
-    // URVO
-    if (incomingOrder->getOrderSide() == OrderSide::Buy) {
-        return Trade::createTrade(incomingOrder, restingOrder, orderPrice, orderQuantity);
-    } else {
-        return Trade::createTrade(restingOrder, incomingOrder, orderPrice, orderQuantity);
+template <typename Book, typename History, ValidationLevel Checks>
+void BasicMatchingEngine<Book, History, Checks>::report(ExecutionType type, const Order& order, Quantity quantity, OrderError reason) {
+    if constexpr (kReportsExecutions) {
+        const bool done = type == ExecutionType::Cancelled || type == ExecutionType::Rejected;
+        tradeHistory_.onExecution({ order.getOrderId(), 0, order.getPrice(), quantity, done ? 0 : order.getRemainingQuantity(),
+                                    order.getSymbol(), type, static_cast<std::uint8_t>(order.getOrderSide()), reason, 0 });
     }
 }
 
-template <typename BookType>
-void MatchingEngine::matchWithBook(OrderPointer incomingOrder, BookType& oppositeBook) {
-    while (incomingOrder->getRemainingQuantity() > 0) {
-        if (!canMatch(incomingOrder)) {
-            break;
+template <typename Book, typename History, ValidationLevel Checks>
+void BasicMatchingEngine<Book, History, Checks>::reportFill(const Order& order, const Order& counterOrder, Price price, Quantity quantity) {
+    if constexpr (kReportsExecutions) {
+        Quantity leaves = order.getRemainingQuantity();
+        tradeHistory_.onExecution({ order.getOrderId(), counterOrder.getOrderId(), price, quantity, leaves, order.getSymbol(),
+                                    leaves == 0 ? ExecutionType::Filled : ExecutionType::PartiallyFilled,
+                                    static_cast<std::uint8_t>(order.getOrderSide()), OrderError::None, 0 });
+    }
+}
+
+// The engine only ever pairs an incoming order with a live order from the opposite side of the book
+template <typename Book, typename History, ValidationLevel Checks>
+template <OrderSide Side>
+OrderError BasicMatchingEngine<Book, History, Checks>::checkResting(const Order& restingOrder) const {
+    if constexpr (Checks == ValidationLevel::Full) {
+        if (restingOrder.getOrderSide() != oppositeOf(Side) || restingOrder.getRemainingQuantity() == 0
+            || restingOrder.getOrderStatus() == OrderStatus::Cancelled) {
+            return OrderError::InvariantViolation;
         }
-        auto& [_, ordersAtPrice] = *oppositeBook.begin();
-        auto restingOrder = ordersAtPrice.front();
-        TradePointer trade = executeTrade(incomingOrder, restingOrder);
-        tradeHistory_.recordTrade(trade);
+    } else if constexpr (Checks == ValidationLevel::Debug) {
+        assert(restingOrder.getOrderSide() == oppositeOf(Side) && "incoming and resting order are on the same side");
+        assert(restingOrder.getOrderStatus() != OrderStatus::Cancelled && "cannot trade a cancelled order");
+    }
+    return OrderError::None;
+}
+
+// Shares the incoming order's whole remaining quantity, which is less than the level holds, across
+// the level. Every order keeps something, so the level outlives the match.
+template <typename Book, typename History, ValidationLevel Checks>
+template <OrderSide Side>
+OrderError BasicMatchingEngine<Book, History, Checks>::matchProRata(OrderPointer incomingOrder, Price levelPrice, OrderQueue& level) {
+    levelOrders_.clear();
+    levelSizes_.clear();
+    for (OrderPointer restingOrder : level) {
+        if (OrderError error = checkResting<Side>(*restingOrder); error != OrderError::None) {
+            return error;
+        }
+        levelOrders_.push_back(restingOrder);
+        levelSizes_.push_back(restingOrder->getVisibleQuantity());
+    }
+    levelShares_.assign(levelSizes_.size(), 0);
+
+    Quantity quantity = incomingOrder->getRemainingQuantity();
+    std::uint64_t total = level.totalQuantity();
+    std::size_t first = 0;
+    if (algorithm_ == MatchingAlgorithm::ProRataTopOrder) {
+        levelShares_[0] = std::min(quantity, levelSizes_[0]);
+        quantity -= levelShares_[0];
+        total -= levelSizes_[0];
+        first = 1;
+    }
+    if (quantity > 0) {
+        allocateProRata(std::span<const Quantity>(levelSizes_).subspan(first), std::span<Quantity>(levelShares_).subspan(first),
+                        quantity, total);
+    }
+
+    // Trades go out in time priority
+    for (std::size_t i = 0; i < levelOrders_.size(); ++i) {
+        if (levelShares_[i] == 0) {
+            continue;
+        }
+        OrderPointer restingOrder = levelOrders_[i];
+        recordTrade(executeTrade(incomingOrder, restingOrder, level, levelShares_[i]));
+        orderBook_.getStops().onTrade(levelPrice);
 
         if (restingOrder->getOrderStatus() == OrderStatus::Filled) {
             orderBook_.removeOrder(restingOrder->getOrderId());
         }
     }
+    return OrderError::None;
 }
 
-template <typename BookType>
-void MatchingEngine::tryToMatchWithBook(OrderPointer incomingOrder, BookType& oppositeBook) {
-    OrderPointers entries;
-    Quantity qtyNeeded = incomingOrder->getInitialQuantity();
-    auto levelIt = oppositeBook.begin();
-    while (qtyNeeded > 0 && levelIt != oppositeBook.end()) {
+template <typename Book, typename History, ValidationLevel Checks>
+template <OrderSide Side, OrderType Type, typename BookType>
+bool BasicMatchingEngine<Book, History, Checks>::canFillCompletely(const Order& incomingOrder, const BookType& oppositeBook) const {
+    std::uint64_t qtyNeeded = incomingOrder.getRemainingQuantity();
+    const ParticipantId self = selfTradePrevention_ != SelfTradePrevention::None ? incomingOrder.getParticipant() : 0;
+    for (auto levelIt = oppositeBook.begin(); qtyNeeded > 0 && levelIt != oppositeBook.end(); ++levelIt) {
         const auto& [price, ordersAtPrice] = *levelIt;
-        if ((incomingOrder->getOrderSide() == OrderSide::Buy && price > incomingOrder->getPrice())
-            || (incomingOrder->getOrderSide() == OrderSide::Sell && price < incomingOrder->getPrice())) {
+        if (!crosses<Side, Type>(price, incomingOrder.getPrice())) {
             break;
         }
+        if (self == 0) {
+            qtyNeeded -= std::min(qtyNeeded, ordersAtPrice.totalQuantity());
+            continue;
+        }
 
-        Quantity totalQtyAtPrice = std::accumulate(ordersAtPrice.begin(), ordersAtPrice.end(), 0, 
-                                                        [](Quantity acc, const OrderPointer& order) {
-                                                            return acc + order->getRemainingQuantity();
-                                                        });
-        if (totalQtyAtPrice < qtyNeeded) {
-            entries.insert(entries.end(), ordersAtPrice.begin(), ordersAtPrice.end());
-            qtyNeeded -= totalQtyAtPrice;
-        } else {
-            auto orderIt = ordersAtPrice.begin();
-            while (qtyNeeded > 0 && orderIt != ordersAtPrice.end()) {
-                Quantity currQty = std::min(qtyNeeded, (*orderIt)->getRemainingQuantity());
-                entries.push_back(*orderIt);
-                qtyNeeded -= currQty;
-                ++orderIt;
+        // The participant's own orders never fill it. CancelResting only takes them out of the way;
+        // every other mode stops or shrinks the order once the sweep reaches one, so it has to fill
+        // before then, and a pro-rata level deals with own orders before anything else
+        const bool ownStopsSweep = selfTradePrevention_ != SelfTradePrevention::CancelResting;
+        if (ownStopsSweep && algorithm_ != MatchingAlgorithm::Fifo
+            && std::any_of(ordersAtPrice.begin(), ordersAtPrice.end(),
+                           [self](OrderPointer order) { return order->getParticipant() == self; })) {
+            return false;
+        }
+        for (auto it = ordersAtPrice.begin(); qtyNeeded > 0 && it != ordersAtPrice.end(); ++it) {
+            if ((*it)->getParticipant() != self) {
+                qtyNeeded -= std::min<std::uint64_t>(qtyNeeded, (*it)->getVisibleQuantity());
+            } else if (ownStopsSweep) {
+                return false;
             }
         }
-        ++levelIt;
     }
+    return qtyNeeded == 0;
+}
 
-    if (qtyNeeded == 0) {
-        for (const auto& entry : entries) {
-            TradePointer trade = executeTrade(incomingOrder, entry);
-            tradeHistory_.recordTrade(trade);
+template <typename Book, typename History, ValidationLevel Checks>
+Trade BasicMatchingEngine<Book, History, Checks>::executeTrade(const OrderPointer incomingOrder, const OrderPointer restingOrder, OrderQueue& restingLevel) {
+    // The fill is the smaller of what the incoming order needs and what the resting order shows
+    // (an iceberg only its current slice), so neither side can be overfilled
+    return executeTrade(incomingOrder, restingOrder, restingLevel,
+                        std::min(incomingOrder->getRemainingQuantity(), restingOrder->getVisibleQuantity()));
+}
 
-            if (entry->getOrderStatus() == OrderStatus::Filled) {
-                orderBook_.removeOrder(entry->getOrderId());
-            }
-        }
+template <typename Book, typename History, ValidationLevel Checks>
+Trade BasicMatchingEngine<Book, History, Checks>::executeTrade(const OrderPointer incomingOrder, const OrderPointer restingOrder, OrderQueue& restingLevel,
+                                                               Quantity orderQuantity) {
+    OB_LATENCY_SCOPE(LatencyStage::ExecuteTrade);
+    Price orderPrice = restingOrder->getPrice();
+    incomingOrder->tryFill(orderQuantity);
+    orderBook_.fillOrder(restingOrder, restingLevel, orderQuantity);
+    reportFill(*incomingOrder, *restingOrder, orderPrice, orderQuantity);
+    reportFill(*restingOrder, *incomingOrder, orderPrice, orderQuantity);
+
+    // URVO
+    if (incomingOrder->getOrderSide() == OrderSide::Buy) {
+        return Trade::createTrade(incomingOrder, restingOrder, orderPrice, orderQuantity);
+    } else {
+        return Trade::createTrade(restingOrder, incomingOrder, orderPrice, orderQuantity);
     }
 }
 
-} // namespace ob
\ No newline at end of file
+template class BasicMatchingEngine<OrderBook, TradeHistory>;
+template class BasicMatchingEngine<LadderOrderBook, TradeHistory>;
+template class BasicMatchingEngine<OrderBook, RingTradeHistory>;
+template class BasicMatchingEngine<LadderOrderBook, RingTradeHistory>;
+template class BasicMatchingEngine<OrderBook, RingExecutionSink>;
+template class BasicMatchingEngine<LadderOrderBook, RingExecutionSink>;
+template class BasicMatchingEngine<OrderBook, NullExecutionSink>;
+template class BasicMatchingEngine<OrderBook, TradeHistory, ValidationLevel::None>;
+template class BasicMatchingEngine<OrderBook, TradeHistory, ValidationLevel::Full>;
+
+} // namespace ob
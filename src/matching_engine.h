@@ -1,33 +1,165 @@
 #pragma once
 
+#include "execution_report.h"
+#include "matching_algorithm.h"
 #include "order.h"
 #include "orderbook.h"
 #include "tradehistory.h"
+#include "utils/object_pool.h"
+
+#include <array>
+#include <cstddef>
+#include <span>
+#include <utility>
+#include <vector>
 
 namespace ob {
 
-class MatchingEngine {
+// How much the engine re-checks its own invariants on every fill
+enum class ValidationLevel {
+    None,   // trust the book completely
+    Debug,  // assert, so free in release builds
+    Full    // always checked; a broken invariant stops the match and is reported as InvariantViolation
+};
+
+// History is the sink the engine reports to: anything with recordTrade(const Trade&), e.g.
+// TradeHistory or RingTradeHistory, and/or onExecution(const ExecutionReport&), e.g.
+// RingExecutionSink. Which of the two it has is settled at compile time, so an engine never pays
+// for reports its sink does not take. Every (side, type, time-in-force) combination gets its own matching routine,
+// picked once per order from a table, so the sweep itself carries no per-fill branching on them.
+template <typename Book, typename History = TradeHistory, ValidationLevel Checks = ValidationLevel::Debug>
+class BasicMatchingEngine {
 private:
-    OrderBook& orderBook_;
-    TradeHistory& tradeHistory_;    
+    Book& orderBook_;
+    History& tradeHistory_;    
+    MatchingAlgorithm algorithm_ = MatchingAlgorithm::Fifo;
+    SelfTradePrevention selfTradePrevention_ = SelfTradePrevention::None;
+
+    // Scratch space for pro-rata levels, reused so a match never allocates once warmed up
+    std::vector<OrderPointer> levelOrders_;
+    std::vector<Quantity> levelSizes_;
+    std::vector<Quantity> levelShares_;
+    // Orders a mass cancel has taken out of the book, reported and then released together
+    OrderPointers massCancelled_;
+    // Orders advanceTime has taken out of the expiry wheel, up to kExpiryBatch at a time
+    OrderPointers expired_;
+    Timestamp sessionEnd_ = 0;
+    // The order the two-argument onNewOrder reports on, and its status when it last left matching
+    OrderPointer tracked_ = nullptr;
+    OrderStatus trackedStatus_ = OrderStatus::New;
 
 public:
-    MatchingEngine(OrderBook& orderBook, TradeHistory& tradeHistory)
+    BasicMatchingEngine(Book& orderBook, History& tradeHistory)
         : orderBook_ { orderBook }
         , tradeHistory_ { tradeHistory }
     { }
 
-    void onNewOrder(OrderPointer order);
+    // Only fails for input the gateway would have rejected; the order is then left untouched.
+    // Requests for ids the engine does not know produce no execution report.
+    // Stop orders wait in the book's TriggerBook until a trade reaches their stop price; the stops
+    // a match triggers are matched, one after another, before this returns.
+    OrderError onNewOrder(OrderPointer order);
+    OrderError onNewOrder(OrderHandle handle) { return onNewOrder(ObjectPool::resolve(handle)); }
+    // Same, and status receives the order's status as matching left it: Filled, Cancelled (killed,
+    // or by self-trade prevention) or as it rests. A filled or cancelled order has already been
+    // released when this returns, so this is the only safe way to learn how it ended.
+    OrderError onNewOrder(OrderPointer order, OrderStatus& status);
     void onCancelOrder(OrderId id);
+    // Changes a resting order's price and open quantity. Reducing the quantity at the same price
+    // keeps its time priority; any other change sends it to the back of the queue at price, and
+    // a price that crosses the opposite side is matched like a new order. Amending to zero cancels.
+    OrderError onAmendOrder(OrderId id, Price price, Quantity quantity);
+
+    // Same as calling onNewOrder / onCancelOrder for each element in order
+    void onNewOrders(std::span<const OrderPointer> orders);
+    void onCancelOrders(std::span<const OrderId> orderIds);
+
+    // Cancels every resting order and dormant stop that matches filter, e.g. one participant's
+    // orders or a whole side, and returns how many were cancelled. Each gets a Cancelled report.
+    std::size_t onMassCancel(const MassCancelFilter& filter);
+
+    // Moves the engine clock forward to now and cancels every GoodTillDate and Day order whose
+    // expire time it reaches, oldest expiry first, exactly as onCancelOrder would. Returns how
+    // many expired. The clock starts at 0 and never goes back; a new GoodTillDate order must
+    // expire after it. It is kept by the book's ExpiryWheel, so a book loaded from a snapshot
+    // brings its clock with it.
+    std::size_t advanceTime(Timestamp now);
+    Timestamp getTime() const { return orderBook_.getExpiries().now(); }
+
+    // Day orders take the session end as their expire time when they arrive, so one that arrives
+    // with no session end ahead of the clock is rejected
+    Timestamp getSessionEnd() const { return sessionEnd_; }
+    void setSessionEnd(Timestamp time) { sessionEnd_ = time; }
+
+    static constexpr std::size_t kExpiryBatch = 256;
+
+    bool isValidPrice(Price price) const { return orderBook_.isValidPrice(price); }
+
+    // Applies to levels the incoming order cannot clear; a level it can clear fills whole either way
+    MatchingAlgorithm getMatchingAlgorithm() const { return algorithm_; }
+    void setMatchingAlgorithm(MatchingAlgorithm algorithm) { algorithm_ = algorithm; }
+
+    // Only orders that carry a participant id (non-zero) are checked
+    SelfTradePrevention getSelfTradePrevention() const { return selfTradePrevention_; }
+    void setSelfTradePrevention(SelfTradePrevention mode) { selfTradePrevention_ = mode; }
 
 private:
-    bool canMatch(OrderPointer order);
-    TradePointer executeTrade(const OrderPointer buyOrder, const OrderPointer sellOrder);
-    void matchOrders(OrderPointer incomingOrder);
-    
-    template <typename BookType>
-    void matchWithBook(OrderPointer incomingOrder, BookType& oppositeBook);
-    template <typename BookType>
-    void tryToMatchWithBook(OrderPointer incomingOrder, BookType& oppositeBook);
+    static constexpr bool kRecordsTrades = requires(History& history, const Trade& trade) { history.recordTrade(trade); };
+    static constexpr bool kReportsExecutions = requires(History& history, const ExecutionReport& report) { history.onExecution(report); };
+
+    using Routine = OrderError (BasicMatchingEngine::*)(OrderPointer);
+
+    static constexpr std::size_t kSides = 2;
+    static constexpr std::size_t kOrderTypes = 2;
+    static constexpr std::size_t kTimesInForce = 5;
+    static constexpr std::size_t kRoutines = kSides * kOrderTypes * kTimesInForce;
+
+    template <std::size_t Index>
+    static constexpr Routine routineFor();
+    template <std::size_t... Index>
+    static constexpr std::array<Routine, sizeof...(Index)> makeRoutines(std::index_sequence<Index...>);
+
+    static const std::array<Routine, kRoutines> routines_;
+
+    OrderError checkOrder(const Order& order) const;
+    OrderError submit(OrderPointer order);
+    OrderError dispatch(OrderPointer order);
+    OrderError parkStop(OrderPointer order);
+    void releaseTriggeredStops();
+
+    template <OrderSide Side, OrderType Type, TimeInForce Tif>
+    OrderError processOrder(OrderPointer incomingOrder);
+    template <OrderSide Side, OrderType Type, typename BookType>
+    OrderError sweep(OrderPointer incomingOrder, BookType& oppositeBook);
+    bool preventSelfTrade(OrderPointer incomingOrder, OrderPointer restingOrder);
+    template <OrderSide Side>
+    OrderError checkResting(const Order& restingOrder) const;
+    template <OrderSide Side>
+    OrderError matchProRata(OrderPointer incomingOrder, Price levelPrice, OrderQueue& level);
+    template <OrderSide Side, OrderType Type, typename BookType>
+    bool canFillCompletely(const Order& incomingOrder, const BookType& oppositeBook) const;
+
+    void noteStatus(const Order& order) {
+        if (&order == tracked_) {
+            trackedStatus_ = order.getOrderStatus();
+        }
+    }
+    void cancelResting(OrderId orderId);
+    void cancelIncoming(OrderPointer incomingOrder);
+
+    void recordTrade(const Trade& trade) {
+        if constexpr (kRecordsTrades) {
+            tradeHistory_.recordTrade(trade);
+        }
+    }
+    void report(ExecutionType type, const Order& order, Quantity quantity, OrderError reason = OrderError::None);
+    void reportFill(const Order& order, const Order& counterOrder, Price price, Quantity quantity);
+
+    Trade executeTrade(const OrderPointer incomingOrder, const OrderPointer restingOrder, OrderQueue& restingLevel);
+    Trade executeTrade(const OrderPointer incomingOrder, const OrderPointer restingOrder, OrderQueue& restingLevel, Quantity quantity);
 };
+
+using MatchingEngine = BasicMatchingEngine<OrderBook>;
+using LadderMatchingEngine = BasicMatchingEngine<LadderOrderBook>;
+
 } // namespace ob
@@ -1,16 +1,31 @@
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
 #include <format>
+#include <limits>
+#include <optional>
 #include <stdexcept>
+#include <vector>
 
 namespace ob {
 
 enum class OrderType {
     Limit,
-    Market
+    Market,
+    Stop,       // becomes a market order once the last trade reaches its stop price
+    StopLimit   // becomes a limit order at its price once the last trade reaches its stop price
 };
 
+inline constexpr bool isStopOrder(OrderType type) {
+    return type == OrderType::Stop || type == OrderType::StopLimit;
+}
+
+// Whether the order's price is a limit it may rest at
+inline constexpr bool hasLimitPrice(OrderType type) {
+    return type == OrderType::Limit || type == OrderType::StopLimit;
+}
+
 enum class OrderSide {
     Buy,
     Sell
@@ -26,16 +41,50 @@ enum class OrderStatus {
 enum class TimeInForce {
     GoodTillCancel,
     ImmediateOrCancel,
-    FillOrKill
+    FillOrKill,
+    GoodTillDate,   // rests until its expire time
+    Day             // rests until the end of the session
+};
+
+// Whether an unfilled remainder rests in the book instead of being cancelled
+inline constexpr bool restsInBook(TimeInForce timeInForce) {
+    return timeInForce == TimeInForce::GoodTillCancel || timeInForce == TimeInForce::GoodTillDate
+        || timeInForce == TimeInForce::Day;
+}
+
+// Whether a resting order expires on its own, see ExpiryWheel
+inline constexpr bool hasExpiry(TimeInForce timeInForce) {
+    return timeInForce == TimeInForce::GoodTillDate || timeInForce == TimeInForce::Day;
+}
+
+// Why an operation on an order could not be carried out
+enum class OrderError : std::uint8_t {
+    None,
+    FillExceedsRemaining,
+    AlreadyFilled,
+    UnsupportedTimeInForce,
+    UnsupportedOrderType,   // also an out-of-range OrderSide
+    InvariantViolation,     // only reported by engines built with ValidationLevel::Full
+    UnknownOrder,           // no resting order has this id
+    InvalidExpiry           // a GoodTillDate or Day order that would already have expired
 };
 
 using Price = uint32_t;
 using Quantity = std::uint32_t;
 using OrderId = std::uint64_t;
+using SymbolId = std::uint32_t;
+using ParticipantId = std::uint32_t;   // 0 for an order with no known owner
+using Timestamp = std::uint64_t;        // engine time, in whatever unit the caller drives it with
+
+// Compact reference to an Order slot in an OrderArena
+using OrderHandle = std::uint32_t;
+inline constexpr OrderHandle kInvalidOrderHandle = std::numeric_limits<OrderHandle>::max();
 
 
 class Order {
 private:
+    static constexpr std::uint16_t kNoExpirySlot = std::numeric_limits<std::uint16_t>::max();
+
     OrderId orderId_;
     OrderType orderType_;
     OrderSide orderSide_;
@@ -44,9 +93,25 @@ private:
     Quantity initialQuantity_;
     Quantity remainingQuantity_;
     OrderStatus orderStatus_;
+    SymbolId symbol_;
+    Price stopPrice_ = 0;   // Stop and StopLimit only
+    Quantity displayQuantity_ = 0;      // iceberg slice size, 0 shows the whole order
+    Quantity displayedQuantity_ = 0;    // what is left of the current slice
+    ParticipantId participant_ = 0;
+    OrderHandle handle_ = kInvalidOrderHandle; // set when the order lives in an OrderArena
+    std::uint16_t arenaId_ = 0;                 // which OrderArena, when handle_ is set
+    std::uint16_t expirySlot_ = kNoExpirySlot;  // where the order waits in an ExpiryWheel
+    std::uint32_t expiryIndex_ = 0;             // and its position in that slot
+    Timestamp expireTime_ = 0;                  // GoodTillDate and Day only
+    friend class ExpiryWheel;
+
+    // Intrusive links for the price level this order rests in, owned by OrderQueue
+    Order* prevInLevel_ = nullptr;
+    Order* nextInLevel_ = nullptr;
+    friend class OrderQueue;
 
 public:
-    Order(OrderId orderId, OrderType orderType, OrderSide orderSide, TimeInForce timeInForce, Price price, Quantity quantity)
+    Order(OrderId orderId, OrderType orderType, OrderSide orderSide, TimeInForce timeInForce, Price price, Quantity quantity, SymbolId symbol = 0)
         : orderId_ { orderId }
         , orderType_ { orderType }
         , orderSide_ { orderSide }
@@ -55,6 +120,7 @@ public:
         , initialQuantity_ { quantity }
         , remainingQuantity_ { quantity }
         , orderStatus_ { OrderStatus::New }
+        , symbol_ { symbol }
     { }
 
     OrderId getOrderId() const { return orderId_; }
@@ -66,6 +132,21 @@ public:
     Quantity getRemainingQuantity() const { return remainingQuantity_; }
     Quantity getFilledQuantity() const { return getInitialQuantity() - getRemainingQuantity(); }
     OrderStatus getOrderStatus() const { return orderStatus_; }
+    SymbolId getSymbol() const { return symbol_; }
+    Price getStopPrice() const { return stopPrice_; }
+    ParticipantId getParticipant() const { return participant_; }
+    Quantity getDisplayQuantity() const { return displayQuantity_; }
+    Quantity getDisplayedQuantity() const { return displayedQuantity_; }
+    bool isIceberg() const { return displayQuantity_ != 0; }
+    // The part of the open quantity other participants can see and trade against at its level
+    Quantity getVisibleQuantity() const {
+        return isIceberg() ? std::min(displayedQuantity_, remainingQuantity_) : remainingQuantity_;
+    }
+    OrderHandle getHandle() const { return handle_; }
+    std::uint16_t getArenaId() const { return arenaId_; }
+    Timestamp getExpireTime() const { return expireTime_; }
+    // Whether the order is waiting in an ExpiryWheel
+    bool isScheduledToExpire() const { return expirySlot_ != kNoExpirySlot; }
 
     void setOrderId(OrderId id) { orderId_ = id; }
     void setOrderType(OrderType type) { orderType_ = type; }
@@ -75,30 +156,77 @@ public:
     void setInitialQuantity(Quantity qty) { initialQuantity_ = qty; }
     void setRemainingQuantity(Quantity qty) { remainingQuantity_ = qty; }
     void setOrderStatus(OrderStatus status) { orderStatus_ = status; }
+    void setSymbol(SymbolId symbol) { symbol_ = symbol; }
+    void setStopPrice(Price price) { stopPrice_ = price; }
+    void setParticipant(ParticipantId participant) { participant_ = participant; }
+    // Makes the order an iceberg showing quantity at a time
+    void setDisplayQuantity(Quantity quantity) {
+        displayQuantity_ = quantity;
+        displayedQuantity_ = quantity;
+    }
+    void setDisplayedQuantity(Quantity quantity) { displayedQuantity_ = quantity; }
+    // Starts a new iceberg slice from the hidden reserve
+    void refreshDisplay() { displayedQuantity_ = displayQuantity_; }
+    void setHandle(OrderHandle handle) { handle_ = handle; }
+    void setArenaId(std::uint16_t arenaId) { arenaId_ = arenaId; }
+    void setExpireTime(Timestamp time) { expireTime_ = time; }
 
     static Order* createDummyOrder() {
         return new Order{0, OrderType::Limit, OrderSide::Buy, TimeInForce::GoodTillCancel, 0, 0};
     }
 
-    void fill(Quantity quantity) {
-        if (quantity == 0) return;
-        if (quantity > getRemainingQuantity())
-            throw std::logic_error(std::format("Cannot fill Order ({}) as its remaining quantity is less than the fill quantity.", getOrderId()));
-;
+    // Status-code versions used on the matching path
+    OrderError tryFill(Quantity quantity) {
+        if (quantity == 0) return OrderError::None;
+        if (quantity > getRemainingQuantity()) return OrderError::FillExceedsRemaining;
+
         remainingQuantity_ -= quantity;
+        displayedQuantity_ -= std::min(quantity, displayedQuantity_);
 
         if (remainingQuantity_ == 0) orderStatus_ = OrderStatus::Filled;
         else orderStatus_ = OrderStatus::Partial;
+        return OrderError::None;
+    }
+
+    OrderError tryCancel() {
+        if (orderStatus_ == OrderStatus::Filled) return OrderError::AlreadyFilled;
+
+        orderStatus_ = OrderStatus::Cancelled;
+        return OrderError::None;
+    }
+
+    // Changes the quantity still open, keeping what has already been filled
+    void setOpenQuantity(Quantity quantity) {
+        initialQuantity_ = getFilledQuantity() + quantity;
+        remainingQuantity_ = quantity;
+    }
+
+    void fill(Quantity quantity) {
+        if (tryFill(quantity) != OrderError::None)
+            throw std::logic_error(std::format("Cannot fill Order ({}) as its remaining quantity is less than the fill quantity.", getOrderId()));
     }
 
     void cancel() {
-        if (orderStatus_ == OrderStatus::Filled)
+        if (tryCancel() != OrderError::None)
             throw std::logic_error(std::format("Cannot cancel Order ({}) as it has already been filled.", getOrderId()));
-        
-        orderStatus_ = OrderStatus::Cancelled;
     }
 };
 
 using OrderPointer = Order*;
+using OrderPointers = std::vector<OrderPointer>;
+
+// Which orders a mass cancel takes: those that match every part of the filter. Resting orders
+// are matched on their limit price, dormant stops on their stop price.
+struct MassCancelFilter {
+    std::optional<OrderSide> side;      // both sides when empty
+    Price minPrice = 0;
+    Price maxPrice = std::numeric_limits<Price>::max();
+    ParticipantId participant = 0;      // any owner when 0
+
+    bool matchesSide(OrderSide orderSide) const { return !side || *side == orderSide; }
+    bool matchesPrice(Price price) const { return price >= minPrice && price <= maxPrice; }
+    bool matchesOwner(const Order& order) const { return participant == 0 || order.getParticipant() == participant; }
+    bool matchesAll() const { return !side && minPrice == 0 && maxPrice == std::numeric_limits<Price>::max() && participant == 0; }
+};
 
 } // namespace ob
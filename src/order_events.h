@@ -11,9 +11,27 @@ enum class OrderRejectionReason {
     InvalidPrice,
     InvalidQuantity,
     InsufficientLiquidity,
+    InvalidSymbol,
+    UnknownOrder,
+    InvalidExpiry,
     Other
 };
 
+// An order as it is handed between threads, before the matching thread gives it an Order
+struct OrderRequest {
+    OrderId orderId;
+    SymbolId symbol;
+    OrderType orderType;
+    OrderSide orderSide;
+    TimeInForce timeInForce;
+    Price price;
+    Quantity quantity;
+    Price stopPrice = 0;    // Stop and StopLimit only
+    Quantity displayQuantity = 0;   // iceberg slice size, 0 for a fully displayed order
+    ParticipantId participant = 0;  // for self-trade prevention, 0 when unknown
+    Timestamp expireTime = 0;       // GoodTillDate only
+};
+
 struct OrderResult {
     OrderId id;
     bool accepted;
@@ -2,39 +2,160 @@
 
 #include "order.h"
 #include "order_events.h"
+#include "utils/latency.h"
+
+#include <format>
+#include <stdexcept>
 
 namespace ob {
 
-OrderResult OrderGateway::submitOrder(OrderPointer order) {
-    if (order->getPrice() <= 0) {
-        return {order->getOrderId(), false, OrderRejectionReason::InvalidPrice};
+template <typename Engine>
+OrderResult BasicOrderGateway<Engine>::submitOrder(OrderPointer order) {
+    OB_LATENCY_SCOPE(LatencyStage::GatewaySubmit);
+    if (auto reason = validateOrder(order->getOrderType(), order->getTimeInForce(), order->getPrice(), order->getInitialQuantity(),
+                                    order->getStopPrice(), order->getDisplayQuantity(), order->getExpireTime());
+        reason != OrderRejectionReason::None) {
+        return {order->getOrderId(), false, reason};
     }
 
-    if (order->getInitialQuantity() <= 0) {
-        return {order->getOrderId(), false, OrderRejectionReason::InvalidQuantity};
+    if (hasLimitPrice(order->getOrderType()) && !engine_.isValidPrice(order->getPrice())) {
+        return {order->getOrderId(), false, OrderRejectionReason::InvalidPrice};
     }
 
-    if (order->getOrderType() == OrderType::Market && order->getTimeInForce() == TimeInForce::GoodTillCancel) {
-        return {order->getOrderId(), false, OrderRejectionReason::InvalidTIF};
-    }
-    
+#ifdef OB_NO_EXCEPTIONS
+    return matchAccepted(order);
+#else
+    const OrderId orderId = order->getOrderId();   // the order may be gone by the time matching throws
     try {
-        engine_.onNewOrder(order);
+        return matchAccepted(order);
     } catch (std::exception& e) {
-        return {order->getOrderId(), false, OrderRejectionReason::Other};
+        return {orderId, false, OrderRejectionReason::Other};
     }
+#endif
+}
 
-    if ((order->getTimeInForce() == TimeInForce::FillOrKill || order->getTimeInForce() == TimeInForce::ImmediateOrCancel) 
-        && order->getOrderStatus() == OrderStatus::Cancelled) {
-        return {order->getOrderId(), false, OrderRejectionReason::InsufficientLiquidity};
+template <typename Engine>
+OrderResult BasicOrderGateway<Engine>::cancelOrder(OrderId orderId) {
+    if (journal_ != nullptr) {
+        journal_->append(JournalRecord::cancelOrder(orderId));
     }
+    engine_.onCancelOrder(orderId);
+    return {orderId, true, OrderRejectionReason::None};
+}
 
-    return {order->getOrderId(), true, OrderRejectionReason::None};
+template <typename Engine>
+OrderResult BasicOrderGateway<Engine>::amendOrder(OrderId orderId, Price price, Quantity quantity) {
+    // Amending to zero cancels, whatever the price
+    if (quantity != 0) {
+        if (auto reason = validateOrder(OrderType::Limit, TimeInForce::GoodTillCancel, price, quantity);
+            reason != OrderRejectionReason::None) {
+            return {orderId, false, reason};
+        }
+        if (!engine_.isValidPrice(price)) {
+            return {orderId, false, OrderRejectionReason::InvalidPrice};
+        }
+    }
+
+    if (journal_ != nullptr) {
+        journal_->append(JournalRecord::amendOrder(orderId, price, quantity));
+    }
+    switch (engine_.onAmendOrder(orderId, price, quantity)) {
+        case OrderError::None:
+            return {orderId, true, OrderRejectionReason::None};
+        case OrderError::UnknownOrder:
+            return {orderId, false, OrderRejectionReason::UnknownOrder};
+        default:
+            return {orderId, false, OrderRejectionReason::Other};
+    }
 }
 
-OrderResult OrderGateway::cancelOrder(OrderId orderId) {
-    engine_.onCancelOrder(orderId);
+template <typename Engine>
+void BasicOrderGateway<Engine>::submitOrders(std::span<const OrderPointer> orders, std::span<OrderResult> results) {
+    if (results.size() < orders.size()) {
+        throw std::invalid_argument(
+            std::format("Result span holds {} results for a batch of {} orders", results.size(), orders.size()));
+    }
+
+    for (std::size_t i = 0; i < orders.size(); ++i) {
+        OrderPointer order = orders[i];
+        OrderRejectionReason reason = validateOrder(order->getOrderType(), order->getTimeInForce(), order->getPrice(), order->getInitialQuantity(),
+                                                    order->getStopPrice(), order->getDisplayQuantity(), order->getExpireTime());
+        if (reason == OrderRejectionReason::None && hasLimitPrice(order->getOrderType()) && !engine_.isValidPrice(order->getPrice())) {
+            reason = OrderRejectionReason::InvalidPrice;
+        }
+        results[i] = {order->getOrderId(), reason == OrderRejectionReason::None, reason};
+    }
+
+#ifdef OB_NO_EXCEPTIONS
+    for (std::size_t i = 0; i < orders.size(); ++i) {
+        if (results[i].accepted) {
+            results[i] = matchAccepted(orders[i]);
+        }
+    }
+#else
+    // One try block for the whole batch; it is only re-entered after an order throws
+    std::size_t i = 0;
+    while (i < orders.size()) {
+        try {
+            for (; i < orders.size(); ++i) {
+                if (results[i].accepted) {
+                    results[i] = matchAccepted(orders[i]);
+                }
+            }
+        } catch (std::exception& e) {
+            results[i] = {results[i].id, false, OrderRejectionReason::Other};   // set by validation
+            ++i;
+        }
+    }
+#endif
+}
+
+template <typename Engine>
+OrderResult BasicOrderGateway<Engine>::matchAccepted(OrderPointer order) {
+    if (journal_ != nullptr) {
+        journal_->append(JournalRecord::newOrder(*order));
+    }
+
+    // The engine releases an order that ends filled or cancelled, so nothing is read from it after
+    const OrderId orderId = order->getOrderId();
+    const TimeInForce timeInForce = order->getTimeInForce();
+    OrderStatus status;
+    if (OrderError error = engine_.onNewOrder(order, status); error != OrderError::None) {
+        return {orderId, false, error == OrderError::InvalidExpiry ? OrderRejectionReason::InvalidExpiry
+                                                                   : OrderRejectionReason::Other};
+    }
+
+    if ((timeInForce == TimeInForce::FillOrKill || timeInForce == TimeInForce::ImmediateOrCancel)
+        && status == OrderStatus::Cancelled) {
+        return {orderId, false, OrderRejectionReason::InsufficientLiquidity};
+    }
+
     return {orderId, true, OrderRejectionReason::None};
 }
 
+template <typename Engine>
+void BasicOrderGateway<Engine>::cancelOrders(std::span<const OrderId> orderIds, std::span<OrderResult> results) {
+    if (results.size() < orderIds.size()) {
+        throw std::invalid_argument(
+            std::format("Result span holds {} results for a batch of {} cancels", results.size(), orderIds.size()));
+    }
+
+    if (journal_ != nullptr) {
+        for (OrderId orderId : orderIds) {
+            journal_->append(JournalRecord::cancelOrder(orderId));
+        }
+    }
+    engine_.onCancelOrders(orderIds);
+    for (std::size_t i = 0; i < orderIds.size(); ++i) {
+        results[i] = {orderIds[i], true, OrderRejectionReason::None};
+    }
+}
+
+template class BasicOrderGateway<BasicMatchingEngine<OrderBook, TradeHistory>>;
+template class BasicOrderGateway<BasicMatchingEngine<LadderOrderBook, TradeHistory>>;
+template class BasicOrderGateway<BasicMatchingEngine<OrderBook, RingTradeHistory>>;
+template class BasicOrderGateway<BasicMatchingEngine<LadderOrderBook, RingTradeHistory>>;
+template class BasicOrderGateway<BasicMatchingEngine<OrderBook, RingExecutionSink>>;
+template class BasicOrderGateway<BasicMatchingEngine<LadderOrderBook, RingExecutionSink>>;
+
 } // namespace ob
\ No newline at end of file
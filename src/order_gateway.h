@@ -1,22 +1,155 @@
 #pragma once
 
+#include "journal.h"
 #include "matching_engine.h"
 #include "order.h"
 #include "order_events.h"
+#include "utils/object_pool.h"
+
+#include <concepts>
+#include <span>
 
 namespace ob {
 
-class OrderGateway {
+// Checks that do not depend on the state of the book
+inline OrderRejectionReason validateOrder(OrderType type, TimeInForce timeInForce, Price price, Quantity quantity,
+                                          Price stopPrice = 0, Quantity displayQuantity = 0, Timestamp expireTime = 0) {
+    if (price <= 0 || (isStopOrder(type) && stopPrice <= 0)) {
+        return OrderRejectionReason::InvalidPrice;
+    }
+
+    if (quantity <= 0) {
+        return OrderRejectionReason::InvalidQuantity;
+    }
+
+    // Only an order that can rest has anything to hide
+    if (displayQuantity > 0 && (!hasLimitPrice(type) || !restsInBook(timeInForce))) {
+        return OrderRejectionReason::InvalidQuantity;
+    }
+
+    if (type == OrderType::Market && restsInBook(timeInForce)) {
+        return OrderRejectionReason::InvalidTIF;
+    }
+
+    // Only a GoodTillDate order carries its own expire time; dormant stops never expire
+    if ((timeInForce == TimeInForce::GoodTillDate) != (expireTime != 0) || (hasExpiry(timeInForce) && isStopOrder(type))) {
+        return OrderRejectionReason::InvalidTIF;
+    }
+
+    return OrderRejectionReason::None;
+}
+
+// Engines that take orders by value and route them to a book by symbol, e.g. ShardedMatchingEngine
+template <typename Engine>
+concept SymbolRoutingEngine = requires(Engine& engine, const OrderRequest& request, SymbolId symbol, OrderId orderId, Price price) {
+    engine.onNewOrder(request);
+    engine.onCancelOrder(symbol, orderId);
+    engine.onAmendOrder(symbol, orderId, price, Quantity{});
+    { engine.hasInstrument(symbol) } -> std::convertible_to<bool>;
+    { engine.isValidPrice(symbol, price) } -> std::convertible_to<bool>;
+};
+
+template <typename Engine>
+class BasicOrderGateway {
 public:
-    explicit OrderGateway(MatchingEngine& engine)
+    explicit BasicOrderGateway(Engine& engine)
         : engine_ { engine }
     {}
 
+    // Every accepted order and cancel is appended to the journal before it reaches the engine
+    void setJournal(JournalWriter* journal) { journal_ = journal; }
+
     OrderResult submitOrder(OrderPointer order);
+    OrderResult submitOrder(OrderHandle handle) { return submitOrder(ObjectPool::resolve(handle)); }
     OrderResult cancelOrder(OrderId orderId);
+    // See MatchingEngine::onAmendOrder; the new price and quantity are validated like a new order's,
+    // except that a quantity of zero cancels the order without looking at the price
+    OrderResult amendOrder(OrderId orderId, Price price, Quantity quantity);
+
+    // Validates the whole batch first, then matches the accepted orders in sequence.
+    // results[i] receives the outcome of orders[i]; results must be at least as long as orders.
+    void submitOrders(std::span<const OrderPointer> orders, std::span<OrderResult> results);
+    void cancelOrders(std::span<const OrderId> orderIds, std::span<OrderResult> results);
+
+    // Journaled like orders, so a replay expires the same orders at the same point
+    void advanceTime(Timestamp now) {
+        if (journal_ != nullptr) {
+            journal_->append(JournalRecord::advanceTime(now));
+        }
+        engine_.advanceTime(now);
+    }
+    void setSessionEnd(Timestamp time) {
+        if (journal_ != nullptr) {
+            journal_->append(JournalRecord::sessionEnd(time));
+        }
+        engine_.setSessionEnd(time);
+    }
+
+    // Validates on the calling thread and hands the order to the engine, which matches it
+    // asynchronously, so an accepted result only means the order passed validation
+    OrderResult submitOrder(const OrderRequest& request) requires SymbolRoutingEngine<Engine> {
+        if (auto reason = validateOrder(request.orderType, request.timeInForce, request.price, request.quantity, request.stopPrice,
+                                            request.displayQuantity, request.expireTime);
+            reason != OrderRejectionReason::None) {
+            return {request.orderId, false, reason};
+        }
+
+        if (!engine_.hasInstrument(request.symbol)) {
+            return {request.orderId, false, OrderRejectionReason::InvalidSymbol};
+        }
+
+        if (hasLimitPrice(request.orderType) && !engine_.isValidPrice(request.symbol, request.price)) {
+            return {request.orderId, false, OrderRejectionReason::InvalidPrice};
+        }
+
+        if (journal_ != nullptr) {
+            journal_->append(JournalRecord::newOrder(request));
+        }
+        engine_.onNewOrder(request);
+        return {request.orderId, true, OrderRejectionReason::None};
+    }
+
+    OrderResult cancelOrder(SymbolId symbol, OrderId orderId) requires SymbolRoutingEngine<Engine> {
+        if (!engine_.hasInstrument(symbol)) {
+            return {orderId, false, OrderRejectionReason::InvalidSymbol};
+        }
+        if (journal_ != nullptr) {
+            journal_->append(JournalRecord::cancelOrder(orderId, symbol));
+        }
+        engine_.onCancelOrder(symbol, orderId);
+        return {orderId, true, OrderRejectionReason::None};
+    }
+
+    // Validated like amendOrder; whether the order was still resting is only known to the engine
+    OrderResult amendOrder(SymbolId symbol, OrderId orderId, Price price, Quantity quantity) requires SymbolRoutingEngine<Engine> {
+        if (!engine_.hasInstrument(symbol)) {
+            return {orderId, false, OrderRejectionReason::InvalidSymbol};
+        }
+        if (quantity != 0) {
+            if (auto reason = validateOrder(OrderType::Limit, TimeInForce::GoodTillCancel, price, quantity);
+                reason != OrderRejectionReason::None) {
+                return {orderId, false, reason};
+            }
+            if (!engine_.isValidPrice(symbol, price)) {
+                return {orderId, false, OrderRejectionReason::InvalidPrice};
+            }
+        }
+        if (journal_ != nullptr) {
+            journal_->append(JournalRecord::amendOrder(orderId, price, quantity, symbol));
+        }
+        engine_.onAmendOrder(symbol, orderId, price, quantity);
+        return {orderId, true, OrderRejectionReason::None};
+    }
 
 private:
-    MatchingEngine& engine_;
+    Engine& engine_;
+    JournalWriter* journal_ = nullptr;
+
+    // Journals and matches an order that passed validation
+    OrderResult matchAccepted(OrderPointer order);
 };
 
-} // namespace ob
\ No newline at end of file
+using OrderGateway = BasicOrderGateway<MatchingEngine>;
+using LadderOrderGateway = BasicOrderGateway<LadderMatchingEngine>;
+
+} // namespace ob
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "order.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+
+namespace ob {
+
+// FIFO of the resting orders at one price level. Links live in Order itself, so removing an
+// order from anywhere in the queue is a constant-time unlink with no search and no shifting.
+// An order can be in at most one OrderQueue at a time. The queue also keeps the level's total
+// visible quantity (icebergs count only their current slice); fills of queued orders must go
+// through fill() so that it stays accurate.
+class OrderQueue {
+public:
+    class iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = OrderPointer;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const OrderPointer*;
+        using reference = OrderPointer;
+
+        iterator() = default;
+        explicit iterator(OrderPointer order) : order_ { order } { }
+
+        OrderPointer operator*() const { return order_; }
+
+        iterator& operator++() {
+            order_ = order_->nextInLevel_;
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        bool operator==(const iterator& other) const { return order_ == other.order_; }
+
+    private:
+        OrderPointer order_ = nullptr;
+    };
+
+    using const_iterator = iterator;
+
+    void push_back(OrderPointer order) {
+        order->prevInLevel_ = tail_;
+        order->nextInLevel_ = nullptr;
+        if (tail_ != nullptr) {
+            tail_->nextInLevel_ = order;
+        } else {
+            head_ = order;
+        }
+        tail_ = order;
+        ++size_;
+        totalQuantity_ += order->getVisibleQuantity();
+    }
+
+    void erase(OrderPointer order) {
+        if (order->prevInLevel_ != nullptr) {
+            order->prevInLevel_->nextInLevel_ = order->nextInLevel_;
+        } else {
+            head_ = order->nextInLevel_;
+        }
+        if (order->nextInLevel_ != nullptr) {
+            order->nextInLevel_->prevInLevel_ = order->prevInLevel_;
+        } else {
+            tail_ = order->prevInLevel_;
+        }
+        order->prevInLevel_ = nullptr;
+        order->nextInLevel_ = nullptr;
+        --size_;
+        totalQuantity_ -= order->getVisibleQuantity();
+    }
+
+    // Fills an order resting in this queue; an overfill leaves both the order and the queue as they were
+    OrderError fill(OrderPointer order, Quantity quantity) {
+        Quantity visibleBefore = order->getVisibleQuantity();
+        OrderError error = order->tryFill(quantity);
+        if (error == OrderError::None) {
+            totalQuantity_ -= visibleBefore - order->getVisibleQuantity();
+        }
+        return error;
+    }
+
+    // Shows an iceberg's next slice, with the time priority of a new arrival
+    void replenish(OrderPointer order) {
+        erase(order);
+        order->refreshDisplay();
+        push_back(order);
+    }
+
+    // Changes the open quantity of an order in this queue without moving it in the queue
+    void resize(OrderPointer order, Quantity quantity) {
+        totalQuantity_ -= order->getVisibleQuantity();
+        order->setOpenQuantity(quantity);
+        totalQuantity_ += order->getVisibleQuantity();
+    }
+
+    // Takes quantity off an order's open quantity and its current slice without counting it as
+    // filled; quantity must not be more than the order shows
+    void decrement(OrderPointer order, Quantity quantity) {
+        totalQuantity_ -= order->getVisibleQuantity();
+        Quantity displayed = order->getDisplayedQuantity();
+        order->setOpenQuantity(order->getRemainingQuantity() - quantity);
+        order->setDisplayedQuantity(displayed - std::min(quantity, displayed));
+        totalQuantity_ += order->getVisibleQuantity();
+    }
+
+    // Forgets every order in the queue without touching them
+    void clear() {
+        head_ = nullptr;
+        tail_ = nullptr;
+        size_ = 0;
+        totalQuantity_ = 0;
+    }
+
+    OrderPointer front() const { return head_; }
+    OrderPointer back() const { return tail_; }
+    bool empty() const { return size_ == 0; }
+    std::size_t size() const { return size_; }
+    std::uint64_t totalQuantity() const { return totalQuantity_; }
+
+    iterator begin() const { return iterator{head_}; }
+    iterator end() const { return iterator{}; }
+
+private:
+    OrderPointer head_ = nullptr;
+    OrderPointer tail_ = nullptr;
+    std::size_t size_ = 0;
+    std::uint64_t totalQuantity_ = 0;
+};
+
+} // namespace ob
@@ -1,58 +1,250 @@
 #include "orderbook.h"
 
 #include "order.h"
+#include "utils/latency.h"
 #include "utils/object_pool.h"
 
 #include <format>
 
 namespace ob {
 
-void OrderBook::addOrder(OrderPointer order) {
+template <typename BuySide, typename SellSide>
+void BasicOrderBook<BuySide, SellSide>::addOrder(OrderPointer order) {
+    OB_LATENCY_SCOPE(LatencyStage::BookInsert);
     Price orderPrice = order->getPrice();
     orders_.emplace(order->getOrderId(), order);
+    if (hasExpiry(order->getTimeInForce())) {
+        expiries_.schedule(order);
+    }
     if (order->getOrderSide() == OrderSide::Buy) {
-        buyOrders_[orderPrice].push_back(order);
+        auto& ordersAtPriceLevel = buyOrders_[orderPrice];
+        ordersAtPriceLevel.push_back(order);
+        publishLevel(OrderSide::Buy, orderPrice, &ordersAtPriceLevel);
     } else {
-        sellOrders_[orderPrice].push_back(order);
+        auto& ordersAtPriceLevel = sellOrders_[orderPrice];
+        ordersAtPriceLevel.push_back(order);
+        publishLevel(OrderSide::Sell, orderPrice, &ordersAtPriceLevel);
     }
 }
 
-void OrderBook::removeOrder(OrderId orderId) {
+template <typename BuySide, typename SellSide>
+void BasicOrderBook<BuySide, SellSide>::removeOrder(OrderId orderId) {
+    if (OrderPointer order = takeOrder(orderId)) {
+        ObjectPool::release(order);
+    }
+}
+
+template <typename BuySide, typename SellSide>
+OrderPointer BasicOrderBook<BuySide, SellSide>::takeOrder(OrderId orderId) {
     const auto& it = orders_.find(orderId);
     if (it == orders_.end()) {
         // might want to log
-        return;
+        return nullptr;
     }
 
-    auto order = it->second; // if make as a reference, need to swap below orders_.erase(it) and ObjectPool::release to avoid seg fault due to reference erased UB
+    auto order = it->second;
     Price orderPrice = order->getPrice();
     if (order->getOrderSide() == OrderSide::Buy) {
         auto& ordersAtPriceLevel = buyOrders_[orderPrice];
-        auto it = std::find(ordersAtPriceLevel.begin(), ordersAtPriceLevel.end(), order);
-        ordersAtPriceLevel.erase(it);
-        if (buyOrders_[orderPrice].empty()) {
+        ordersAtPriceLevel.erase(order);
+        if (ordersAtPriceLevel.empty()) {
             buyOrders_.erase(orderPrice);
+            publishLevel(OrderSide::Buy, orderPrice, nullptr);
+        } else {
+            publishLevel(OrderSide::Buy, orderPrice, &ordersAtPriceLevel);
         }
     } else {
         auto& ordersAtPriceLevel = sellOrders_[orderPrice];
-        auto it = std::find(ordersAtPriceLevel.begin(), ordersAtPriceLevel.end(), order);
-        ordersAtPriceLevel.erase(it);
-        if (sellOrders_[orderPrice].empty()) {
+        ordersAtPriceLevel.erase(order);
+        if (ordersAtPriceLevel.empty()) {
             sellOrders_.erase(orderPrice);
+            publishLevel(OrderSide::Sell, orderPrice, nullptr);
+        } else {
+            publishLevel(OrderSide::Sell, orderPrice, &ordersAtPriceLevel);
         }
     }
     orders_.erase(it);
-    ObjectPool::release(order);
+    expiries_.cancel(order);
+    return order;
 }
 
-void OrderBook::cancelOrder(OrderId orderId) {
+template <typename BuySide, typename SellSide>
+void BasicOrderBook<BuySide, SellSide>::cancelOrder(OrderId orderId) {
     const auto& it = orders_.find(orderId);
     if (it == orders_.end()) {
-        // might want to log
+        stops_.cancel(orderId);
         return;
     }
     auto order = it->second;
-    order->cancel();
-    removeOrder(orderId);    
+    order->tryCancel(); // resting orders are never filled, they leave the book on their last fill
+    removeOrder(orderId);
+}
+
+template <typename BuySide, typename SellSide>
+std::size_t BasicOrderBook<BuySide, SellSide>::cancelOrders(const MassCancelFilter& filter, OrderPointers& cancelled) {
+    const std::size_t before = cancelled.size();
+    if (filter.matchesSide(OrderSide::Buy)) {
+        cancelLevels(buyOrders_, OrderSide::Buy, filter, cancelled);
+    }
+    if (filter.matchesSide(OrderSide::Sell)) {
+        cancelLevels(sellOrders_, OrderSide::Sell, filter, cancelled);
+    }
+    if (filter.matchesAll()) {
+        orders_.clear();
+    }
+    stops_.cancelOrders(filter, cancelled);
+    return cancelled.size() - before;
+}
+
+template <typename BuySide, typename SellSide>
+template <typename Levels>
+void BasicOrderBook<BuySide, SellSide>::cancelLevels(Levels& levels, OrderSide side, const MassCancelFilter& filter, OrderPointers& cancelled) {
+    // Without an owner to pick out, every order on a level goes, so none of them is unlinked:
+    // the level is dropped whole afterwards
+    const bool wholeLevels = filter.participant == 0;
+    const bool wholeIndex = filter.matchesAll();
+
+    emptiedLevels_.clear();
+    for (auto& [price, level] : levels) {
+        // Best first, so nothing past the far end of the range can match
+        if (side == OrderSide::Buy ? price < filter.minPrice : price > filter.maxPrice) {
+            break;
+        }
+        if (!filter.matchesPrice(price)) {
+            continue;
+        }
+
+        for (auto it = level.begin(); it != level.end(); ) {
+            OrderPointer order = *it++;
+            if (!filter.matchesOwner(*order)) {
+                continue;
+            }
+            if (!wholeLevels) {
+                level.erase(order);
+            }
+            if (!wholeIndex) {
+                orders_.erase(order->getOrderId());
+            }
+            expiries_.cancel(order);
+            order->tryCancel(); // resting orders are never filled
+            cancelled.push_back(order);
+        }
+
+        if (wholeLevels || level.empty()) {
+            emptiedLevels_.push_back(price);
+        } else {
+            publishLevel(side, price, &level);
+        }
+    }
+
+    // One at a time, so the depth cache sees each level leave the side it mirrors
+    for (Price price : emptiedLevels_) {
+        levels.erase(price);
+        publishLevel(side, price, nullptr);
+    }
+}
+
+template <typename BuySide, typename SellSide>
+void BasicOrderBook<BuySide, SellSide>::fillOrder(OrderPointer order, OrderQueue& level, Quantity quantity) {
+    level.fill(order, quantity);
+    // removeOrder publishes the level once the order is gone, so only report partial fills here
+    if (order->getRemainingQuantity() > 0) {
+        if (order->getVisibleQuantity() == 0) {
+            level.replenish(order);
+        }
+        publishLevel(order->getOrderSide(), order->getPrice(), &level);
+    }
+}
+
+template <typename BuySide, typename SellSide>
+void BasicOrderBook<BuySide, SellSide>::decrementOrder(OrderPointer order, Quantity quantity) {
+    Price orderPrice = order->getPrice();
+    if (order->getOrderSide() == OrderSide::Buy) {
+        auto& ordersAtPriceLevel = buyOrders_[orderPrice];
+        ordersAtPriceLevel.decrement(order, quantity);
+        if (order->getVisibleQuantity() == 0) {
+            ordersAtPriceLevel.replenish(order);
+        }
+        publishLevel(OrderSide::Buy, orderPrice, &ordersAtPriceLevel);
+    } else {
+        auto& ordersAtPriceLevel = sellOrders_[orderPrice];
+        ordersAtPriceLevel.decrement(order, quantity);
+        if (order->getVisibleQuantity() == 0) {
+            ordersAtPriceLevel.replenish(order);
+        }
+        publishLevel(OrderSide::Sell, orderPrice, &ordersAtPriceLevel);
+    }
+}
+
+template <typename BuySide, typename SellSide>
+void BasicOrderBook<BuySide, SellSide>::reduceOrder(OrderPointer order, Quantity quantity) {
+    Price orderPrice = order->getPrice();
+    if (order->getOrderSide() == OrderSide::Buy) {
+        auto& ordersAtPriceLevel = buyOrders_[orderPrice];
+        ordersAtPriceLevel.resize(order, quantity);
+        publishLevel(OrderSide::Buy, orderPrice, &ordersAtPriceLevel);
+    } else {
+        auto& ordersAtPriceLevel = sellOrders_[orderPrice];
+        ordersAtPriceLevel.resize(order, quantity);
+        publishLevel(OrderSide::Sell, orderPrice, &ordersAtPriceLevel);
+    }
+}
+
+template <typename BuySide, typename SellSide>
+void BasicOrderBook<BuySide, SellSide>::moveOrder(OrderPointer order, Price price, Quantity quantity) {
+    if (order->getOrderSide() == OrderSide::Buy) {
+        moveWithinSide(buyOrders_, order, price, quantity);
+    } else {
+        moveWithinSide(sellOrders_, order, price, quantity);
+    }
 }
+
+// Relinks the order without touching the id index
+template <typename BuySide, typename SellSide>
+template <typename Levels>
+void BasicOrderBook<BuySide, SellSide>::moveWithinSide(Levels& levels, OrderPointer order, Price price, Quantity quantity) {
+    OrderSide side = order->getOrderSide();
+    Price oldPrice = order->getPrice();
+    auto& oldLevel = levels[oldPrice];
+    oldLevel.erase(order);
+    if (oldPrice != price) {
+        if (oldLevel.empty()) {
+            levels.erase(oldPrice);
+            publishLevel(side, oldPrice, nullptr);
+        } else {
+            publishLevel(side, oldPrice, &oldLevel);
+        }
+    }
+
+    order->setPrice(price);
+    order->setOpenQuantity(quantity);
+    auto& newLevel = levels[price];
+    newLevel.push_back(order);
+    publishLevel(side, price, &newLevel);
+}
+
+// level is nullptr once the price level has been erased
+template <typename BuySide, typename SellSide>
+void BasicOrderBook<BuySide, SellSide>::publishLevel(OrderSide side, Price price, const OrderQueue* level) {
+    DepthLevel depth { price, 0, 0 };
+    if (level != nullptr) {
+        depth.quantity = level->totalQuantity();
+        depth.orderCount = static_cast<std::uint32_t>(level->size());
+    }
+
+    if (side == OrderSide::Buy) {
+        buyDepth_.update(depth, buyOrders_);
+    } else {
+        sellDepth_.update(depth, sellOrders_);
+    }
+
+    if (depthListener_) {
+        depthListener_(DepthUpdate{ side, depth });
+    }
+}
+
+template class BasicOrderBook<std::map<Price, OrderQueue, std::greater<Price>>,
+                              std::map<Price, OrderQueue, std::less<Price>>>;
+template class BasicOrderBook<PriceLadder<std::greater<Price>>, PriceLadder<std::less<Price>>>;
+
 } // namespace ob
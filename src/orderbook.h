@@ -1,44 +1,148 @@
 #pragma once
 
 #include "trade.h"
+#include "expiry_wheel.h"
+#include "market_depth.h"
 #include "order.h"
+#include "order_queue.h"
+#include "price_ladder.h"
+#include "trigger_book.h"
+#include "utils/flat_hash_map.h"
+#include "utils/object_pool.h"
 
+#include <concepts>
 #include <functional>
 #include <vector>
 #include <map>
 #include <memory>
+#include <optional>
 #include <queue>
-#include <unordered_map>
+#include <span>
 
 namespace ob {
 
-using OrderPointers = std::vector<OrderPointer>;
+using OrderIndex = FlatHashMap<OrderId, OrderPointer, nullptr>;
 
-class OrderBook {
+// BuySide and SellSide hold the price levels of each side, keyed by price in priority order.
+// Any container with the std::map subset used here (operator[], erase, begin, end, empty) works.
+template <typename BuySide, typename SellSide>
+class BasicOrderBook {
 public:
+    using BuyLevels = BuySide;
+    using SellLevels = SellSide;
 
-    ~OrderBook() {
+    static constexpr std::size_t kDefaultCapacityHint = 1024;
+    static constexpr std::size_t kDefaultDepthLevels = 10;
+
+    // capacityHint is the number of resting orders the id index holds before it has to grow
+    explicit BasicOrderBook(std::size_t capacityHint = kDefaultCapacityHint)
+        requires std::default_initializable<BuySide> && std::default_initializable<SellSide>
+        : orders_ { capacityHint }
+    { }
+
+    explicit BasicOrderBook(PriceBand band, std::size_t capacityHint = kDefaultCapacityHint)
+        requires std::constructible_from<BuySide, PriceBand>
+        : buyOrders_ { band }
+        , sellOrders_ { band }
+        , orders_ { capacityHint }
+    { }
+
+    ~BasicOrderBook() {
         clear();
     }
 
     void addOrder(OrderPointer order);
+    void addOrder(OrderHandle handle) { addOrder(ObjectPool::resolve(handle)); }
     void removeOrder(OrderId orderId);
+    // Also cancels a dormant stop with this id
     void cancelOrder(OrderId orderId);
-    
-    std::map<Price, OrderPointers, std::greater<Price>>& getBuyOrders() { return buyOrders_; }
-    std::map<Price, OrderPointers, std::less<Price>>& getSellOrders() { return sellOrders_; }
-    std::unordered_map<OrderId, OrderPointer>& getOrders() { return orders_; }
+    // Fills a resting order in place; a fully filled order stays queued until removeOrder. An
+    // iceberg whose slice runs out shows its next slice from the back of the level, keeping its
+    // slot in the id index.
+    void fillOrder(OrderPointer order, OrderQueue& level, Quantity quantity);
+    // Takes quantity, at most what the order shows and less than it has open, off a resting
+    // order without a trade (self-trade prevention's Decrement). Like a fill, an iceberg whose
+    // slice runs out shows its next slice from the back of the level.
+    void decrementOrder(OrderPointer order, Quantity quantity);
+
+    // Amends of a resting order. reduceOrder changes its open quantity and keeps its place in the
+    // queue; moveOrder sends it to the back of the queue at price; takeOrder unlinks it from the
+    // book and hands it back instead of releasing it (nullptr if the id is not resting).
+    void reduceOrder(OrderPointer order, Quantity quantity);
+    void moveOrder(OrderPointer order, Price price, Quantity quantity);
+    OrderPointer takeOrder(OrderId orderId);
+
+    // Cancels every resting order and dormant stop that matches filter and appends it to
+    // cancelled instead of releasing it; returns how many that was. A level the filter takes
+    // whole is dropped in one step rather than order by order.
+    std::size_t cancelOrders(const MassCancelFilter& filter, OrderPointers& cancelled);
+
+    // Whether an order at this price can rest in the book (always true for map-backed sides)
+    bool isValidPrice(Price price) const {
+        if constexpr (requires { buyOrders_.isValidPrice(price); }) {
+            return buyOrders_.isValidPrice(price);
+        } else {
+            return true;
+        }
+    }
+    // The band isValidPrice checks against, none for map-backed sides
+    std::optional<PriceBand> getPriceBand() const {
+        if constexpr (requires { buyOrders_.getPriceBand(); }) {
+            return buyOrders_.getPriceBand();
+        } else {
+            return std::nullopt;
+        }
+    }
+
+    // Top levels of each side, best first, kept up to date as orders are added, filled and removed
+    std::span<const DepthLevel> getBuyDepth() const { return buyDepth_.levels(); }
+    std::span<const DepthLevel> getSellDepth() const { return sellDepth_.levels(); }
+    void setDepthLevels(std::size_t maxLevels) {
+        buyDepth_.rebuild(buyOrders_, maxLevels);
+        sellDepth_.rebuild(sellOrders_, maxLevels);
+    }
+
+    // Called with every level change, so a consumer can mirror the full book without rescanning it
+    void setDepthListener(DepthListener listener) { depthListener_ = std::move(listener); }
+
+    BuySide& getBuyOrders() { return buyOrders_; }
+    SellSide& getSellOrders() { return sellOrders_; }
+    OrderIndex& getOrders() { return orders_; }
+    // Stop and stop-limit orders waiting for their stop price; the engine triggers them
+    TriggerBook& getStops() { return stops_; }
+    // Resting GoodTillDate and Day orders by expire time; the engine expires them as time passes
+    ExpiryWheel& getExpiries() { return expiries_; }
 
 private:
-    std::map<Price, OrderPointers, std::greater<Price>> buyOrders_; // highest price first
-    std::map<Price, OrderPointers, std::less<Price>> sellOrders_;   // lowest price first
-    std::unordered_map<OrderId, OrderPointer> orders_;
+    BuySide buyOrders_;     // highest price first
+    SellSide sellOrders_;   // lowest price first
+    OrderIndex orders_;
+    TriggerBook stops_;
+    ExpiryWheel expiries_;
+    DepthCache buyDepth_ { OrderSide::Buy, kDefaultDepthLevels };
+    DepthCache sellDepth_ { OrderSide::Sell, kDefaultDepthLevels };
+    DepthListener depthListener_;
+    std::vector<Price> emptiedLevels_;  // scratch for cancelLevels
+
+    void publishLevel(OrderSide side, Price price, const OrderQueue* level);
+
+    template <typename Levels>
+    void moveWithinSide(Levels& levels, OrderPointer order, Price price, Quantity quantity);
+    template <typename Levels>
+    void cancelLevels(Levels& levels, OrderSide side, const MassCancelFilter& filter, OrderPointers& cancelled);
 
     // for google benchmark
     void clear() {
         for (auto it : orders_) {
-            delete it.second;
+            ObjectPool::release(it.second);
         }
     }
 };
+
+using OrderBook = BasicOrderBook<std::map<Price, OrderQueue, std::greater<Price>>,
+                                 std::map<Price, OrderQueue, std::less<Price>>>;
+
+// Array-backed book for instruments that trade inside a known PriceBand
+using LadderOrderBook = BasicOrderBook<PriceLadder<std::greater<Price>>, PriceLadder<std::less<Price>>>;
+
 } // namespace ob
@@ -0,0 +1,232 @@
+#pragma once
+
+#include "order.h"
+#include "order_queue.h"
+#include "utils/engine_memory.h"
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace ob {
+
+// Range of prices an instrument can trade at: [minPrice, maxPrice] in steps of tickSize.
+struct PriceBand {
+    Price minPrice;
+    Price maxPrice;
+    Price tickSize;
+
+    bool contains(Price price) const {
+        return price >= minPrice && price <= maxPrice && (price - minPrice) % tickSize == 0;
+    }
+};
+
+// One side of the book stored as a contiguous array with one slot per tick in the band.
+// Mirrors the subset of the std::map interface used by OrderBook and MatchingEngine, so a
+// price resolves to its level with a subtraction and a division instead of a tree walk.
+// Compare gives the priority order, e.g. std::greater<Price> for bids (best = highest).
+template <typename Compare>
+class PriceLadder {
+public:
+    using key_type = Price;
+    using mapped_type = OrderQueue;
+    using value_type = std::pair<const Price, OrderQueue>;
+
+private:
+    static constexpr bool kDescending = Compare{}(Price{1}, Price{0});
+    static constexpr std::size_t kNoLevel = static_cast<std::size_t>(-1);
+    static constexpr std::size_t kWordBits = 64;
+
+    template <bool IsConst>
+    class Iterator {
+        using Ladder = std::conditional_t<IsConst, const PriceLadder, PriceLadder>;
+        using Value = std::conditional_t<IsConst, const std::pair<const Price, OrderQueue>, std::pair<const Price, OrderQueue>>;
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::pair<const Price, OrderQueue>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Value*;
+        using reference = Value&;
+
+        Iterator() = default;
+        Iterator(Ladder* ladder, std::size_t index) : ladder_ { ladder }, index_ { index } { }
+
+        Value& operator*() const { return ladder_->levels_[index_]; }
+        Value* operator->() const { return &ladder_->levels_[index_]; }
+
+        Iterator& operator++() {
+            index_ = ladder_->nextActive(index_);
+            return *this;
+        }
+
+        bool operator==(const Iterator& other) const { return index_ == other.index_; }
+
+    private:
+        Ladder* ladder_ = nullptr;
+        std::size_t index_ = 0;
+    };
+
+public:
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    explicit PriceLadder(PriceBand band)
+        : band_ { band }
+    {
+        if (band.tickSize == 0 || band.maxPrice < band.minPrice) {
+            throw std::invalid_argument(
+                std::format("Invalid price band [{}, {}] with tick size {}", band.minPrice, band.maxPrice, band.tickSize));
+        }
+
+        std::size_t numLevels = (band.maxPrice - band.minPrice) / band.tickSize + 1;
+        levels_.reserve(numLevels);
+        for (std::size_t i = 0; i < numLevels; ++i) {
+            levels_.emplace_back(static_cast<Price>(band.minPrice + i * band.tickSize), OrderQueue{});
+        }
+        activeLevels_.assign((numLevels + kWordBits - 1) / kWordBits, 0);
+        activeWords_.assign((activeLevels_.size() + kWordBits - 1) / kWordBits, 0);
+    }
+
+    // Like std::map::operator[], makes the level part of the book if it is not already.
+    OrderQueue& operator[](Price price) {
+        std::size_t index = indexOf(price);
+        if (!isActive(index)) {
+            activate(index);
+        }
+        return levels_[index].second;
+    }
+
+    void erase(Price price) {
+        std::size_t index = indexOf(price);
+        if (!isActive(index)) {
+            return;
+        }
+        levels_[index].second.clear(); // keep capacity for the next time this level fills
+        std::size_t word = index / kWordBits;
+        activeLevels_[word] &= ~(std::uint64_t{1} << (index % kWordBits));
+        if (activeLevels_[word] == 0) {
+            activeWords_[word / kWordBits] &= ~(std::uint64_t{1} << (word % kWordBits));
+        }
+        --size_;
+        if (index == best_) {
+            best_ = size_ == 0 ? kNoLevel : nextActive(index);
+        }
+    }
+
+    iterator begin() { return { this, best_ }; }
+    iterator end() { return { this, kNoLevel }; }
+    const_iterator begin() const { return { this, best_ }; }
+    const_iterator end() const { return { this, kNoLevel }; }
+
+    bool empty() const { return size_ == 0; }
+    std::size_t size() const { return size_; }
+
+    bool isValidPrice(Price price) const { return band_.contains(price); }
+
+    const PriceBand& getPriceBand() const { return band_; }
+
+private:
+    PriceBand band_;
+    std::vector<value_type, EngineAllocator<value_type>> levels_;             // one slot per tick, index 0 is minPrice
+    std::vector<std::uint64_t, EngineAllocator<std::uint64_t>> activeLevels_; // bit i set when levels_[i] is in the book
+    std::vector<std::uint64_t, EngineAllocator<std::uint64_t>> activeWords_;  // bit w set when activeLevels_[w] is non-zero
+    std::size_t best_ = kNoLevel;
+    std::size_t size_ = 0;
+
+    std::size_t indexOf(Price price) const {
+        if (!isValidPrice(price)) {
+            throw std::out_of_range(
+                std::format("Price {} is outside the band [{}, {}] or not a multiple of tick size {}",
+                            price, band_.minPrice, band_.maxPrice, band_.tickSize));
+        }
+        return (price - band_.minPrice) / band_.tickSize;
+    }
+
+    bool isActive(std::size_t index) const {
+        return (activeLevels_[index / kWordBits] >> (index % kWordBits)) & 1;
+    }
+
+    void activate(std::size_t index) {
+        std::size_t word = index / kWordBits;
+        activeLevels_[word] |= std::uint64_t{1} << (index % kWordBits);
+        activeWords_[word / kWordBits] |= std::uint64_t{1} << (word % kWordBits);
+        ++size_;
+        if (best_ == kNoLevel || (kDescending ? index > best_ : index < best_)) {
+            best_ = index;
+        }
+    }
+
+    // Next active level after index in priority order. The per-word summary bitmap lets this skip
+    // 4096 empty ticks per word it reads, so sparse books do not pay for the width of the band.
+    std::size_t nextActive(std::size_t index) const {
+        if constexpr (kDescending) {
+            if (index == 0) {
+                return kNoLevel;
+            }
+            std::size_t from = index - 1;
+            std::size_t word = from / kWordBits;
+            std::uint64_t bits = activeLevels_[word] & (~std::uint64_t{0} >> (kWordBits - 1 - from % kWordBits));
+            if (bits != 0) {
+                return word * kWordBits + (kWordBits - 1 - std::countl_zero(bits));
+            }
+            if (word == 0) {
+                return kNoLevel;
+            }
+            std::size_t prevWord = highestSetBit(activeWords_, word - 1);
+            return prevWord == kNoLevel
+                ? kNoLevel
+                : prevWord * kWordBits + (kWordBits - 1 - std::countl_zero(activeLevels_[prevWord]));
+        } else {
+            std::size_t from = index + 1;
+            std::size_t word = from / kWordBits;
+            if (word < activeLevels_.size()) {
+                std::uint64_t bits = activeLevels_[word] & (~std::uint64_t{0} << (from % kWordBits));
+                if (bits != 0) {
+                    return word * kWordBits + std::countr_zero(bits);
+                }
+            }
+            std::size_t nextWord = lowestSetBit(activeWords_, word + 1);
+            return nextWord == kNoLevel
+                ? kNoLevel
+                : nextWord * kWordBits + std::countr_zero(activeLevels_[nextWord]);
+        }
+    }
+
+    // Lowest set bit at or above from
+    static std::size_t lowestSetBit(const std::vector<std::uint64_t, EngineAllocator<std::uint64_t>>& words, std::size_t from) {
+        std::size_t word = from / kWordBits;
+        if (word >= words.size()) {
+            return kNoLevel;
+        }
+        std::uint64_t bits = words[word] & (~std::uint64_t{0} << (from % kWordBits));
+        while (bits == 0) {
+            if (++word == words.size()) {
+                return kNoLevel;
+            }
+            bits = words[word];
+        }
+        return word * kWordBits + std::countr_zero(bits);
+    }
+
+    // Highest set bit at or below from
+    static std::size_t highestSetBit(const std::vector<std::uint64_t, EngineAllocator<std::uint64_t>>& words, std::size_t from) {
+        std::size_t word = from / kWordBits;
+        std::uint64_t bits = words[word] & (~std::uint64_t{0} >> (kWordBits - 1 - from % kWordBits));
+        while (bits == 0) {
+            if (word == 0) {
+                return kNoLevel;
+            }
+            bits = words[--word];
+        }
+        return word * kWordBits + (kWordBits - 1 - std::countl_zero(bits));
+    }
+};
+
+} // namespace ob
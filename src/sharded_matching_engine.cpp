@@ -0,0 +1,276 @@
+#include "sharded_matching_engine.h"
+
+#include "utils/object_pool.h"
+
+#include <format>
+#include <stdexcept>
+
+namespace ob {
+
+template <typename Book, typename History>
+ShardedMatchingEngine<Book, History>::ShardedMatchingEngine(ShardedEngineConfig config)
+    : config_ { config }
+{
+    if (config_.numShards == 0) {
+        throw std::invalid_argument("ShardedMatchingEngine needs at least one shard");
+    }
+
+    shards_.reserve(config_.numShards);
+    for (std::size_t i = 0; i < config_.numShards; ++i) {
+        shards_.push_back(std::make_unique<Shard>(config_.queueCapacity));
+    }
+}
+
+template <typename Book, typename History>
+ShardedMatchingEngine<Book, History>::~ShardedMatchingEngine() {
+    stop();
+}
+
+template <typename Book, typename History>
+void ShardedMatchingEngine<Book, History>::addInstrument(SymbolId symbol, std::unique_ptr<Book> book, std::unique_ptr<History> history) {
+    if (started_) {
+        throw std::logic_error(std::format("Instrument ({}) added after the engine was started", symbol));
+    }
+    if (hasInstrument(symbol)) {
+        throw std::logic_error(std::format("Instrument ({}) is already registered", symbol));
+    }
+
+    Shard& shard = *shards_[shardOf(symbol)];
+    std::size_t slot = symbol / shards_.size();
+    if (slot >= shard.instruments.size()) {
+        shard.instruments.resize(slot + 1);
+    }
+
+    auto instrument = std::make_unique<Instrument>();
+    instrument->book = std::move(book);
+    instrument->history = std::move(history);
+    instrument->engine.emplace(*instrument->book, *instrument->history);
+    shard.instruments[slot] = std::move(instrument);
+}
+
+template <typename Book, typename History>
+void ShardedMatchingEngine<Book, History>::start() {
+    if (started_) {
+        throw std::logic_error("ShardedMatchingEngine can only be started once");
+    }
+    started_ = true;
+    running_.store(true, std::memory_order_release);
+
+    for (std::size_t i = 0; i < shards_.size(); ++i) {
+        shards_[i]->worker = std::thread([this, i] { run(i); });
+    }
+}
+
+template <typename Book, typename History>
+void ShardedMatchingEngine<Book, History>::stop() {
+    running_.store(false, std::memory_order_release);
+    for (auto& shard : shards_) {
+        if (shard->worker.joinable()) {
+            shard->worker.join();
+        }
+    }
+}
+
+template <typename Book, typename History>
+void ShardedMatchingEngine<Book, History>::onNewOrder(const OrderRequest& request) {
+    push(*shards_[shardOf(request.symbol)], Message{ Message::Kind::NewOrder, request });
+}
+
+template <typename Book, typename History>
+void ShardedMatchingEngine<Book, History>::onCancelOrder(SymbolId symbol, OrderId orderId) {
+    OrderRequest request {};
+    request.orderId = orderId;
+    request.symbol = symbol;
+    push(*shards_[shardOf(symbol)], Message{ Message::Kind::CancelOrder, request });
+}
+
+template <typename Book, typename History>
+void ShardedMatchingEngine<Book, History>::onAmendOrder(SymbolId symbol, OrderId orderId, Price price, Quantity quantity) {
+    OrderRequest request {};
+    request.orderId = orderId;
+    request.symbol = symbol;
+    request.price = price;
+    request.quantity = quantity;
+    push(*shards_[shardOf(symbol)], Message{ Message::Kind::AmendOrder, request });
+}
+
+template <typename Book, typename History>
+void ShardedMatchingEngine<Book, History>::onMassCancel(SymbolId symbol, const MassCancelFilter& filter) {
+    OrderRequest request {};
+    request.symbol = symbol;
+    push(*shards_[shardOf(symbol)], Message{ Message::Kind::MassCancel, request, filter });
+}
+
+template <typename Book, typename History>
+void ShardedMatchingEngine<Book, History>::onMassCancel(const MassCancelFilter& filter) {
+    for (auto& shard : shards_) {
+        push(*shard, Message{ Message::Kind::MassCancelAll, OrderRequest{}, filter });
+    }
+}
+
+template <typename Book, typename History>
+void ShardedMatchingEngine<Book, History>::advanceTime(Timestamp now) {
+    OrderRequest request {};
+    request.expireTime = now;
+    for (auto& shard : shards_) {
+        push(*shard, Message{ Message::Kind::AdvanceTime, request });
+    }
+}
+
+template <typename Book, typename History>
+void ShardedMatchingEngine<Book, History>::setSessionEnd(Timestamp time) {
+    OrderRequest request {};
+    request.expireTime = time;
+    for (auto& shard : shards_) {
+        push(*shard, Message{ Message::Kind::SessionEnd, request });
+    }
+}
+
+template <typename Book, typename History>
+bool ShardedMatchingEngine<Book, History>::isValidPrice(SymbolId symbol, Price price) const {
+    // Price bands are fixed when a book is built, so this is safe to call while the shard runs
+    Instrument* instrument = findInstrument(symbol);
+    return instrument != nullptr && instrument->book && instrument->book->isValidPrice(price);
+}
+
+template <typename Book, typename History>
+void ShardedMatchingEngine<Book, History>::waitUntilIdle() const {
+    for (const auto& shard : shards_) {
+        unsigned idleSpins = 0;
+        while (shard->processed.load(std::memory_order_acquire) != shard->submitted) {
+            backoff(idleSpins);
+        }
+    }
+}
+
+template <typename Book, typename History>
+Book& ShardedMatchingEngine<Book, History>::getBook(SymbolId symbol) {
+    Instrument* instrument = findInstrument(symbol);
+    if (instrument == nullptr || !instrument->book) {
+        throw std::logic_error(std::format("Instrument ({}) has no book", symbol));
+    }
+    return *instrument->book;
+}
+
+template <typename Book, typename History>
+History& ShardedMatchingEngine<Book, History>::getHistory(SymbolId symbol) {
+    Instrument* instrument = findInstrument(symbol);
+    if (instrument == nullptr) {
+        throw std::logic_error(std::format("Instrument ({}) is not registered", symbol));
+    }
+    return *instrument->history;
+}
+
+template <typename Book, typename History>
+typename ShardedMatchingEngine<Book, History>::Instrument*
+ShardedMatchingEngine<Book, History>::findInstrument(SymbolId symbol) const {
+    const Shard& shard = *shards_[shardOf(symbol)];
+    std::size_t slot = symbol / shards_.size();
+    return slot < shard.instruments.size() ? shard.instruments[slot].get() : nullptr;
+}
+
+template <typename Book, typename History>
+void ShardedMatchingEngine<Book, History>::push(Shard& shard, const Message& message) {
+    // Back-pressure: wait for the worker rather than drop the message
+    unsigned idleSpins = 0;
+    while (!shard.queue.tryPush(message)) {
+        backoff(idleSpins);
+    }
+    ++shard.submitted;
+}
+
+template <typename Book, typename History>
+void ShardedMatchingEngine<Book, History>::run(std::size_t shardIndex) {
+    Shard& shard = *shards_[shardIndex];
+    if (config_.pinThreads) {
+        pinCurrentThread(config_.firstCpu + static_cast<unsigned>(shardIndex));
+    }
+
+    Message message;
+    unsigned idleSpins = 0;
+    while (true) {
+        if (shard.queue.tryPop(message)) {
+            process(shard, message);
+            idleSpins = 0;
+        } else if (running_.load(std::memory_order_acquire)) {
+            backoff(idleSpins);
+        } else {
+            break;
+        }
+    }
+
+    // Final drain, then free the resting orders while this thread's pool still exists
+    while (shard.queue.tryPop(message)) {
+        process(shard, message);
+    }
+    for (auto& instrument : shard.instruments) {
+        if (instrument) {
+            instrument->engine.reset();
+            instrument->book.reset();
+        }
+    }
+}
+
+template <typename Book, typename History>
+void ShardedMatchingEngine<Book, History>::process(Shard& shard, const Message& message) {
+    try {
+        if (message.kind >= Message::Kind::MassCancelAll) {
+            for (auto& instrument : shard.instruments) {
+                if (instrument) {
+                    apply(*instrument, message);
+                }
+            }
+        } else {
+            apply(*shard.instruments[message.request.symbol / shards_.size()], message);
+        }
+    } catch (std::exception& e) {
+        // the gateway already validated the request, so there is nobody left to report to
+    }
+
+    shard.processed.fetch_add(1, std::memory_order_release);
+}
+
+template <typename Book, typename History>
+void ShardedMatchingEngine<Book, History>::apply(Instrument& instrument, const Message& message) {
+    const OrderRequest& request = message.request;
+    switch (message.kind) {
+        case Message::Kind::NewOrder: {
+            OrderPointer order = ObjectPool::allocate(request.orderId, request.orderType, request.orderSide,
+                                                      request.timeInForce, request.price, request.quantity);
+            order->setSymbol(request.symbol);
+            order->setStopPrice(request.stopPrice);
+            order->setDisplayQuantity(request.displayQuantity);
+            order->setParticipant(request.participant);
+            order->setExpireTime(request.expireTime);
+            if (instrument.engine->onNewOrder(order) != OrderError::None) {
+                ObjectPool::release(order);
+            }
+            break;
+        }
+        case Message::Kind::CancelOrder:
+            instrument.engine->onCancelOrder(request.orderId);
+            break;
+        case Message::Kind::AmendOrder:
+            instrument.engine->onAmendOrder(request.orderId, request.price, request.quantity);
+            break;
+        case Message::Kind::MassCancel:
+        case Message::Kind::MassCancelAll:
+            instrument.engine->onMassCancel(message.filter);
+            break;
+        case Message::Kind::AdvanceTime:
+            instrument.engine->advanceTime(request.expireTime);
+            break;
+        case Message::Kind::SessionEnd:
+            instrument.engine->setSessionEnd(request.expireTime);
+            break;
+    }
+}
+
+template class ShardedMatchingEngine<OrderBook, TradeHistory>;
+template class ShardedMatchingEngine<LadderOrderBook, TradeHistory>;
+template class ShardedMatchingEngine<OrderBook, RingTradeHistory>;
+template class ShardedMatchingEngine<LadderOrderBook, RingTradeHistory>;
+template class ShardedMatchingEngine<OrderBook, RingExecutionSink>;
+template class ShardedMatchingEngine<LadderOrderBook, RingExecutionSink>;
+
+} // namespace ob
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "matching_engine.h"
+#include "order.h"
+#include "order_events.h"
+#include "order_gateway.h"
+#include "orderbook.h"
+#include "tradehistory.h"
+#include "utils/spsc_queue.h"
+#include "utils/thread_utils.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace ob {
+
+struct ShardedEngineConfig {
+    std::size_t numShards = 1;
+    std::size_t queueCapacity = 1 << 16;   // messages buffered per shard before the producer waits
+    bool pinThreads = true;                // pin shard i to CPU firstCpu + i
+    unsigned firstCpu = 0;
+};
+
+// Owns the books of many instruments and spreads them over shards, each served by its own
+// worker thread. Symbol s belongs to shard s % numShards and is only ever touched by that
+// shard's worker, so books need no locking and shards never share a cache line.
+//
+// A single thread (typically the one driving an OrderGateway) submits orders and cancels;
+// workers allocate Orders from their own thread's ObjectPool. Instruments are added before
+// start(). stop() drains every queue and destroys the books on their worker threads; the
+// trade histories stay readable afterwards.
+template <typename Book = OrderBook, typename History = RingTradeHistory>
+class ShardedMatchingEngine {
+public:
+    explicit ShardedMatchingEngine(ShardedEngineConfig config);
+    ~ShardedMatchingEngine();
+
+    ShardedMatchingEngine(const ShardedMatchingEngine&) = delete;
+    ShardedMatchingEngine& operator=(const ShardedMatchingEngine&) = delete;
+
+    void addInstrument(SymbolId symbol, std::unique_ptr<Book> book, std::unique_ptr<History> history);
+
+    void start();
+    void stop();
+
+    // Producer side: queue the request for the shard that owns its symbol
+    void onNewOrder(const OrderRequest& request);
+    void onCancelOrder(SymbolId symbol, OrderId orderId);
+    void onAmendOrder(SymbolId symbol, OrderId orderId, Price price, Quantity quantity);
+    void onMassCancel(SymbolId symbol, const MassCancelFilter& filter);
+    // Go to every shard and apply to each of its instruments, see MatchingEngine. How many orders
+    // a mass cancel took is not reported back; each one gets its Cancelled report as usual.
+    void onMassCancel(const MassCancelFilter& filter);
+    void advanceTime(Timestamp now);
+    void setSessionEnd(Timestamp time);
+
+    bool hasInstrument(SymbolId symbol) const { return findInstrument(symbol) != nullptr; }
+    bool isValidPrice(SymbolId symbol, Price price) const;
+
+    // Blocks until every shard has processed everything submitted so far
+    void waitUntilIdle() const;
+
+    std::size_t numShards() const { return shards_.size(); }
+    std::size_t shardOf(SymbolId symbol) const { return symbol % shards_.size(); }
+
+    // Only safe to read while the shard is idle, and the book only until stop()
+    Book& getBook(SymbolId symbol);
+    History& getHistory(SymbolId symbol);
+
+private:
+    struct Message {
+        // The kinds from MassCancelAll on go to every instrument of the shard
+        enum class Kind : std::uint8_t { NewOrder, CancelOrder, AmendOrder, MassCancel, MassCancelAll, AdvanceTime, SessionEnd };
+
+        Kind kind;
+        OrderRequest request;       // orderId and symbol for a cancel, plus price and quantity for an
+                                    // amend; only symbol for a mass cancel, only expireTime for the clock
+        MassCancelFilter filter {}; // mass cancels only
+    };
+
+    struct Instrument {
+        std::unique_ptr<Book> book;
+        std::unique_ptr<History> history;
+        std::optional<BasicMatchingEngine<Book, History>> engine;
+    };
+
+    struct alignas(kCacheLineSize) Shard {
+        explicit Shard(std::size_t queueCapacity) : queue { queueCapacity } { }
+
+        SpscQueue<Message> queue;
+        std::vector<std::unique_ptr<Instrument>> instruments;   // indexed by symbol / numShards
+        std::thread worker;
+        std::uint64_t submitted = 0;                            // written by the producer only
+        alignas(kCacheLineSize) std::atomic<std::uint64_t> processed { 0 };
+    };
+
+    ShardedEngineConfig config_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::atomic<bool> running_ { false };
+    bool started_ = false;
+
+    Instrument* findInstrument(SymbolId symbol) const;
+    void push(Shard& shard, const Message& message);
+    void run(std::size_t shardIndex);
+    void process(Shard& shard, const Message& message);
+    void apply(Instrument& instrument, const Message& message);
+};
+
+// Validates on the caller's thread and routes by symbol; only the overloads that take a symbol apply
+using ShardedOrderGateway = BasicOrderGateway<ShardedMatchingEngine<>>;
+
+} // namespace ob
@@ -0,0 +1,126 @@
+#include "snapshot.h"
+
+#include "orderbook.h"
+#include "utils/mapped_file.h"
+#include "utils/object_pool.h"
+
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <stdexcept>
+
+namespace ob {
+
+namespace {
+
+template <typename Levels>
+SnapshotOrder* writeSide(const Levels& levels, SnapshotOrder* out) {
+    for (const auto& [price, orders] : levels) {
+        for (OrderPointer order : orders) {
+            *out++ = { order->getOrderId(), order->getPrice(), order->getInitialQuantity(), order->getRemainingQuantity(),
+                       order->getSymbol(),
+                       static_cast<std::uint8_t>(order->getOrderType()),
+                       static_cast<std::uint8_t>(order->getOrderSide()),
+                       static_cast<std::uint8_t>(order->getTimeInForce()),
+                       static_cast<std::uint8_t>(order->getOrderStatus()),
+                       order->getStopPrice(),
+                       order->getDisplayQuantity(),
+                       order->getDisplayedQuantity(),
+                       order->getParticipant(), 0,
+                       order->getExpireTime() };
+        }
+    }
+    return out;
+}
+
+} // namespace
+
+template <typename Book>
+void writeSnapshot(Book& book, const std::string& path, std::uint64_t journalSequence, Timestamp sessionEnd) {
+    std::uint64_t orderCount = book.getOrders().size() + book.getStops().size();
+    std::string tempPath = path + ".tmp";
+    {
+        MappedFile file(tempPath, sizeof(SnapshotHeader) + orderCount * sizeof(SnapshotOrder));
+        auto bytes = file.writableData();
+
+        SnapshotHeader header {};
+        std::memcpy(header.magic, kSnapshotMagic, sizeof(header.magic));
+        header.journalSequence = journalSequence;
+        header.orderCount = orderCount;
+        header.lastTradePrice = book.getStops().getLastTradePrice();
+        header.time = book.getExpiries().now();
+        header.sessionEnd = sessionEnd;
+        std::memcpy(bytes.data(), &header, sizeof(header));
+
+        auto* records = reinterpret_cast<SnapshotOrder*>(bytes.data() + sizeof(SnapshotHeader));
+        SnapshotOrder* end = writeSide(book.getBuyOrders(), records);
+        end = writeSide(book.getSellOrders(), end);
+        end = writeSide(book.getStops().getBuyStops(), end);
+        end = writeSide(book.getStops().getSellStops(), end);
+        if (static_cast<std::uint64_t>(end - records) != orderCount) {
+            throw std::logic_error(
+                std::format("Book indexes hold {} orders but its levels hold {}", orderCount, end - records));
+        }
+        file.sync();
+    }
+    std::filesystem::rename(tempPath, path);
+}
+
+template <typename Book>
+SnapshotInfo loadSnapshot(Book& book, const std::string& path) {
+    if (!book.getOrders().empty() || !book.getStops().empty()) {
+        throw std::logic_error(std::format("Snapshot ({}) can only be loaded into an empty book", path));
+    }
+
+    MappedFile file(path);
+    auto bytes = file.data();
+    SnapshotHeader header;
+    if (bytes.size() < sizeof(header)) {
+        throw std::runtime_error(std::format("Snapshot ({}) is truncated", path));
+    }
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    if (std::memcmp(header.magic, kSnapshotMagic, sizeof(header.magic)) != 0
+        || bytes.size() != sizeof(header) + header.orderCount * sizeof(SnapshotOrder)) {
+        throw std::runtime_error(std::format("Snapshot ({}) is not a valid snapshot", path));
+    }
+
+    // Size the pool and the id index once instead of growing them order by order
+    ObjectPool::arena().reserve(static_cast<std::uint32_t>(ObjectPool::arena().liveCount() + header.orderCount));
+    book.getOrders().reserve(header.orderCount);
+
+    // Orders are scheduled to expire against the restored clock
+    book.getExpiries().start(header.time);
+
+    const auto* records = reinterpret_cast<const SnapshotOrder*>(bytes.data() + sizeof(SnapshotHeader));
+    for (std::uint64_t i = 0; i < header.orderCount; ++i) {
+        const SnapshotOrder& record = records[i];
+        OrderPointer order = ObjectPool::allocate(record.orderId,
+                                                  static_cast<OrderType>(record.orderType),
+                                                  static_cast<OrderSide>(record.orderSide),
+                                                  static_cast<TimeInForce>(record.timeInForce),
+                                                  record.price, record.initialQuantity);
+        order->setRemainingQuantity(record.remainingQuantity);
+        order->setOrderStatus(static_cast<OrderStatus>(record.orderStatus));
+        order->setSymbol(record.symbol);
+        order->setStopPrice(record.stopPrice);
+        order->setDisplayQuantity(record.displayQuantity);
+        order->setDisplayedQuantity(record.displayedQuantity);
+        order->setParticipant(record.participant);
+        order->setExpireTime(record.expireTime);
+        if (isStopOrder(order->getOrderType())) {
+            book.getStops().add(order);
+        } else {
+            book.addOrder(order);
+        }
+    }
+    book.getStops().setLastTradePrice(static_cast<Price>(header.lastTradePrice));
+
+    return { header.journalSequence, header.orderCount, header.time, header.sessionEnd };
+}
+
+template void writeSnapshot(OrderBook&, const std::string&, std::uint64_t, Timestamp);
+template void writeSnapshot(LadderOrderBook&, const std::string&, std::uint64_t, Timestamp);
+template SnapshotInfo loadSnapshot(OrderBook&, const std::string&);
+template SnapshotInfo loadSnapshot(LadderOrderBook&, const std::string&);
+
+} // namespace ob
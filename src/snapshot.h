@@ -0,0 +1,66 @@
+#pragma once
+
+#include "order.h"
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+namespace ob {
+
+// A resting order as stored in a snapshot. The file is a SnapshotHeader followed by one of
+// these per resting order: the buy side best level first, then the sell side, and within a
+// level in time priority; dormant stops follow in the order they would trigger. Loading walks the mapped records directly, nothing is decoded.
+struct SnapshotOrder {
+    OrderId orderId;
+    Price price;
+    Quantity initialQuantity;
+    Quantity remainingQuantity;
+    SymbolId symbol;
+    std::uint8_t orderType;
+    std::uint8_t orderSide;
+    std::uint8_t timeInForce;
+    std::uint8_t orderStatus;
+    Price stopPrice;
+    Quantity displayQuantity;       // icebergs: slice size and what is left of the current slice
+    Quantity displayedQuantity;
+    ParticipantId participant;
+    std::uint32_t reserved;
+    Timestamp expireTime;           // GoodTillDate and Day only
+};
+
+struct SnapshotHeader {
+    char magic[8];
+    std::uint64_t journalSequence;  // last journal record reflected in the snapshot
+    std::uint64_t orderCount;       // resting orders and dormant stops
+    std::uint64_t lastTradePrice;   // what the book's stops are measured against
+    Timestamp time;                 // the engine clock GoodTillDate orders expire by
+    Timestamp sessionEnd;           // the expire time new Day orders take
+};
+
+static_assert(sizeof(SnapshotOrder) == 56 && std::is_trivially_copyable_v<SnapshotOrder>);
+static_assert(sizeof(SnapshotHeader) == 48 && std::is_trivially_copyable_v<SnapshotHeader>);
+
+inline constexpr char kSnapshotMagic[8] = { 'O', 'B', 'S', 'N', 'A', 'P', '0', '5' };
+
+struct SnapshotInfo {
+    std::uint64_t journalSequence;
+    std::uint64_t orderCount;
+    Timestamp time;
+    Timestamp sessionEnd;
+};
+
+// Writes every resting order of the book to path, along with its clock. The snapshot is written
+// to a temporary file and renamed into place, so a crash mid-write leaves the previous snapshot
+// intact. journalSequence is the last journal record the book reflects
+// (JournalWriter::lastSequence) and sessionEnd the engine's (BasicMatchingEngine::getSessionEnd).
+template <typename Book>
+void writeSnapshot(Book& book, const std::string& path, std::uint64_t journalSequence, Timestamp sessionEnd);
+
+// Loads a snapshot into an empty book, allocating its orders from the calling thread's
+// ObjectPool; the book's clock is restored with it. To catch up, set the engine's session end to
+// info.sessionEnd, skip the journal to info.journalSequence and replay the rest.
+template <typename Book>
+SnapshotInfo loadSnapshot(Book& book, const std::string& path);
+
+} // namespace ob
@@ -21,8 +21,8 @@ struct Trade {
     OrderType sellOrderType_;
     TimeInForce sellOrderTIF_;
 
-    static Trade* createTrade(const OrderPointer buyOrder, const OrderPointer sellOrder, Price tradePrice, Quantity tradeQty) {
-        return new Trade{buyOrder->getOrderId(), sellOrder->getOrderId(), tradePrice, tradeQty,
+    static Trade createTrade(const OrderPointer buyOrder, const OrderPointer sellOrder, Price tradePrice, Quantity tradeQty) {
+        return Trade{buyOrder->getOrderId(), sellOrder->getOrderId(), tradePrice, tradeQty,
                          buyOrder->getPrice(), buyOrder->getOrderType(), buyOrder->getTimeInForce(),
                          sellOrder->getPrice(), sellOrder->getOrderType(), sellOrder->getTimeInForce()};
     }
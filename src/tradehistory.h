@@ -1,7 +1,16 @@
 #pragma once
 
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <span>
+#include <stdexcept>
+#include <utility>
 #include <vector>
 #include "trade.h"
+#include "utils/engine_memory.h"
 
 namespace ob {
 
@@ -15,8 +24,8 @@ public:
         clear();
     }
 
-    void recordTrade(TradePointer trade) {
-        trades_.push_back(trade);
+    void recordTrade(const Trade& trade) {
+        trades_.push_back(new Trade{trade});
     }
 
     const std::vector<TradePointer>& getTrades() const {
@@ -31,4 +40,117 @@ private:
         }
     }
 };
+
+// What RingTradeHistory does with a new trade once every slot is taken
+enum class TradeOverflowPolicy {
+    Overwrite,  // drop the oldest trade
+    Flush       // hand every buffered trade to the flush callback, then start over
+};
+
+// Trade history that stores trades by value in a buffer allocated once at construction, so
+// recording a trade never allocates. Readers get the buffered trades oldest first, either as
+// at most two contiguous spans or through begin()/end().
+class RingTradeHistory {
+public:
+    using FlushCallback = std::function<void(std::span<const Trade>)>;
+
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Trade;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Trade*;
+        using reference = const Trade&;
+
+        const_iterator() = default;
+        const_iterator(const RingTradeHistory* history, std::size_t position) : history_ { history }, position_ { position } { }
+
+        const Trade& operator*() const { return (*history_)[position_]; }
+        const Trade* operator->() const { return &(*history_)[position_]; }
+
+        const_iterator& operator++() {
+            ++position_;
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            const_iterator old = *this;
+            ++position_;
+            return old;
+        }
+
+        bool operator==(const const_iterator& other) const { return position_ == other.position_; }
+
+    private:
+        const RingTradeHistory* history_ = nullptr;
+        std::size_t position_ = 0;
+    };
+
+    // capacity is rounded up to a power of two
+    explicit RingTradeHistory(std::size_t capacity,
+                              TradeOverflowPolicy policy = TradeOverflowPolicy::Overwrite,
+                              FlushCallback onFlush = {})
+        : trades_(std::bit_ceil(std::max<std::size_t>(capacity, 1)))
+        , mask_ { trades_.size() - 1 }
+        , policy_ { policy }
+        , onFlush_ { std::move(onFlush) }
+    {
+        if (policy_ == TradeOverflowPolicy::Flush && !onFlush_) {
+            throw std::invalid_argument("RingTradeHistory with the Flush policy needs a flush callback");
+        }
+    }
+
+    void recordTrade(const Trade& trade) {
+        if (size() == trades_.size()) {
+            if (policy_ == TradeOverflowPolicy::Flush) {
+                flush();
+            } else {
+                ++head_;
+            }
+        }
+        trades_[tail_++ & mask_] = trade;
+        ++totalRecorded_;
+    }
+
+    // Passes the buffered trades to the flush callback, oldest first, and empties the buffer
+    void flush() {
+        auto [first, second] = getTrades();
+        if (onFlush_) {
+            if (!first.empty()) onFlush_(first);
+            if (!second.empty()) onFlush_(second);
+        }
+        head_ = tail_;
+    }
+
+    // Buffered trades oldest first; the second span is non-empty when they wrap around the end
+    std::pair<std::span<const Trade>, std::span<const Trade>> getTrades() const {
+        std::size_t start = head_ & mask_;
+        std::size_t count = size();
+        std::size_t firstCount = std::min(count, trades_.size() - start);
+        return { std::span<const Trade>(trades_.data() + start, firstCount),
+                 std::span<const Trade>(trades_.data(), count - firstCount) };
+    }
+
+    // Trade i positions after the oldest buffered trade
+    const Trade& operator[](std::size_t i) const { return trades_[(head_ + i) & mask_]; }
+
+    const_iterator begin() const { return { this, 0 }; }
+    const_iterator end() const { return { this, size() }; }
+
+    std::size_t size() const { return tail_ - head_; }
+    bool empty() const { return size() == 0; }
+    std::size_t capacity() const { return trades_.size(); }
+    // Every trade ever recorded, including ones overwritten or flushed
+    std::size_t totalRecorded() const { return totalRecorded_; }
+
+private:
+    std::vector<Trade, EngineAllocator<Trade>> trades_;
+    std::size_t mask_;
+    std::size_t head_ = 0;  // position of the oldest buffered trade, only ever increases
+    std::size_t tail_ = 0;  // position the next trade is written to
+    std::size_t totalRecorded_ = 0;
+    TradeOverflowPolicy policy_;
+    FlushCallback onFlush_;
+};
+
 } // namespace ob
@@ -0,0 +1,105 @@
+#include "trigger_book.h"
+
+#include "utils/object_pool.h"
+
+#include <iterator>
+
+namespace ob {
+
+TriggerBook::~TriggerBook() {
+    for (auto it : stops_) {
+        ObjectPool::release(it.second);
+    }
+    while (OrderPointer order = triggered_.front()) {
+        triggered_.erase(order);
+        ObjectPool::release(order);
+    }
+}
+
+void TriggerBook::add(OrderPointer order) {
+    stops_.emplace(order->getOrderId(), order);
+    if (order->getOrderSide() == OrderSide::Buy) {
+        buyStops_[order->getStopPrice()].push_back(order);
+    } else {
+        sellStops_[order->getStopPrice()].push_back(order);
+    }
+}
+
+bool TriggerBook::cancel(OrderId orderId) {
+    auto it = stops_.find(orderId);
+    if (it == stops_.end()) {
+        return false;
+    }
+
+    OrderPointer order = it->second;
+    Price stopPrice = order->getStopPrice();
+    if (order->getOrderSide() == OrderSide::Buy) {
+        auto& ordersAtStopPrice = buyStops_[stopPrice];
+        ordersAtStopPrice.erase(order);
+        if (ordersAtStopPrice.empty()) {
+            buyStops_.erase(stopPrice);
+        }
+    } else {
+        auto& ordersAtStopPrice = sellStops_[stopPrice];
+        ordersAtStopPrice.erase(order);
+        if (ordersAtStopPrice.empty()) {
+            sellStops_.erase(stopPrice);
+        }
+    }
+    stops_.erase(it);
+    order->tryCancel(); // dormant stops have never traded
+    ObjectPool::release(order);
+    return true;
+}
+
+void TriggerBook::cancelOrders(const MassCancelFilter& filter, OrderPointers& cancelled) {
+    if (filter.matchesSide(OrderSide::Buy)) {
+        cancelMatching(buyStops_, filter, cancelled);
+    }
+    if (filter.matchesSide(OrderSide::Sell)) {
+        cancelMatching(sellStops_, filter, cancelled);
+    }
+}
+
+template <typename Stops>
+void TriggerBook::cancelMatching(Stops& stops, const MassCancelFilter& filter, OrderPointers& cancelled) {
+    for (auto levelIt = stops.begin(); levelIt != stops.end(); ) {
+        OrderQueue& ordersAtStopPrice = levelIt->second;
+        if (filter.matchesPrice(levelIt->first)) {
+            for (auto it = ordersAtStopPrice.begin(); it != ordersAtStopPrice.end(); ) {
+                OrderPointer order = *it++;
+                if (filter.matchesOwner(*order)) {
+                    ordersAtStopPrice.erase(order);
+                    stops_.erase(order->getOrderId());
+                    order->tryCancel();
+                    cancelled.push_back(order);
+                }
+            }
+        }
+        levelIt = ordersAtStopPrice.empty() ? stops.erase(levelIt) : std::next(levelIt);
+    }
+}
+
+void TriggerBook::trigger(Price price) {
+    // Whole levels move at once; the levels a trade reaches are always at the front of each side
+    while (!buyStops_.empty() && buyStops_.begin()->first <= price) {
+        auto& ordersAtStopPrice = buyStops_.begin()->second;
+        while (OrderPointer order = ordersAtStopPrice.front()) {
+            ordersAtStopPrice.erase(order);
+            stops_.erase(order->getOrderId());
+            triggered_.push_back(order);
+        }
+        buyStops_.erase(buyStops_.begin());
+    }
+    while (!sellStops_.empty() && sellStops_.begin()->first >= price) {
+        auto& ordersAtStopPrice = sellStops_.begin()->second;
+        while (OrderPointer order = ordersAtStopPrice.front()) {
+            ordersAtStopPrice.erase(order);
+            stops_.erase(order->getOrderId());
+            triggered_.push_back(order);
+        }
+        sellStops_.erase(sellStops_.begin());
+    }
+}
+
+} // namespace ob
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "order.h"
+#include "order_queue.h"
+#include "utils/flat_hash_map.h"
+
+#include <cstddef>
+#include <functional>
+#include <map>
+
+namespace ob {
+
+// Dormant stop and stop-limit orders, kept apart from the resting book and indexed by stop
+// price. A buy stop triggers once a trade prints at or above its stop price, a sell stop once a
+// trade prints at or below it, so each side is ordered by how soon its stops trigger and a trade
+// only ever looks at the first level of each side. Stops that a trade triggers leave in a fixed
+// sequence: buy stops before sell stops, each side by stop price and then in arrival order.
+class TriggerBook {
+public:
+    using BuyStops = std::map<Price, OrderQueue, std::less<Price>>;      // lowest stop price first
+    using SellStops = std::map<Price, OrderQueue, std::greater<Price>>;  // highest stop price first
+
+    static constexpr std::size_t kDefaultCapacityHint = 64;
+
+    explicit TriggerBook(std::size_t capacityHint = kDefaultCapacityHint)
+        : stops_ { capacityHint }
+    { }
+
+    // Releases the stops still waiting
+    ~TriggerBook();
+
+    TriggerBook(const TriggerBook&) = delete;
+    TriggerBook& operator=(const TriggerBook&) = delete;
+
+    void add(OrderPointer order);
+    // Cancels and releases a dormant stop; false if no dormant stop has this id
+    bool cancel(OrderId orderId);
+    // Cancels every dormant stop that matches filter and appends it to cancelled, unreleased
+    void cancelOrders(const MassCancelFilter& filter, OrderPointers& cancelled);
+    // The dormant stop with this id, or nullptr
+    OrderPointer find(OrderId orderId) const {
+        auto it = stops_.find(orderId);
+        return it == stops_.end() ? nullptr : it->second;
+    }
+
+    // Whether the last trade has already reached the stop price, i.e. the stop should not wait
+    bool isTriggered(const Order& order) const {
+        if (lastTradePrice_ == 0) {
+            return false;
+        }
+        return order.getOrderSide() == OrderSide::Buy ? lastTradePrice_ >= order.getStopPrice()
+                                                      : lastTradePrice_ <= order.getStopPrice();
+    }
+
+    // Called with the price of every trade. Moves the stops it triggers to the back of the
+    // triggered queue; a trade that triggers nothing costs two comparisons.
+    void onTrade(Price price) {
+        lastTradePrice_ = price;
+        if ((!buyStops_.empty() && buyStops_.begin()->first <= price)
+            || (!sellStops_.empty() && sellStops_.begin()->first >= price)) {
+            trigger(price);
+        }
+    }
+
+    // The next triggered stop, already turned into the order it becomes, or nullptr
+    OrderPointer popTriggered() {
+        OrderPointer order = triggered_.front();
+        if (order != nullptr) {
+            triggered_.erase(order);
+            activate(order);
+        }
+        return order;
+    }
+
+    // A stop becomes a market order (immediate-or-cancel unless it is fill-or-kill) and a
+    // stop-limit becomes a limit order with its own time in force
+    static void activate(OrderPointer order) {
+        if (order->getOrderType() == OrderType::Stop) {
+            order->setOrderType(OrderType::Market);
+            if (order->getTimeInForce() == TimeInForce::GoodTillCancel) {
+                order->setTimeInForce(TimeInForce::ImmediateOrCancel);
+            }
+        } else {
+            order->setOrderType(OrderType::Limit);
+        }
+    }
+
+    // 0 until the first trade
+    Price getLastTradePrice() const { return lastTradePrice_; }
+    void setLastTradePrice(Price price) { lastTradePrice_ = price; }
+
+    const BuyStops& getBuyStops() const { return buyStops_; }
+    const SellStops& getSellStops() const { return sellStops_; }
+    std::size_t size() const { return stops_.size(); }
+    bool empty() const { return stops_.empty(); }
+
+private:
+    BuyStops buyStops_;
+    SellStops sellStops_;
+    FlatHashMap<OrderId, OrderPointer, nullptr> stops_;
+    OrderQueue triggered_;
+    Price lastTradePrice_ = 0;
+
+    void trigger(Price price);
+
+    template <typename Stops>
+    void cancelMatching(Stops& stops, const MassCancelFilter& filter, OrderPointers& cancelled);
+};
+
+} // namespace ob
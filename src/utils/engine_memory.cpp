@@ -0,0 +1,175 @@
+#include "engine_memory.h"
+
+#include <atomic>
+#include <cstdint>
+#include <new>
+
+#ifdef __unix__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace ob {
+
+namespace {
+
+constexpr std::size_t kHeaderSize = 64;     // keeps what follows it cache-line aligned
+
+// Sits in front of every block so it can be freed without knowing how it was made
+struct BlockHeader {
+    void* base;             // start of the mapping, nullptr for heap blocks
+    std::size_t size;       // of the mapping, or of the heap block including this header
+    bool hugePages;
+    bool locked;
+};
+static_assert(sizeof(BlockHeader) <= kHeaderSize);
+
+MemoryConfig config;
+
+std::atomic<std::size_t> heapBytes { 0 };
+std::atomic<std::size_t> mappedBytes { 0 };
+std::atomic<std::size_t> hugePageBytes { 0 };
+std::atomic<std::size_t> lockedBytes { 0 };
+std::atomic<std::size_t> mappings { 0 };
+std::atomic<std::size_t> hugePageFallbacks { 0 };
+std::atomic<std::size_t> lockFailures { 0 };
+
+void* allocateHeap(std::size_t size) {
+    void* block = ::operator new(size, std::align_val_t{ kHeaderSize });
+    new (block) BlockHeader{ nullptr, size, false, false };
+    heapBytes.fetch_add(size, std::memory_order_relaxed);
+    return static_cast<std::byte*>(block) + kHeaderSize;
+}
+
+#ifdef __unix__
+
+// size is a whole number of huge pages; the start is aligned to one so the kernel can use them
+void* mapAligned(std::size_t size, bool& hugePages) {
+    if (hugePages) {
+        void* mapping = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (mapping != MAP_FAILED) {
+            return mapping;
+        }
+        hugePages = false;
+        hugePageFallbacks.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Over-map by one huge page, then trim both ends back to an aligned range
+    void* mapping = ::mmap(nullptr, size + kHugePageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapping == MAP_FAILED) {
+        return nullptr;
+    }
+    auto start = reinterpret_cast<std::uintptr_t>(mapping);
+    auto aligned = (start + kHugePageSize - 1) & ~(kHugePageSize - 1);
+    if (aligned != start) {
+        ::munmap(mapping, aligned - start);
+    }
+    if (std::size_t tail = start + kHugePageSize - aligned; tail != 0) {
+        ::munmap(reinterpret_cast<void*>(aligned + size), tail);
+    }
+#ifdef MADV_HUGEPAGE
+    // Before the first touch, so the pages are faulted in huge
+    ::madvise(reinterpret_cast<void*>(aligned), size, MADV_HUGEPAGE);
+#endif
+    return reinterpret_cast<void*>(aligned);
+}
+
+void* allocateMapped(std::size_t bytes) {
+    std::size_t size = (bytes + kHeaderSize + kHugePageSize - 1) & ~(kHugePageSize - 1);
+    bool hugePages = config.hugePages == HugePages::Explicit;
+    void* base = mapAligned(size, hugePages);
+    if (base == nullptr) {
+        return allocateHeap(bytes + kHeaderSize);
+    }
+
+    if (config.prefault) {
+        const std::size_t step = hugePages ? kHugePageSize : static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+        auto* bytesOf = static_cast<volatile std::byte*>(base);
+        for (std::size_t offset = 0; offset < size; offset += step) {
+            bytesOf[offset] = std::byte{ 0 };
+        }
+    }
+    bool locked = false;
+    if (config.lock) {
+        locked = ::mlock(base, size) == 0;
+        if (locked) {
+            lockedBytes.fetch_add(size, std::memory_order_relaxed);
+        } else {
+            lockFailures.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    new (base) BlockHeader{ base, size, hugePages, locked };
+    mappedBytes.fetch_add(size, std::memory_order_relaxed);
+    mappings.fetch_add(1, std::memory_order_relaxed);
+    if (hugePages) {
+        hugePageBytes.fetch_add(size, std::memory_order_relaxed);
+    }
+    return static_cast<std::byte*>(base) + kHeaderSize;
+}
+
+void freeMapped(const BlockHeader& header) {
+    BlockHeader copy = header;  // the header goes with the mapping
+    if (copy.locked) {
+        ::munlock(copy.base, copy.size);
+        lockedBytes.fetch_sub(copy.size, std::memory_order_relaxed);
+    }
+    if (copy.hugePages) {
+        hugePageBytes.fetch_sub(copy.size, std::memory_order_relaxed);
+    }
+    mappedBytes.fetch_sub(copy.size, std::memory_order_relaxed);
+    mappings.fetch_sub(1, std::memory_order_relaxed);
+    ::munmap(copy.base, copy.size);
+}
+
+#else
+
+void* allocateMapped(std::size_t bytes) {
+    return allocateHeap(bytes + kHeaderSize);
+}
+
+void freeMapped(const BlockHeader&) { }
+
+#endif
+
+} // namespace
+
+void configureMemory(const MemoryConfig& newConfig) {
+    config = newConfig;
+}
+
+const MemoryConfig& memoryConfig() {
+    return config;
+}
+
+MemoryFootprint memoryFootprint() {
+    return { heapBytes.load(std::memory_order_relaxed),
+             mappedBytes.load(std::memory_order_relaxed),
+             hugePageBytes.load(std::memory_order_relaxed),
+             lockedBytes.load(std::memory_order_relaxed),
+             mappings.load(std::memory_order_relaxed),
+             hugePageFallbacks.load(std::memory_order_relaxed),
+             lockFailures.load(std::memory_order_relaxed) };
+}
+
+void* allocateEngineMemory(std::size_t bytes) {
+    if (config.hugePages != HugePages::None && bytes >= config.minMappedBytes) {
+        return allocateMapped(bytes);
+    }
+    return allocateHeap(bytes + kHeaderSize);
+}
+
+void freeEngineMemory(void* memory) {
+    if (memory == nullptr) {
+        return;
+    }
+    auto* header = reinterpret_cast<BlockHeader*>(static_cast<std::byte*>(memory) - kHeaderSize);
+    if (header->base != nullptr) {
+        freeMapped(*header);
+        return;
+    }
+    heapBytes.fetch_sub(header->size, std::memory_order_relaxed);
+    ::operator delete(header, std::align_val_t{ kHeaderSize });
+}
+
+} // namespace ob
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+namespace ob {
+
+enum class HugePages : std::uint8_t {
+    None,           // ordinary heap memory
+    Transparent,    // 2 MB aligned mappings the kernel is asked to back with transparent huge pages
+    Explicit        // MAP_HUGETLB from the reserved pool, falling back to Transparent when it is empty
+};
+
+// Where the engine's large, long-lived buffers come from: order arena slabs, the order index,
+// price ladder levels and the trade and execution-report rings. Set it once at startup, before
+// any of them is built; the buffers are then sized by the usual capacity hints (ObjectPool,
+// book capacity hint and price band, ring capacities), so reserving up front means nothing is
+// mapped or faulted in on the hot path later.
+struct MemoryConfig {
+    HugePages hugePages = HugePages::None;
+    bool prefault = false;              // touch every page when it is mapped
+    bool lock = false;                  // mlock mapped buffers; a refusal is counted, not thrown
+    std::size_t minMappedBytes = 1 << 20;   // smaller buffers stay on the heap
+};
+
+// Memory that went through allocateEngineMemory and is still in use
+struct MemoryFootprint {
+    std::size_t heapBytes = 0;
+    std::size_t mappedBytes = 0;        // including rounding up to whole huge pages
+    std::size_t hugePageBytes = 0;      // mapped with MAP_HUGETLB
+    std::size_t lockedBytes = 0;
+    std::size_t mappings = 0;
+    std::size_t hugePageFallbacks = 0;  // explicit huge page mappings that had to fall back, ever
+    std::size_t lockFailures = 0;       // mlock calls refused, ever
+};
+
+inline constexpr std::size_t kHugePageSize = std::size_t{2} << 20;
+
+void configureMemory(const MemoryConfig& config);
+const MemoryConfig& memoryConfig();
+MemoryFootprint memoryFootprint();
+
+// 64-byte aligned. Memory is mapped (and pre-faulted and locked as configured) when huge pages
+// are on and bytes reaches minMappedBytes; freeing works whatever the configuration is by then.
+void* allocateEngineMemory(std::size_t bytes);
+void freeEngineMemory(void* memory);
+
+// Standard allocator over allocateEngineMemory, for the containers behind the engine's buffers
+template <typename T>
+struct EngineAllocator {
+    using value_type = T;
+
+    EngineAllocator() = default;
+    template <typename U>
+    EngineAllocator(const EngineAllocator<U>&) { }
+
+    T* allocate(std::size_t count) { return static_cast<T*>(allocateEngineMemory(count * sizeof(T))); }
+    void deallocate(T* memory, std::size_t) { freeEngineMemory(memory); }
+
+    template <typename U>
+    bool operator==(const EngineAllocator<U>&) const { return true; }
+};
+
+} // namespace ob
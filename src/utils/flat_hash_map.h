@@ -0,0 +1,212 @@
+#pragma once
+
+#include "engine_memory.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace ob {
+
+// Multiplicative (Fibonacci) hashing. FlatHashMap takes the top bits of the product, which are
+// well mixed even for the sequential ids the gateway hands out.
+struct FibonacciHash {
+    std::size_t operator()(std::uint64_t key) const {
+        return static_cast<std::size_t>(key * 11400714819323198485ull);
+    }
+};
+
+// Open-addressing hash map with linear probing, stored as one flat array of key/value slots.
+// A slot whose value equals EmptyValue is free, so EmptyValue can never be stored. Erase shifts
+// the rest of the probe run back instead of leaving tombstones, and the table only allocates
+// when it grows past the capacity it was constructed or reserved with.
+template <typename Key, typename Value, Value EmptyValue = Value{}, typename Hash = FibonacciHash>
+class FlatHashMap {
+public:
+    using key_type = Key;
+    using mapped_type = Value;
+    using value_type = std::pair<Key, Value>;
+    using size_type = std::size_t;
+
+private:
+    static constexpr size_type kMinCapacity = 16;
+
+    template <bool IsConst>
+    class Iterator {
+        using Slot = std::conditional_t<IsConst, const std::pair<Key, Value>, std::pair<Key, Value>>;
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::pair<Key, Value>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Slot*;
+        using reference = Slot&;
+
+        Iterator() = default;
+        Iterator(Slot* slot, Slot* last) : slot_ { slot }, last_ { last } { skipEmpty(); }
+
+        Slot& operator*() const { return *slot_; }
+        Slot* operator->() const { return slot_; }
+
+        Iterator& operator++() {
+            ++slot_;
+            skipEmpty();
+            return *this;
+        }
+
+        bool operator==(const Iterator& other) const { return slot_ == other.slot_; }
+
+    private:
+        Slot* slot_ = nullptr;
+        Slot* last_ = nullptr;
+
+        void skipEmpty() {
+            while (slot_ != last_ && slot_->second == EmptyValue) {
+                ++slot_;
+            }
+        }
+    };
+
+public:
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    // Sized so that capacityHint entries fit without growing
+    explicit FlatHashMap(size_type capacityHint = 0) {
+        rehash(slotsFor(capacityHint));
+    }
+
+    iterator begin() { return { slots_.data(), slots_.data() + slots_.size() }; }
+    iterator end() { return { slots_.data() + slots_.size(), slots_.data() + slots_.size() }; }
+    const_iterator begin() const { return { slots_.data(), slots_.data() + slots_.size() }; }
+    const_iterator end() const { return { slots_.data() + slots_.size(), slots_.data() + slots_.size() }; }
+
+    iterator find(Key key) {
+        size_type index = findIndex(key);
+        return index == slots_.size() ? end() : iterator{ &slots_[index], slots_.data() + slots_.size() };
+    }
+
+    const_iterator find(Key key) const {
+        size_type index = findIndex(key);
+        return index == slots_.size() ? end() : const_iterator{ &slots_[index], slots_.data() + slots_.size() };
+    }
+
+    bool contains(Key key) const { return findIndex(key) != slots_.size(); }
+
+    // Like std::unordered_map::emplace, leaves an existing entry untouched
+    std::pair<iterator, bool> emplace(Key key, Value value) {
+        if ((size_ + 1) * 2 > slots_.size()) {
+            rehash(slots_.size() * 2);
+        }
+
+        size_type index = homeOf(key);
+        while (slots_[index].second != EmptyValue) {
+            if (slots_[index].first == key) {
+                return { iterator{ &slots_[index], slots_.data() + slots_.size() }, false };
+            }
+            index = (index + 1) & mask_;
+        }
+
+        slots_[index] = { key, value };
+        ++size_;
+        return { iterator{ &slots_[index], slots_.data() + slots_.size() }, true };
+    }
+
+    void erase(iterator it) {
+        eraseIndex(static_cast<size_type>(&*it - slots_.data()));
+    }
+
+    size_type erase(Key key) {
+        size_type index = findIndex(key);
+        if (index == slots_.size()) {
+            return 0;
+        }
+        eraseIndex(index);
+        return 1;
+    }
+
+    void clear() {
+        for (auto& slot : slots_) {
+            slot.second = EmptyValue;
+        }
+        size_ = 0;
+    }
+
+    void reserve(size_type count) {
+        if (slotsFor(count) > slots_.size()) {
+            rehash(slotsFor(count));
+        }
+    }
+
+    size_type size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    size_type capacity() const { return slots_.size() / 2; }
+
+private:
+    std::vector<value_type, EngineAllocator<value_type>> slots_;
+    size_type size_ = 0;
+    size_type mask_ = 0;
+    int shift_ = 0;
+
+    // Keep the load factor at or below one half so probe runs stay short
+    static size_type slotsFor(size_type count) {
+        return std::bit_ceil(std::max(count * 2, kMinCapacity));
+    }
+
+    size_type homeOf(Key key) const {
+        return Hash{}(key) >> shift_;
+    }
+
+    size_type findIndex(Key key) const {
+        size_type index = homeOf(key);
+        while (slots_[index].second != EmptyValue) {
+            if (slots_[index].first == key) {
+                return index;
+            }
+            index = (index + 1) & mask_;
+        }
+        return slots_.size();
+    }
+
+    // Backward-shift deletion: pull later entries of the probe run into the hole whenever the
+    // hole lies between their home slot and where they currently sit.
+    void eraseIndex(size_type hole) {
+        size_type next = (hole + 1) & mask_;
+        while (slots_[next].second != EmptyValue) {
+            size_type home = homeOf(slots_[next].first);
+            if (((next - home) & mask_) >= ((next - hole) & mask_)) {
+                slots_[hole] = slots_[next];
+                hole = next;
+            }
+            next = (next + 1) & mask_;
+        }
+        slots_[hole].second = EmptyValue;
+        --size_;
+    }
+
+    void rehash(size_type newSlotCount) {
+        std::vector<value_type, EngineAllocator<value_type>> oldSlots(newSlotCount, value_type{ Key{}, EmptyValue });
+        oldSlots.swap(slots_);
+        mask_ = newSlotCount - 1;
+        shift_ = std::numeric_limits<std::size_t>::digits - std::countr_zero(newSlotCount);
+        size_ = 0;
+
+        for (const auto& slot : oldSlots) {
+            if (slot.second != EmptyValue) {
+                size_type index = homeOf(slot.first);
+                while (slots_[index].second != EmptyValue) {
+                    index = (index + 1) & mask_;
+                }
+                slots_[index] = slot;
+                ++size_;
+            }
+        }
+    }
+};
+
+} // namespace ob
@@ -0,0 +1,206 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+#include <thread>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <x86intrin.h>
+#endif
+
+namespace ob {
+
+// Cheap timestamp: the TSC where there is one (invariant on every x86 we deploy to), otherwise
+// steady_clock nanoseconds. Only differences are meaningful.
+inline std::uint64_t readCycles() {
+#if defined(__x86_64__) || defined(_M_X64)
+    return __rdtsc();
+#else
+    return static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+// Measured once against steady_clock, takes about 10ms on first use
+inline double cyclesPerNanosecond() {
+    static const double rate = [] {
+        auto wallStart = std::chrono::steady_clock::now();
+        std::uint64_t cycleStart = readCycles();
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        std::uint64_t cycles = readCycles() - cycleStart;
+        auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - wallStart).count();
+        return nanos > 0 ? static_cast<double>(cycles) / static_cast<double>(nanos) : 1.0;
+    }();
+    return rate;
+}
+
+// Log-linear histogram over the full uint64 range: values below 2^kSubBucketBits get their own
+// bucket, every power of two above that is split into 2^kSubBucketBits equal buckets, so any
+// reported percentile is within about 3% of the true value. Fixed size, never allocates.
+class LatencyHistogram {
+public:
+    static constexpr unsigned kSubBucketBits = 5;
+    static constexpr std::size_t kSubBuckets = std::size_t{1} << kSubBucketBits;
+    static constexpr std::size_t kBucketCount = kSubBuckets + (64 - kSubBucketBits) * kSubBuckets;
+
+    void record(std::uint64_t value) {
+        ++counts_[bucketOf(value)];
+        ++count_;
+        max_ = std::max(max_, value);
+    }
+
+    // Smallest recorded value v such that at least fraction of the samples are <= v, reported
+    // as the top of its bucket (never above max)
+    std::uint64_t percentile(double fraction) const {
+        if (count_ == 0) {
+            return 0;
+        }
+        auto target = static_cast<std::uint64_t>(fraction * static_cast<double>(count_));
+        target = std::clamp<std::uint64_t>(target, 1, count_);
+
+        std::uint64_t seen = 0;
+        for (std::size_t bucket = 0; bucket < kBucketCount; ++bucket) {
+            seen += counts_[bucket];
+            if (seen >= target) {
+                return std::min(bucketUpperBound(bucket), max_);
+            }
+        }
+        return max_;
+    }
+
+    void reset() {
+        counts_.fill(0);
+        count_ = 0;
+        max_ = 0;
+    }
+
+    std::uint64_t count() const { return count_; }
+    std::uint64_t max() const { return max_; }
+
+    static std::size_t bucketOf(std::uint64_t value) {
+        if (value < kSubBuckets) {
+            return static_cast<std::size_t>(value);
+        }
+        unsigned magnitude = static_cast<unsigned>(std::bit_width(value)) - 1;   // >= kSubBucketBits
+        unsigned shift = magnitude - kSubBucketBits;
+        std::size_t subBucket = static_cast<std::size_t>(value >> shift) - kSubBuckets;
+        return kSubBuckets + shift * kSubBuckets + subBucket;
+    }
+
+    // Largest value that falls in bucket
+    static std::uint64_t bucketUpperBound(std::size_t bucket) {
+        if (bucket < kSubBuckets) {
+            return bucket;
+        }
+        std::size_t shift = (bucket - kSubBuckets) / kSubBuckets;
+        std::uint64_t subBucket = (bucket - kSubBuckets) % kSubBuckets;
+        return ((kSubBuckets + subBucket + 1) << shift) - 1;
+    }
+
+private:
+    std::array<std::uint64_t, kBucketCount> counts_ {};
+    std::uint64_t count_ = 0;
+    std::uint64_t max_ = 0;
+};
+
+// Instrumented stages of an order's path through the engine
+enum class LatencyStage : std::uint8_t {
+    GatewaySubmit,  // OrderGateway::submitOrder, validation through matching
+    MatchOrders,    // MatchingEngine, sweeping the opposite side
+    ExecuteTrade,   // one fill against one resting order
+    BookInsert,     // OrderBook::addOrder
+    Count
+};
+
+inline constexpr std::string_view latencyStageName(LatencyStage stage) {
+    switch (stage) {
+        case LatencyStage::GatewaySubmit: return "gateway_submit";
+        case LatencyStage::MatchOrders:   return "match_orders";
+        case LatencyStage::ExecuteTrade:  return "execute_trade";
+        case LatencyStage::BookInsert:    return "book_insert";
+        default:                          return "unknown";
+    }
+}
+
+struct LatencySummary {
+    std::uint64_t count;
+    std::uint64_t p50;      // all in cycles, see cyclesPerNanosecond()
+    std::uint64_t p99;
+    std::uint64_t p999;
+    std::uint64_t max;
+};
+
+// One set of per-stage histograms per thread, so matching threads never contend on a counter
+class LatencyStats {
+public:
+    static constexpr std::size_t kStageCount = static_cast<std::size_t>(LatencyStage::Count);
+
+    static void record(LatencyStage stage, std::uint64_t cycles) {
+        histograms_[static_cast<std::size_t>(stage)].record(cycles);
+    }
+
+    static const LatencyHistogram& histogram(LatencyStage stage) {
+        return histograms_[static_cast<std::size_t>(stage)];
+    }
+
+    static LatencySummary summary(LatencyStage stage) {
+        const LatencyHistogram& h = histogram(stage);
+        return { h.count(), h.percentile(0.50), h.percentile(0.99), h.percentile(0.999), h.max() };
+    }
+
+    static void reset() {
+        for (auto& h : histograms_) {
+            h.reset();
+        }
+    }
+
+    // One line per stage that has samples, in nanoseconds
+    static void writeReport(std::ostream& out) {
+        const double rate = cyclesPerNanosecond();
+        auto nanos = [rate](std::uint64_t cycles) { return static_cast<std::uint64_t>(static_cast<double>(cycles) / rate); };
+        for (std::size_t i = 0; i < kStageCount; ++i) {
+            auto stage = static_cast<LatencyStage>(i);
+            LatencySummary s = summary(stage);
+            if (s.count == 0) {
+                continue;
+            }
+            out << latencyStageName(stage) << " count=" << s.count
+                << " p50=" << nanos(s.p50) << "ns p99=" << nanos(s.p99) << "ns p99.9=" << nanos(s.p999)
+                << "ns max=" << nanos(s.max) << "ns\n";
+        }
+    }
+
+private:
+    inline static thread_local std::array<LatencyHistogram, kStageCount> histograms_ {};
+};
+
+// Records the time between construction and destruction against a stage
+class ScopedLatency {
+public:
+    explicit ScopedLatency(LatencyStage stage) : stage_ { stage }, start_ { readCycles() } { }
+    ~ScopedLatency() { LatencyStats::record(stage_, readCycles() - start_); }
+
+    ScopedLatency(const ScopedLatency&) = delete;
+    ScopedLatency& operator=(const ScopedLatency&) = delete;
+
+private:
+    LatencyStage stage_;
+    std::uint64_t start_;
+};
+
+} // namespace ob
+
+// Instrumentation points compile to nothing unless the build defines OB_LATENCY_STATS
+// (cmake -DORDERBOOK_LATENCY_STATS=ON)
+#define OB_LATENCY_CONCAT_INNER(a, b) a##b
+#define OB_LATENCY_CONCAT(a, b) OB_LATENCY_CONCAT_INNER(a, b)
+#ifdef OB_LATENCY_STATS
+#define OB_LATENCY_SCOPE(stage) ::ob::ScopedLatency OB_LATENCY_CONCAT(obLatencyScope, __LINE__) { stage }
+#else
+#define OB_LATENCY_SCOPE(stage) static_cast<void>(0)
+#endif
@@ -0,0 +1,88 @@
+#include "mapped_file.h"
+
+#include <format>
+#include <stdexcept>
+
+#ifdef __unix__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ob {
+
+#ifdef __unix__
+
+MappedFile::MappedFile(const std::string& path) {
+    fd_ = ::open(path.c_str(), O_RDONLY);
+    if (fd_ < 0) {
+        throw std::runtime_error(std::format("Unable to open ({}) for mapping", path));
+    }
+    struct stat info;
+    if (::fstat(fd_, &info) != 0) {
+        ::close(fd_);
+        throw std::runtime_error(std::format("Unable to read the size of ({})", path));
+    }
+    size_ = static_cast<std::size_t>(info.st_size);
+    map(path, false);
+}
+
+MappedFile::MappedFile(const std::string& path, std::size_t size)
+    : size_ { size }
+{
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd_ < 0) {
+        throw std::runtime_error(std::format("Unable to create ({}) for mapping", path));
+    }
+    if (::ftruncate(fd_, static_cast<off_t>(size_)) != 0) {
+        ::close(fd_);
+        throw std::runtime_error(std::format("Unable to size ({}) to {} bytes", path, size_));
+    }
+    map(path, true);
+}
+
+MappedFile::~MappedFile() {
+    if (data_ != nullptr) {
+        ::munmap(data_, size_);
+    }
+    ::close(fd_);
+}
+
+void MappedFile::sync() {
+    if (data_ != nullptr) {
+        ::msync(data_, size_, MS_SYNC);
+    }
+}
+
+void MappedFile::map(const std::string& path, bool writable) {
+    if (size_ == 0) {
+        return; // mmap rejects empty mappings, and there is nothing to read anyway
+    }
+    void* mapping = ::mmap(nullptr, size_, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd_, 0);
+    if (mapping == MAP_FAILED) {
+        ::close(fd_);
+        throw std::runtime_error(std::format("Unable to map ({})", path));
+    }
+    data_ = static_cast<std::byte*>(mapping);
+    // Snapshots are read front to back exactly once
+    ::madvise(data_, size_, MADV_SEQUENTIAL);
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path) {
+    throw std::runtime_error(std::format("Memory-mapped files are not supported on this platform ({})", path));
+}
+
+MappedFile::MappedFile(const std::string& path, std::size_t) {
+    throw std::runtime_error(std::format("Memory-mapped files are not supported on this platform ({})", path));
+}
+
+MappedFile::~MappedFile() = default;
+void MappedFile::sync() { }
+void MappedFile::map(const std::string&, bool) { }
+
+#endif
+
+} // namespace ob
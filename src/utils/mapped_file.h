@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <string>
+
+namespace ob {
+
+// A whole file mapped into memory (POSIX only). Read-only when opened, read-write when created.
+class MappedFile {
+public:
+    // Maps an existing file read-only
+    explicit MappedFile(const std::string& path);
+    // Creates (or truncates) the file at the given size and maps it read-write
+    MappedFile(const std::string& path, std::size_t size);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    std::span<const std::byte> data() const { return { data_, size_ }; }
+    std::span<std::byte> writableData() { return { data_, size_ }; }
+    std::size_t size() const { return size_; }
+
+    // Writes dirty pages back to the file and waits for them
+    void sync();
+
+private:
+    std::byte* data_ = nullptr;
+    std::size_t size_ = 0;
+    int fd_ = -1;
+
+    void map(const std::string& path, bool writable);
+};
+
+} // namespace ob
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "thread_utils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace ob {
+
+// Bounded multi-producer single-consumer ring buffer. Every cell carries a sequence number that
+// says whose turn it is: producers claim a cell by advancing tail_ with a CAS and publish it by
+// bumping the sequence, and the consumer hands the cell back one lap later. No locks, and a
+// producer that stalls mid-push only holds up the consumer, never the other producers.
+template <typename T>
+class MpscQueue {
+public:
+    // capacity is rounded up to a power of two
+    explicit MpscQueue(std::size_t capacity)
+        : capacity_ { std::bit_ceil(std::max<std::size_t>(capacity, 2)) }
+        , mask_ { capacity_ - 1 }
+        , cells_ { std::make_unique<Cell[]>(capacity_) }
+    {
+        for (std::size_t i = 0; i < capacity_; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    // Any thread
+    bool tryPush(const T& item) {
+        std::size_t position = tail_.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells_[position & mask_];
+            std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            auto lag = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+            if (lag == 0) {
+                if (tail_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (lag < 0) {
+                return false;   // the consumer has not freed this cell yet, so the ring is full
+            } else {
+                position = tail_.load(std::memory_order_relaxed);
+            }
+        }
+        cell->item = item;
+        cell->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only
+    bool tryPop(T& item) {
+        Cell& cell = cells_[head_ & mask_];
+        if (cell.sequence.load(std::memory_order_acquire) != head_ + 1) {
+            return false;
+        }
+        item = cell.item;
+        cell.sequence.store(head_ + capacity_, std::memory_order_release);
+        ++head_;
+        return true;
+    }
+
+    std::size_t capacity() const { return capacity_; }
+
+private:
+    struct Cell {
+        std::atomic<std::size_t> sequence;
+        T item;
+    };
+
+    std::size_t capacity_;
+    std::size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+
+    alignas(kCacheLineSize) std::atomic<std::size_t> tail_ { 0 };   // next position a producer claims
+    alignas(kCacheLineSize) std::size_t head_ = 0;                  // next position to pop
+};
+
+} // namespace ob
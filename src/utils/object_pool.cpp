@@ -2,44 +2,91 @@
 
 #include "order.h"
 
+#include <vector>
+
 namespace ob {
 
+namespace {
+
+// Orders this thread released for other threads' arenas, one chain per arena. Few threads hand
+// orders across, so a short vector searched from the front is enough.
+class StagedReleases {
+public:
+    ~StagedReleases() { flush(); }
+
+    void add(Order& order) {
+        OrderArena* arena = OrderArena::fromId(order.getArenaId());
+        auto it = pending_.begin();
+        while (it != pending_.end() && it->arena != arena) {
+            ++it;
+        }
+        if (it == pending_.end()) {
+            it = pending_.insert(it, Pending{ arena, {} });
+        }
+        OrderArena::chainRelease(it->chain, order);
+        if (it->chain.count == ObjectPool::kReturnBatch) {
+            arena->returnChain(it->chain);
+        }
+    }
+
+    void flush() {
+        for (Pending& pending : pending_) {
+            if (pending.chain.count > 0) {
+                pending.arena->returnChain(pending.chain);
+            }
+        }
+    }
+
+private:
+    struct Pending {
+        OrderArena* arena;
+        OrderArena::FreeChain chain;
+    };
+    std::vector<Pending> pending_;
+};
+
+thread_local StagedReleases staged;
+
+} // namespace
+
 // Might want to experiment with initialSize
 ObjectPool::ObjectPool(uint32_t initialSize) {
-    expiredOrders_.reserve(initialSize);
-    while (initialSize > 0) {
-        expiredOrders_.push_back(Order::createDummyOrder());
-        --initialSize;
-    }
+    arena_.reserve(arena_.liveCount() + initialSize);
 }
 
 void ObjectPool::release(OrderPointer order) {
-    expiredOrders_.push_back(order);
-    if (expiredOrders_.size() > 500) {
-        for (auto it = expiredOrders_.begin() + 250; it != expiredOrders_.end(); ++it) {
-            delete *it;
-        }
-        expiredOrders_.resize(250);
+    if (order->getHandle() == kInvalidOrderHandle) {
+        return;
+    }
+    if (order->getArenaId() == arena_.id()) {
+        arena_.release(order->getHandle());
+    } else {
+        staged.add(*order);
+    }
+}
+
+void ObjectPool::release(std::span<const OrderPointer> orders) {
+    for (OrderPointer order : orders) {
+        release(order);
     }
 }
 
+void ObjectPool::flushReleases() {
+    staged.flush();
+}
+
+void ObjectPool::release(OrderHandle handle) {
+    arena_.release(handle);
+}
+
 OrderPointer ObjectPool::allocate(OrderId orderId, OrderType orderType, OrderSide orderSide, 
                                   TimeInForce timeInForce, Price price, Quantity quantity) {
-    if (!expiredOrders_.empty()) {
-        OrderPointer newOrder = expiredOrders_.back();
-        expiredOrders_.pop_back();
-        newOrder->setOrderId(orderId);
-        newOrder->setOrderType(orderType);
-        newOrder->setOrderSide(orderSide);
-        newOrder->setTimeInForce(timeInForce);
-        newOrder->setPrice(price);
-        newOrder->setInitialQuantity(quantity);
-        newOrder->setRemainingQuantity(quantity);
-        newOrder->setOrderStatus(OrderStatus::New);
-        return newOrder;
-    } else {
-        return new Order{orderId, orderType, orderSide, timeInForce, price, quantity};
-    }
+    return resolve(allocateHandle(orderId, orderType, orderSide, timeInForce, price, quantity));
 }
 
-}
\ No newline at end of file
+OrderHandle ObjectPool::allocateHandle(OrderId orderId, OrderType orderType, OrderSide orderSide,
+                                       TimeInForce timeInForce, Price price, Quantity quantity) {
+    return arena_.allocate(orderId, orderType, orderSide, timeInForce, price, quantity);
+}
+
+}
@@ -1,30 +1,38 @@
 #pragma once
 
 #include "order.h"
+#include "order_arena.h"
+
+#include <span>
 
 namespace ob {
 
+// Source of Orders, backed by one OrderArena per thread so that allocation never contends: no
+// two threads share a free list. An order may be released on any thread. Releasing one from
+// another thread's arena stages it, and every kReturnBatch orders for that arena go back in one
+// lock-free push (see OrderArena). flushReleases() sends back a partial batch, e.g. when a thread
+// goes idle, and happens anyway when the thread exits. The allocating thread must outlive its
+// orders. Orders that were created elsewhere (e.g. with new) carry no handle; releasing one is a
+// no-op and it stays owned by whoever created it.
 class ObjectPool {
 public:
 
 ObjectPool(uint32_t initialSize = 10);
 
-~ObjectPool() {
-    clear();
-}
-
 static OrderPointer allocate(OrderId orderId, OrderType orderType, OrderSide orderSide, TimeInForce timeInForce, Price price, Quantity quantity);
+static OrderHandle allocateHandle(OrderId orderId, OrderType orderType, OrderSide orderSide, TimeInForce timeInForce, Price price, Quantity quantity);
 static void release(OrderPointer order);
+static void release(OrderHandle handle);   // handles only name orders of this thread's arena
+static void release(std::span<const OrderPointer> orders);
+static void flushReleases();
+
+static constexpr std::uint32_t kReturnBatch = 64;
+
+static OrderPointer resolve(OrderHandle handle) { return &arena_.get(handle); }
+static OrderArena& arena() { return arena_; }
 
 private:
-    inline static std::vector<OrderPointer> expiredOrders_;
-
-    void clear() {
-        for (auto ptr : expiredOrders_) {
-            delete ptr;
-        }
-        expiredOrders_.clear();
-    }
+    inline static thread_local OrderArena arena_;
 };
 
-} // namespace ob
\ No newline at end of file
+} // namespace ob
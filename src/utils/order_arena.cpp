@@ -0,0 +1,132 @@
+#include "order_arena.h"
+
+#include "order.h"
+
+#include <array>
+#include <format>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+namespace ob {
+
+namespace {
+
+// Arena ids are handed out here and reused once their arena is gone; lookups never lock
+std::array<std::atomic<OrderArena*>, OrderArena::kMaxArenas> arenas;
+std::mutex arenasMutex;
+
+} // namespace
+
+OrderArena::OrderArena(std::uint32_t initialCapacity) {
+    {
+        std::lock_guard lock(arenasMutex);
+        std::size_t id = 0;
+        while (id < kMaxArenas && arenas[id].load(std::memory_order_relaxed) != nullptr) {
+            ++id;
+        }
+        if (id == kMaxArenas) {
+            throw std::length_error(std::format("Cannot have more than {} OrderArenas at once", kMaxArenas));
+        }
+        id_ = static_cast<std::uint16_t>(id);
+        arenas[id].store(this, std::memory_order_release);
+    }
+    reserve(initialCapacity);
+}
+
+OrderArena::~OrderArena() {
+    {
+        std::lock_guard lock(arenasMutex);
+        arenas[id_].store(nullptr, std::memory_order_release);
+    }
+    for (void* block : blocks_) {
+        freeEngineMemory(block);
+    }
+}
+
+OrderArena* OrderArena::fromId(std::uint16_t id) {
+    return arenas[id].load(std::memory_order_acquire);
+}
+
+OrderHandle OrderArena::allocate(OrderId orderId, OrderType orderType, OrderSide orderSide,
+                                 TimeInForce timeInForce, Price price, Quantity quantity) {
+    // Orders other threads gave back are only picked up once the local free list is empty
+    if (freeHead_ == kInvalidOrderHandle && returned_.load(std::memory_order_relaxed) != kInvalidOrderHandle) {
+        freeHead_ = returned_.exchange(kInvalidOrderHandle, std::memory_order_acquire);
+    }
+
+    OrderHandle handle;
+    if (freeHead_ != kInvalidOrderHandle) {
+        handle = freeHead_;
+        freeHead_ = slotOf(handle).nextFree;
+    } else {
+        if (bumpCursor_ == capacity()) {
+            addSlabs(1);
+        }
+        handle = bumpCursor_++;
+    }
+
+    Order* order = std::construct_at(&slotOf(handle).order, orderId, orderType, orderSide, timeInForce, price, quantity);
+    order->setHandle(handle);
+    order->setArenaId(id_);
+    ++liveCount_;
+    return handle;
+}
+
+void OrderArena::release(OrderHandle handle) {
+    Slot& slot = slotOf(handle);
+    std::destroy_at(&slot.order);
+    slot.nextFree = freeHead_;
+    freeHead_ = handle;
+    --liveCount_;
+}
+
+void OrderArena::chainRelease(FreeChain& chain, Order& order) {
+    // The slot is found from the order's address, so the owner's slab table is never read here
+    OrderHandle handle = order.getHandle();
+    auto* slot = reinterpret_cast<Slot*>(&order);
+    std::destroy_at(&order);
+    slot->nextFree = chain.first;
+    if (chain.last == nullptr) {
+        chain.last = &slot->order;
+    }
+    chain.first = handle;
+    ++chain.count;
+}
+
+void OrderArena::returnChain(FreeChain& chain) {
+    if (chain.count == 0) {
+        return;
+    }
+    auto* last = reinterpret_cast<Slot*>(chain.last);
+    OrderHandle head = returned_.load(std::memory_order_relaxed);
+    do {
+        last->nextFree = head;
+    } while (!returned_.compare_exchange_weak(head, chain.first, std::memory_order_release, std::memory_order_relaxed));
+    returnedCount_.fetch_add(chain.count, std::memory_order_release);
+    chain = FreeChain{};
+}
+
+void OrderArena::reserve(std::uint32_t capacity) {
+    if (this->capacity() < capacity) {
+        addSlabs((capacity - this->capacity() + kSlabSize - 1) / kSlabSize);
+    }
+}
+
+void OrderArena::addSlabs(std::size_t count) {
+    constexpr std::size_t kMaxSlabs = (std::size_t{1} << (32 - kSlabBits)) - 1;
+    if (slabs_.size() + count > kMaxSlabs) {
+        throw std::length_error(std::format("OrderArena cannot grow past {} slabs", kMaxSlabs));
+    }
+    slabs_.reserve(slabs_.size() + count);
+    blocks_.reserve(blocks_.size() + 1);
+
+    auto* slots = static_cast<Slot*>(allocateEngineMemory(count * kSlabSize * sizeof(Slot)));
+    blocks_.push_back(slots);
+    std::uninitialized_default_construct_n(slots, count * kSlabSize);
+    for (std::size_t i = 0; i < count; ++i) {
+        slabs_.push_back(slots + i * kSlabSize);
+    }
+}
+
+} // namespace ob
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "engine_memory.h"
+#include "order.h"
+#include "thread_utils.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace ob {
+
+// Hands out Order slots from fixed-size contiguous slabs and names them by a 32-bit handle:
+// the high bits pick the slab and the low kSlabBits bits the slot within it. Slabs are only
+// ever added, so handles and Order addresses stay valid for the life of the arena, and released
+// slots go on an intrusive free list instead of back to the allocator. Slabs come from engine
+// memory (see engine_memory.h); reserve() takes all the slabs it adds as one block.
+//
+// An arena belongs to one thread. Other threads give its orders back in batches: they chain the
+// dead slots together through the same free-list links and push the whole chain onto the arena's
+// return stack with one compare-and-swap. The owner only looks at that stack once its own free
+// list runs dry, taking everything on it with a single exchange.
+class OrderArena {
+public:
+    static constexpr std::uint32_t kSlabBits = 12;
+    static constexpr std::uint32_t kSlabSize = 1u << kSlabBits; // orders per slab
+    static constexpr std::size_t kMaxArenas = 1024;              // alive at the same time
+
+    // Orders released on another thread, waiting to go back to their arena together
+    struct FreeChain {
+        OrderHandle first = kInvalidOrderHandle;
+        Order* last = nullptr;      // address of the slot the chain ends at
+        std::uint32_t count = 0;
+    };
+
+    OrderArena() : OrderArena(0) { }
+    explicit OrderArena(std::uint32_t initialCapacity);
+    ~OrderArena();
+
+    OrderArena(const OrderArena&) = delete;
+    OrderArena& operator=(const OrderArena&) = delete;
+
+    // Owner thread only
+    OrderHandle allocate(OrderId orderId, OrderType orderType, OrderSide orderSide, TimeInForce timeInForce, Price price, Quantity quantity);
+    void release(OrderHandle handle);
+
+    // Any thread: ends the order's life and puts its slot at the front of chain. Every order in
+    // a chain must come from the same arena.
+    static void chainRelease(FreeChain& chain, Order& order);
+    // Any thread: gives every slot in chain back to this arena and empties the chain
+    void returnChain(FreeChain& chain);
+
+    // The arena an order with this arena id came from, nullptr if it no longer exists
+    static OrderArena* fromId(std::uint16_t id);
+    std::uint16_t id() const { return id_; }
+
+    Order& get(OrderHandle handle) {
+        return slabs_[handle >> kSlabBits][handle & (kSlabSize - 1)].order;
+    }
+
+    // Grows the arena until at least capacity slots exist
+    void reserve(std::uint32_t capacity);
+
+    std::uint32_t capacity() const { return static_cast<std::uint32_t>(slabs_.size()) * kSlabSize; }
+    // Counts orders given back from other threads as soon as their chain has been returned
+    std::uint32_t liveCount() const { return liveCount_ - returnedCount_.load(std::memory_order_acquire); }
+    std::size_t slabCount() const { return slabs_.size(); }
+
+private:
+    union Slot {
+        Order order;
+        OrderHandle nextFree;
+
+        Slot() : nextFree { kInvalidOrderHandle } { }
+    };
+
+    std::vector<Slot*> slabs_;
+    std::vector<void*> blocks_;    // what the slabs were carved from
+    OrderHandle freeHead_ = kInvalidOrderHandle;
+    std::uint32_t bumpCursor_ = 0; // slots below this have been handed out at least once
+    std::uint32_t liveCount_ = 0;  // allocated minus released on the owner thread
+    std::uint16_t id_;
+
+    // Written by other threads, so kept off the owner's cache line
+    alignas(kCacheLineSize) std::atomic<OrderHandle> returned_ { kInvalidOrderHandle };
+    std::atomic<std::uint32_t> returnedCount_ { 0 };
+
+    Slot& slotOf(OrderHandle handle) {
+        return slabs_[handle >> kSlabBits][handle & (kSlabSize - 1)];
+    }
+
+    void addSlabs(std::size_t count);
+};
+
+} // namespace ob
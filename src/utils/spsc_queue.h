@@ -0,0 +1,67 @@
+#pragma once
+
+#include "thread_utils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <vector>
+
+namespace ob {
+
+// Bounded single-producer single-consumer ring buffer. Each side caches the other side's
+// index and only reloads it when the ring looks full (producer) or empty (consumer).
+template <typename T>
+class SpscQueue {
+public:
+    // capacity is rounded up to a power of two
+    explicit SpscQueue(std::size_t capacity)
+        : slots_(std::bit_ceil(std::max<std::size_t>(capacity, 2)))
+        , mask_ { slots_.size() - 1 }
+    { }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Producer only
+    bool tryPush(const T& item) {
+        std::size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cachedHead_ == slots_.size()) {
+            cachedHead_ = head_.load(std::memory_order_acquire);
+            if (tail - cachedHead_ == slots_.size()) {
+                return false;
+            }
+        }
+        slots_[tail & mask_] = item;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only
+    bool tryPop(T& item) {
+        std::size_t head = head_.load(std::memory_order_relaxed);
+        if (head == cachedTail_) {
+            cachedTail_ = tail_.load(std::memory_order_acquire);
+            if (head == cachedTail_) {
+                return false;
+            }
+        }
+        item = slots_[head & mask_];
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    std::size_t capacity() const { return slots_.size(); }
+
+private:
+    std::vector<T> slots_;
+    std::size_t mask_;
+
+    alignas(kCacheLineSize) std::atomic<std::size_t> head_ { 0 };   // next slot to pop
+    std::size_t cachedTail_ = 0;                                    // consumer's view of tail_
+    alignas(kCacheLineSize) std::atomic<std::size_t> tail_ { 0 };   // next slot to push
+    std::size_t cachedHead_ = 0;                                    // producer's view of head_
+};
+
+} // namespace ob
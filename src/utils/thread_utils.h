@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <thread>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace ob {
+
+inline constexpr std::size_t kCacheLineSize = 64;
+
+// Hint to the CPU that we are spinning on shared memory
+inline void cpuRelax() {
+#if defined(__x86_64__) || defined(_M_X64)
+    _mm_pause();
+#else
+    std::this_thread::yield();
+#endif
+}
+
+// Busy-poll back-off: spin for a while, then let other threads on the core run
+inline void backoff(unsigned& idleSpins) {
+    constexpr unsigned kSpinsBeforeYield = 1024;
+    if (++idleSpins < kSpinsBeforeYield) {
+        cpuRelax();
+    } else {
+        std::this_thread::yield();
+    }
+}
+
+// Pins the calling thread to one CPU, wrapping cpu around the machine's CPU count. Returns false,
+// leaving the thread where it was, where that is not supported or the CPU is not one the process
+// may run on (e.g. outside a taskset or cgroup cpuset).
+inline bool pinCurrentThread(unsigned cpu) {
+#ifdef __linux__
+    // hardware_concurrency may report 0 when it cannot tell
+    if (unsigned count = std::thread::hardware_concurrency(); count != 0) {
+        cpu %= count;
+    }
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0 || cpu >= CPU_SETSIZE || !CPU_ISSET(cpu, &allowed)) {
+        return false;
+    }
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu, &cpus);
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+} // namespace ob
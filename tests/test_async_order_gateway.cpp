@@ -0,0 +1,193 @@
+#include <catch2/catch_all.hpp>
+#include "async_order_gateway.h"
+#include "order.h"
+#include "order_events.h"
+#include "orderbook.h"
+#include "tradehistory.h"
+#include "utils/mpsc_queue.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace ob;
+
+static OrderRequest make_request(OrderId id, OrderSide side, TimeInForce tif, Price price, Quantity qty) {
+    return OrderRequest{id, 0, OrderType::Limit, side, tif, price, qty};
+}
+
+static std::vector<OrderResult> poll_responses(AsyncOrderGateway<>& gateway, std::size_t count) {
+    std::vector<OrderResult> results;
+    OrderResult result;
+    while (results.size() < count) {
+        if (gateway.pollResponse(result)) {
+            results.push_back(result);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    return results;
+}
+
+TEST_CASE("MpscQueue keeps each producer's items in order") {
+    MpscQueue<std::uint64_t> queue(8);
+    REQUIRE(queue.capacity() == 8);
+
+    constexpr std::uint64_t kPerProducer = 10000;
+    std::vector<std::thread> producers;
+    for (std::uint64_t p = 0; p < 3; ++p) {
+        producers.emplace_back([&queue, p] {
+            for (std::uint64_t i = 0; i < kPerProducer; ++i) {
+                while (!queue.tryPush(p * kPerProducer + i)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    std::vector<std::uint64_t> next(3, 0);
+    std::uint64_t item;
+    for (std::uint64_t popped = 0; popped < 3 * kPerProducer; ) {
+        if (queue.tryPop(item)) {
+            std::uint64_t producer = item / kPerProducer;
+            REQUIRE(item % kPerProducer == next[producer]++);
+            ++popped;
+        }
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    REQUIRE_FALSE(queue.tryPop(item));
+}
+
+TEST_CASE("AsyncOrderGateway rejects invalid orders on the calling thread") {
+    AsyncOrderGateway<> gateway(std::make_unique<OrderBook>(), std::make_unique<RingTradeHistory>(16));
+
+    OrderResult result = gateway.submitOrder(make_request(1, OrderSide::Buy, TimeInForce::GoodTillCancel, 100, 0));
+    REQUIRE_FALSE(result.accepted);
+    REQUIRE(result.reason == OrderRejectionReason::InvalidQuantity);
+
+    // Not started yet, so nothing can be on the response ring
+    OrderResult response;
+    REQUIRE_FALSE(gateway.pollResponse(response));
+}
+
+TEST_CASE("AsyncOrderGateway reports the outcome of each accepted request on the response ring") {
+    AsyncOrderGateway<> gateway(std::make_unique<OrderBook>(), std::make_unique<RingTradeHistory>(16));
+    gateway.start();
+
+    REQUIRE(gateway.submitOrder(make_request(1, OrderSide::Sell, TimeInForce::GoodTillCancel, 100, 10)).accepted);
+    REQUIRE(gateway.submitOrder(make_request(2, OrderSide::Buy, TimeInForce::FillOrKill, 100, 20)).accepted);
+    REQUIRE(gateway.submitOrder(make_request(3, OrderSide::Buy, TimeInForce::ImmediateOrCancel, 100, 4)).accepted);
+    REQUIRE(gateway.cancelOrder(1).accepted);
+
+    auto results = poll_responses(gateway, 4);
+    REQUIRE(results[0].id == 1);
+    REQUIRE(results[0].accepted);
+    REQUIRE(results[1].id == 2);
+    REQUIRE(results[1].reason == OrderRejectionReason::InsufficientLiquidity);
+    REQUIRE(results[2].accepted);
+    REQUIRE(results[3].id == 1);
+
+    REQUIRE(gateway.getBook().getOrders().empty());
+    REQUIRE(gateway.getHistory().size() == 1);
+    REQUIRE(gateway.getHistory()[0].tradeQuantity_ == 4);
+
+    gateway.stop();
+    REQUIRE(gateway.submitOrder(make_request(4, OrderSide::Buy, TimeInForce::GoodTillCancel, 100, 1)).reason == OrderRejectionReason::Other);
+}
+
+TEST_CASE("AsyncOrderGateway accepts orders from several producer threads") {
+    AsyncOrderGateway<> gateway(std::make_unique<OrderBook>(), std::make_unique<RingTradeHistory>(16),
+                                {.ingressCapacity = 64, .responseCapacity = 64});
+    gateway.start();
+
+    constexpr OrderId kPerProducer = 500;
+    std::vector<std::thread> producers;
+    for (OrderId p = 0; p < 4; ++p) {
+        producers.emplace_back([&gateway, p] {
+            for (OrderId i = 0; i < kPerProducer; ++i) {
+                // Buys below sells, so nothing crosses and every order rests
+                OrderSide side = (p % 2 == 0) ? OrderSide::Buy : OrderSide::Sell;
+                Price price = (side == OrderSide::Buy) ? 100 : 200;
+                gateway.submitOrder(make_request(p * kPerProducer + i + 1, side, TimeInForce::GoodTillCancel, price, 1));
+            }
+        });
+    }
+
+    // Drain while the producers run, the response ring is smaller than the number of orders
+    auto results = poll_responses(gateway, 4 * kPerProducer);
+    for (auto& producer : producers) {
+        producer.join();
+    }
+
+    REQUIRE(results.size() == 4 * kPerProducer);
+    REQUIRE(gateway.getBook().getOrders().size() == 4 * kPerProducer);
+    REQUIRE(gateway.getHistory().empty());
+    gateway.stop();
+}
+
+TEST_CASE("AsyncOrderGateway stops even when nobody polls its responses") {
+    AsyncOrderGateway<> gateway(std::make_unique<OrderBook>(), std::make_unique<RingTradeHistory>(16),
+                                {.ingressCapacity = 16, .responseCapacity = 4});
+    gateway.start();
+    for (OrderId id = 1; id <= 10; ++id) {
+        REQUIRE(gateway.submitOrder(make_request(id, OrderSide::Buy, TimeInForce::GoodTillCancel, 100, 1)).accepted);
+    }
+    gateway.stop();
+
+    // Whatever did not fit on the ring is counted instead of blocking the matching thread
+    auto results = poll_responses(gateway, 4);
+    REQUIRE(results.front().id == 1);
+    REQUIRE(gateway.getDroppedResponses() == 6);
+
+    REQUIRE_FALSE(gateway.cancelOrder(1).accepted);
+    REQUIRE_FALSE(gateway.advanceTime(1000));
+    REQUIRE_FALSE(gateway.setSessionEnd(2000));
+}
+
+TEST_CASE("AsyncOrderGateway answers every request accepted before stop") {
+    AsyncOrderGateway<> gateway(std::make_unique<OrderBook>(), std::make_unique<RingTradeHistory>(16),
+                                {.ingressCapacity = 8, .responseCapacity = 1 << 14});
+    gateway.start();
+
+    constexpr OrderId kPerProducer = 2000;
+    std::atomic<std::uint64_t> accepted { 0 };
+    std::vector<std::thread> producers;
+    for (OrderId p = 0; p < 4; ++p) {
+        producers.emplace_back([&gateway, &accepted, p] {
+            for (OrderId i = 0; i < kPerProducer; ++i) {
+                if (gateway.submitOrder(make_request(p * kPerProducer + i + 1, OrderSide::Buy, TimeInForce::GoodTillCancel, 100, 1)).accepted) {
+                    ++accepted;
+                }
+            }
+        });
+    }
+    std::this_thread::yield();
+    gateway.stop();
+    for (auto& producer : producers) {
+        producer.join();
+    }
+
+    // Nothing accepted slipped in behind the final drain
+    std::uint64_t answered = 0;
+    OrderResult result;
+    while (gateway.pollResponse(result)) {
+        ++answered;
+    }
+    REQUIRE(gateway.getDroppedResponses() == 0);
+    REQUIRE(answered == accepted.load());
+}
+
+TEST_CASE("AsyncOrderGateway checks prices without the book, which stop() frees") {
+    AsyncOrderGateway<LadderOrderBook> gateway(std::make_unique<LadderOrderBook>(PriceBand{50, 150, 5}),
+                                               std::make_unique<RingTradeHistory>(16));
+    gateway.start();
+    REQUIRE(gateway.submitOrder(make_request(1, OrderSide::Buy, TimeInForce::GoodTillCancel, 101, 1)).reason == OrderRejectionReason::InvalidPrice);
+    REQUIRE(gateway.submitOrder(make_request(2, OrderSide::Buy, TimeInForce::GoodTillCancel, 100, 1)).accepted);
+    gateway.stop();
+
+    REQUIRE(gateway.submitOrder(make_request(3, OrderSide::Buy, TimeInForce::GoodTillCancel, 100, 1)).reason == OrderRejectionReason::Other);
+    REQUIRE(gateway.cancelOrder(2).reason == OrderRejectionReason::Other);
+}
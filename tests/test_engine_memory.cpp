@@ -0,0 +1,69 @@
+#include <catch2/catch_all.hpp>
+#include "execution_report.h"
+#include "orderbook.h"
+#include "utils/engine_memory.h"
+#include "utils/order_arena.h"
+
+#include <cstdint>
+
+using namespace ob;
+
+// Puts the previous configuration back however the test ends
+struct ScopedMemoryConfig {
+    MemoryConfig previous = memoryConfig();
+    explicit ScopedMemoryConfig(const MemoryConfig& config) { configureMemory(config); }
+    ~ScopedMemoryConfig() { configureMemory(previous); }
+};
+
+TEST_CASE("Engine memory stays on the heap unless huge pages are asked for") {
+    MemoryFootprint before = memoryFootprint();
+    {
+        RingExecutionSink sink(1 << 16);
+        REQUIRE(memoryFootprint().heapBytes > before.heapBytes);
+        REQUIRE(memoryFootprint().mappedBytes == before.mappedBytes);
+    }
+    REQUIRE(memoryFootprint().heapBytes == before.heapBytes);
+}
+
+TEST_CASE("Large engine buffers are mapped in whole, aligned huge pages") {
+    ScopedMemoryConfig scoped({ HugePages::Transparent, true, true, 64 * 1024 });
+    MemoryFootprint before = memoryFootprint();
+    {
+        OrderArena arena(8 * OrderArena::kSlabSize);
+        LadderOrderBook book{PriceBand{1, 100'000, 1}, 1 << 16};
+        RingExecutionSink sink(1 << 16);
+
+        MemoryFootprint during = memoryFootprint();
+        REQUIRE(during.mappings > before.mappings);
+        REQUIRE(during.mappedBytes > before.mappedBytes);
+        REQUIRE((during.mappedBytes - before.mappedBytes) % kHugePageSize == 0);
+        REQUIRE(during.lockedBytes + during.lockFailures > before.lockedBytes + before.lockFailures);
+
+        // The reservation is one block, so the slabs sit back to back
+        OrderHandle first = arena.allocate(1, OrderType::Limit, OrderSide::Buy, TimeInForce::GoodTillCancel, 100, 10);
+        REQUIRE(arena.slabCount() == 8);
+        REQUIRE(&arena.get(first) + OrderArena::kSlabSize == &arena.get(first + OrderArena::kSlabSize));
+        REQUIRE(reinterpret_cast<std::uintptr_t>(&arena.get(first)) % 64 == 0);
+
+        arena.release(first);
+    }
+    MemoryFootprint after = memoryFootprint();
+    REQUIRE(after.mappedBytes == before.mappedBytes);
+    REQUIRE(after.lockedBytes == before.lockedBytes);
+    REQUIRE(after.mappings == before.mappings);
+}
+
+TEST_CASE("Explicit huge pages fall back when none are reserved") {
+    ScopedMemoryConfig scoped({ HugePages::Explicit, false, false, 64 * 1024 });
+    MemoryFootprint before = memoryFootprint();
+
+    void* memory = allocateEngineMemory(1 << 20);
+    MemoryFootprint during = memoryFootprint();
+    // Either the pool had pages or the mapping went transparent; both are mapped
+    REQUIRE(during.mappedBytes - before.mappedBytes == kHugePageSize);
+    bool huge = during.hugePageBytes - before.hugePageBytes == kHugePageSize;
+    bool fellBack = during.hugePageFallbacks - before.hugePageFallbacks == 1;
+    REQUIRE(huge != fellBack);
+    freeEngineMemory(memory);
+    REQUIRE(memoryFootprint().mappedBytes == before.mappedBytes);
+}
@@ -0,0 +1,127 @@
+#include <catch2/catch_all.hpp>
+#include "execution_report.h"
+#include "matching_engine.h"
+#include "order.h"
+#include "orderbook.h"
+#include "utils/object_pool.h"
+
+#include <vector>
+
+using namespace ob;
+
+using ReportingEngine = BasicMatchingEngine<OrderBook, RingExecutionSink>;
+
+static OrderPointer make_order(OrderId id, OrderSide side, Price price, Quantity qty,
+                               TimeInForce tif = TimeInForce::GoodTillCancel, OrderType type = OrderType::Limit) {
+    return ObjectPool::allocate(id, type, side, tif, price, qty);
+}
+
+static std::vector<ExecutionReport> drain(RingExecutionSink& sink) {
+    std::vector<ExecutionReport> reports;
+    auto [first, second] = sink.getReports();
+    reports.insert(reports.end(), first.begin(), first.end());
+    reports.insert(reports.end(), second.begin(), second.end());
+    sink.clear();
+    return reports;
+}
+
+TEST_CASE("A fill is reported for both orders, incoming order first") {
+    OrderBook book; RingExecutionSink sink(64); ReportingEngine engine(book, sink);
+
+    engine.onNewOrder(make_order(1, OrderSide::Sell, 100, 10));
+    engine.onNewOrder(make_order(2, OrderSide::Buy, 101, 4));
+    std::vector<ExecutionReport> reports = drain(sink);
+
+    REQUIRE(reports.size() == 4);
+    REQUIRE(reports[0].type == ExecutionType::Accepted);
+    REQUIRE(reports[0].leavesQuantity == 10);
+    REQUIRE(reports[1].type == ExecutionType::Accepted);
+    REQUIRE(reports[1].orderId == 2);
+
+    REQUIRE(reports[2].orderId == 2);
+    REQUIRE(reports[2].type == ExecutionType::Filled);
+    REQUIRE(reports[2].counterOrderId == 1);
+    REQUIRE(reports[2].price == 100);
+    REQUIRE(reports[2].quantity == 4);
+    REQUIRE(reports[2].leavesQuantity == 0);
+    REQUIRE(reports[3].orderId == 1);
+    REQUIRE(reports[3].type == ExecutionType::PartiallyFilled);
+    REQUIRE(reports[3].getOrderSide() == OrderSide::Sell);
+    REQUIRE(reports[3].leavesQuantity == 6);
+}
+
+TEST_CASE("Leftovers, cancels and amends are reported") {
+    OrderBook book; RingExecutionSink sink(64); ReportingEngine engine(book, sink);
+
+    engine.onNewOrder(make_order(1, OrderSide::Sell, 100, 10));
+    engine.onNewOrder(make_order(2, OrderSide::Buy, 100, 15, TimeInForce::ImmediateOrCancel));
+    std::vector<ExecutionReport> reports = drain(sink);
+    REQUIRE(reports.size() == 5);
+    REQUIRE(reports[2].type == ExecutionType::PartiallyFilled);
+    REQUIRE(reports[4].orderId == 2);
+    REQUIRE(reports[4].type == ExecutionType::Cancelled);
+    REQUIRE(reports[4].quantity == 5);
+    REQUIRE(reports[4].leavesQuantity == 0);
+
+    engine.onNewOrder(make_order(3, OrderSide::Buy, 90, 20));
+    engine.onAmendOrder(3, 91, 12);
+    engine.onCancelOrder(3);
+    engine.onCancelOrder(3); // gone already, so nothing to report
+    reports = drain(sink);
+    REQUIRE(reports.size() == 3);
+    REQUIRE(reports[1].type == ExecutionType::Replaced);
+    REQUIRE(reports[1].price == 91);
+    REQUIRE(reports[1].leavesQuantity == 12);
+    REQUIRE(reports[2].type == ExecutionType::Cancelled);
+    REQUIRE(reports[2].quantity == 12);
+}
+
+TEST_CASE("Orders the engine cannot take are reported as rejected") {
+    OrderBook book; RingExecutionSink sink(64); ReportingEngine engine(book, sink);
+
+    OrderPointer order = make_order(1, OrderSide::Buy, 100, 10, static_cast<TimeInForce>(7));
+    REQUIRE(engine.onNewOrder(order) == OrderError::UnsupportedTimeInForce);
+    ObjectPool::release(order);
+
+    REQUIRE(sink.size() == 1);
+    REQUIRE(sink[0].type == ExecutionType::Rejected);
+    REQUIRE(sink[0].reason == OrderError::UnsupportedTimeInForce);
+}
+
+TEST_CASE("Dormant stops are reported when accepted and when cancelled") {
+    OrderBook book; RingExecutionSink sink(64); ReportingEngine engine(book, sink);
+
+    OrderPointer stop = make_order(1, OrderSide::Sell, 1, 5, TimeInForce::GoodTillCancel, OrderType::Stop);
+    stop->setStopPrice(90);
+    engine.onNewOrder(stop);
+    engine.onCancelOrder(1);
+
+    std::vector<ExecutionReport> reports = drain(sink);
+    REQUIRE(reports.size() == 2);
+    REQUIRE(reports[0].type == ExecutionType::Accepted);
+    REQUIRE(reports[1].type == ExecutionType::Cancelled);
+    REQUIRE(reports[1].quantity == 5);
+    REQUIRE(book.getStops().empty());
+}
+
+TEST_CASE("The ring sink keeps the most recent reports") {
+    RingExecutionSink sink(3);
+    REQUIRE(sink.capacity() == 4);
+    for (OrderId id = 1; id <= 6; ++id) {
+        sink.onExecution({ id, 0, 100, 1, 0, 0, ExecutionType::Accepted, 0, OrderError::None, 0 });
+    }
+    REQUIRE(sink.size() == 4);
+    REQUIRE(sink.totalRecorded() == 6);
+    REQUIRE(sink[0].orderId == 3);
+    auto [first, second] = sink.getReports();
+    REQUIRE(first.size() + second.size() == 4);
+    REQUIRE(second.back().orderId == 6);
+}
+
+TEST_CASE("An engine with the null sink still matches") {
+    OrderBook book; NullExecutionSink sink; BasicMatchingEngine<OrderBook, NullExecutionSink> engine(book, sink);
+
+    engine.onNewOrder(make_order(1, OrderSide::Sell, 100, 10));
+    engine.onNewOrder(make_order(2, OrderSide::Buy, 100, 10));
+    REQUIRE(book.getOrders().empty());
+}
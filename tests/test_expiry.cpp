@@ -0,0 +1,292 @@
+#include <catch2/catch_all.hpp>
+#include "execution_report.h"
+#include "expiry_wheel.h"
+#include "journal.h"
+#include "matching_engine.h"
+#include "order.h"
+#include "order_gateway.h"
+#include "orderbook.h"
+#include "snapshot.h"
+#include "tradehistory.h"
+#include "utils/object_pool.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace ob;
+
+static OrderPointer make_order(OrderId id, OrderSide side, Price price, Quantity qty,
+                               TimeInForce tif = TimeInForce::GoodTillDate, Timestamp expireTime = 0) {
+    OrderPointer order = ObjectPool::allocate(id, OrderType::Limit, side, tif, price, qty);
+    order->setExpireTime(expireTime);
+    return order;
+}
+
+TEST_CASE("Expiry wheel hands orders back when the clock reaches them, earliest first") {
+    ObjectPool pool(4096);
+    ExpiryWheel wheel;
+    std::mt19937_64 rng(11);
+
+    // Expiries spread over many levels, some sharing a time
+    std::vector<OrderPointer> orders;
+    for (OrderId id = 0; id < 2000; ++id) {
+        Timestamp expireTime = 1 + rng() % (id % 2 == 0 ? 5000 : 1'000'000'000);
+        orders.push_back(make_order(id, OrderSide::Buy, 100, 1, TimeInForce::GoodTillDate, id % 7 == 0 ? 1234 : expireTime));
+        wheel.schedule(orders.back());
+    }
+    REQUIRE(wheel.size() == orders.size());
+
+    OrderPointers expired;
+    Timestamp now = 0;
+    while (!wheel.empty()) {
+        Timestamp previous = now;
+        now += 1 + rng() % 20'000'000;
+        std::size_t before = expired.size();
+        REQUIRE(wheel.advance(now, expired));
+        for (std::size_t i = before; i < expired.size(); ++i) {
+            REQUIRE(expired[i]->getExpireTime() <= now);
+            REQUIRE(expired[i]->getExpireTime() > previous);
+            REQUIRE_FALSE(expired[i]->isScheduledToExpire());
+            if (i > 0) {
+                REQUIRE(expired[i - 1]->getExpireTime() <= expired[i]->getExpireTime());
+            }
+        }
+    }
+    REQUIRE(expired.size() == orders.size());
+    REQUIRE(wheel.now() == now);
+
+    for (OrderPointer order : orders) {
+        ObjectPool::release(order);
+    }
+}
+
+TEST_CASE("Expiry wheel cancels, reschedules and stops at a limit") {
+    ObjectPool pool(16);
+    ExpiryWheel wheel;
+    OrderPointer a = make_order(1, OrderSide::Buy, 100, 1, TimeInForce::GoodTillDate, 100);
+    OrderPointer b = make_order(2, OrderSide::Buy, 100, 1, TimeInForce::GoodTillDate, 100);
+    OrderPointer c = make_order(3, OrderSide::Buy, 100, 1, TimeInForce::GoodTillDate, 100);
+    OrderPointer d = make_order(4, OrderSide::Buy, 100, 1, TimeInForce::GoodTillDate, 5000);
+    for (OrderPointer order : { a, b, c, d }) {
+        wheel.schedule(order);
+    }
+
+    wheel.cancel(b);
+    wheel.cancel(b);
+    REQUIRE(wheel.size() == 3);
+    d->setExpireTime(50);
+    wheel.schedule(d);
+    REQUIRE(wheel.size() == 3);
+
+    OrderPointers expired;
+    REQUIRE(wheel.advance(99, expired));
+    REQUIRE(expired == OrderPointers{ d });
+
+    // Two due at 100, one taken per call
+    expired.clear();
+    REQUIRE_FALSE(wheel.advance(1000, expired, 1));
+    REQUIRE(expired == OrderPointers{ a });
+    REQUIRE(wheel.now() == 100);
+    REQUIRE(wheel.advance(1000, expired, 1));
+    REQUIRE(expired == OrderPointers{ a, c });
+    REQUIRE(wheel.now() == 1000);
+    REQUIRE(wheel.empty());
+
+    // Already due: goes on the next advance, even one that does not move the clock
+    b->setExpireTime(10);
+    wheel.schedule(b);
+    expired.clear();
+    REQUIRE(wheel.advance(1000, expired));
+    REQUIRE(expired == OrderPointers{ b });
+
+    for (OrderPointer order : { a, b, c, d }) {
+        ObjectPool::release(order);
+    }
+}
+
+TEST_CASE("Good-till-date orders rest until the engine clock reaches their expiry") {
+    OrderBook book; RingExecutionSink sink(64); BasicMatchingEngine<OrderBook, RingExecutionSink> engine(book, sink);
+    engine.advanceTime(1000);
+
+    REQUIRE(engine.onNewOrder(make_order(1, OrderSide::Buy, 100, 10, TimeInForce::GoodTillDate, 2000)) == OrderError::None);
+    REQUIRE(engine.onNewOrder(make_order(2, OrderSide::Buy, 99, 10, TimeInForce::GoodTillDate, 3000)) == OrderError::None);
+    REQUIRE(engine.onNewOrder(make_order(3, OrderSide::Buy, 98, 10, TimeInForce::GoodTillCancel)) == OrderError::None);
+    REQUIRE(book.getExpiries().size() == 2);
+
+    // Partly filled, it still expires; fully filled or cancelled, it leaves the wheel
+    engine.onNewOrder(make_order(4, OrderSide::Sell, 100, 4, TimeInForce::ImmediateOrCancel));
+    REQUIRE(engine.onNewOrder(make_order(5, OrderSide::Sell, 120, 10, TimeInForce::GoodTillDate, 2500)) == OrderError::None);
+    engine.onCancelOrder(5);
+    REQUIRE(book.getExpiries().size() == 2);
+    sink.clear();
+
+    REQUIRE(engine.advanceTime(1999) == 0);
+    REQUIRE(engine.advanceTime(2000) == 1);
+    REQUIRE(book.getOrders().find(1) == book.getOrders().end());
+    REQUIRE(book.getBuyOrders().begin()->first == 99);
+    REQUIRE(book.getBuyDepth()[0].price == 99);
+    REQUIRE(sink.size() == 1);
+    REQUIRE(sink[0].type == ExecutionType::Cancelled);
+    REQUIRE(sink[0].orderId == 1);
+    REQUIRE(sink[0].quantity == 6);
+
+    // The clock never goes back
+    REQUIRE(engine.advanceTime(1500) == 0);
+    REQUIRE(engine.getTime() == 2000);
+    REQUIRE(engine.advanceTime(1'000'000) == 1);
+    REQUIRE(book.getOrders().size() == 1);
+    REQUIRE(book.getExpiries().empty());
+}
+
+TEST_CASE("Expired or unsupported expiries are rejected") {
+    OrderBook book; TradeHistory history; MatchingEngine engine(book, history); OrderGateway gateway(engine);
+    gateway.advanceTime(1000);
+
+    OrderPointer stale = make_order(1, OrderSide::Buy, 100, 10, TimeInForce::GoodTillDate, 1000);
+    REQUIRE(gateway.submitOrder(stale).reason == OrderRejectionReason::InvalidExpiry);
+    OrderPointer day = make_order(2, OrderSide::Buy, 100, 10, TimeInForce::Day);
+    REQUIRE(gateway.submitOrder(day).reason == OrderRejectionReason::InvalidExpiry);
+
+    // Only GoodTillDate carries an expire time, and stops never expire
+    OrderPointer noExpiry = make_order(3, OrderSide::Buy, 100, 10, TimeInForce::GoodTillDate, 0);
+    REQUIRE(gateway.submitOrder(noExpiry).reason == OrderRejectionReason::InvalidTIF);
+    OrderPointer gtcWithExpiry = make_order(4, OrderSide::Buy, 100, 10, TimeInForce::GoodTillCancel, 5000);
+    REQUIRE(gateway.submitOrder(gtcWithExpiry).reason == OrderRejectionReason::InvalidTIF);
+    OrderPointer stop = make_order(5, OrderSide::Buy, 100, 10, TimeInForce::GoodTillDate, 5000);
+    stop->setOrderType(OrderType::StopLimit);
+    stop->setStopPrice(99);
+    REQUIRE(gateway.submitOrder(stop).reason == OrderRejectionReason::InvalidTIF);
+    REQUIRE(engine.onNewOrder(stop) == OrderError::UnsupportedTimeInForce);
+
+    REQUIRE(book.getOrders().size() == 0);
+    for (OrderPointer order : { stale, day, noExpiry, gtcWithExpiry, stop }) {
+        ObjectPool::release(order);
+    }
+}
+
+TEST_CASE("Day orders expire at the session end, amended or not") {
+    OrderBook book; TradeHistory history; MatchingEngine engine(book, history);
+    engine.setSessionEnd(10'000);
+
+    engine.onNewOrder(make_order(1, OrderSide::Buy, 100, 10, TimeInForce::Day));
+    engine.onNewOrder(make_order(2, OrderSide::Sell, 105, 10, TimeInForce::Day));
+    engine.onNewOrder(make_order(3, OrderSide::Sell, 106, 10, TimeInForce::GoodTillCancel));
+    REQUIRE(book.getOrders().find(1)->second->getExpireTime() == 10'000);
+
+    // A new price moves the order but keeps its expiry
+    REQUIRE(engine.onAmendOrder(1, 101, 8) == OrderError::None);
+    REQUIRE(engine.onAmendOrder(2, 104, 5) == OrderError::None);
+    REQUIRE(book.getExpiries().size() == 2);
+
+    engine.setSessionEnd(20'000);
+    REQUIRE(engine.advanceTime(10'000) == 2);
+    REQUIRE(book.getOrders().size() == 1);
+    REQUIRE(book.getBuyOrders().empty());
+}
+
+TEST_CASE("Journal replay and snapshots keep expiries") {
+    auto journalPath = (std::filesystem::temp_directory_path() / "orderbook_expiry.journal").string();
+    auto snapshotPath = (std::filesystem::temp_directory_path() / "orderbook_expiry.snapshot").string();
+    std::filesystem::remove(journalPath);
+
+    OrderBook book; TradeHistory history; MatchingEngine engine(book, history); OrderGateway gateway(engine);
+    {
+        JournalWriter journal(journalPath);
+        gateway.setJournal(&journal);
+        gateway.setSessionEnd(50'000);
+        std::mt19937 rng(3);
+        for (OrderId id = 1; id <= 500; ++id) {
+            OrderSide side = id % 2 == 0 ? OrderSide::Buy : OrderSide::Sell;
+            Price price = side == OrderSide::Buy ? 90 + rng() % 10 : 101 + rng() % 10;
+            TimeInForce tif = id % 3 == 0 ? TimeInForce::Day : id % 3 == 1 ? TimeInForce::GoodTillDate : TimeInForce::GoodTillCancel;
+            Timestamp expireTime = tif == TimeInForce::GoodTillDate ? id * 100 + rng() % 100'000 : 0;
+            gateway.submitOrder(make_order(id, side, price, 1 + rng() % 20, tif, expireTime));
+            if (id % 50 == 0) {
+                gateway.advanceTime(id * 100);
+            }
+        }
+        gateway.setJournal(nullptr);
+    }
+
+    OrderBook replayedBook; TradeHistory replayedHistory; MatchingEngine replayEngine(replayedBook, replayedHistory);
+    JournalReader reader(journalPath);
+    replayJournal(reader, replayEngine);
+    REQUIRE(replayedBook.getOrders().size() == book.getOrders().size());
+    REQUIRE(replayedBook.getExpiries().size() == book.getExpiries().size());
+    REQUIRE(replayEngine.getTime() == engine.getTime());
+
+    writeSnapshot(book, snapshotPath, 0, engine.getSessionEnd());
+    OrderBook restored;
+    loadSnapshot(restored, snapshotPath);
+    REQUIRE(restored.getExpiries().size() == book.getExpiries().size());
+    for (const auto& [id, order] : book.getOrders()) {
+        REQUIRE(restored.getOrders().find(id)->second->getExpireTime() == order->getExpireTime());
+    }
+
+    // The same orders expire on both
+    REQUIRE(engine.advanceTime(60'000) > 0);
+    replayEngine.advanceTime(60'000);
+    REQUIRE(replayedBook.getOrders().size() == book.getOrders().size());
+    auto stillExpiring = std::count_if(book.getOrders().begin(), book.getOrders().end(),
+                                       [](const auto& entry) { return entry.second->getExpireTime() > 60'000; });
+    REQUIRE(book.getExpiries().size() == static_cast<std::size_t>(stillExpiring));
+
+    std::filesystem::remove(journalPath);
+    std::filesystem::remove(snapshotPath);
+}
+
+TEST_CASE("Snapshot plus journal tail restores the clock and session end") {
+    auto journalPath = (std::filesystem::temp_directory_path() / "orderbook_expiry_tail.journal").string();
+    auto snapshotPath = (std::filesystem::temp_directory_path() / "orderbook_expiry_tail.snapshot").string();
+    std::filesystem::remove(journalPath);
+
+    OrderBook book; TradeHistory history; MatchingEngine engine(book, history); OrderGateway gateway(engine);
+    {
+        JournalWriter journal(journalPath);
+        gateway.setJournal(&journal);
+        gateway.setSessionEnd(50'000);
+        gateway.advanceTime(10'000);
+        gateway.submitOrder(make_order(1, OrderSide::Buy, 100, 10, TimeInForce::GoodTillDate, 20'000));
+        gateway.submitOrder(make_order(2, OrderSide::Sell, 110, 10, TimeInForce::Day));
+        writeSnapshot(book, snapshotPath, journal.lastSequence(), engine.getSessionEnd());
+
+        // The tail: one already expired, one taking the session end, then the clock moves on
+        gateway.submitOrder(make_order(3, OrderSide::Buy, 99, 10, TimeInForce::GoodTillDate, 5'000));
+        gateway.submitOrder(make_order(4, OrderSide::Buy, 98, 10, TimeInForce::Day));
+        gateway.submitOrder(make_order(5, OrderSide::Sell, 111, 10, TimeInForce::GoodTillDate, 30'000));
+        gateway.advanceTime(25'000);
+        gateway.setJournal(nullptr);
+    }
+    REQUIRE(book.getOrders().size() == 3);
+
+    OrderBook restored; TradeHistory restoredHistory; MatchingEngine restoredEngine(restored, restoredHistory);
+    SnapshotInfo info = loadSnapshot(restored, snapshotPath);
+    REQUIRE(info.time == 10'000);
+    REQUIRE(info.sessionEnd == 50'000);
+    REQUIRE(restoredEngine.getTime() == 10'000);
+    restoredEngine.setSessionEnd(info.sessionEnd);
+
+    JournalReader reader(journalPath);
+    reader.skip(info.journalSequence);
+    replayJournal(reader, restoredEngine);
+
+    REQUIRE(restoredEngine.getTime() == engine.getTime());
+    REQUIRE(restored.getOrders().size() == book.getOrders().size());
+    for (const auto& [id, order] : book.getOrders()) {
+        auto it = restored.getOrders().find(id);
+        REQUIRE(it != restored.getOrders().end());
+        REQUIRE(it->second->getExpireTime() == order->getExpireTime());
+    }
+    REQUIRE(restored.getOrders().find(3) == restored.getOrders().end());
+    REQUIRE(restored.getExpiries().size() == book.getExpiries().size());
+
+    // Both expire the rest at the same time
+    REQUIRE(restoredEngine.advanceTime(50'000) == engine.advanceTime(50'000));
+    REQUIRE(restored.getOrders().empty());
+
+    std::filesystem::remove(journalPath);
+    std::filesystem::remove(snapshotPath);
+}
@@ -0,0 +1,91 @@
+#include <catch2/catch_all.hpp>
+
+#include "utils/flat_hash_map.h"
+
+#include <random>
+#include <unordered_map>
+
+using namespace ob;
+
+using IdMap = FlatHashMap<std::uint64_t, std::uint64_t>;
+
+// Sends every key to the same home slot so every entry shares one probe run
+struct CollidingHash {
+    std::size_t operator()(std::uint64_t) const { return 0; }
+};
+
+TEST_CASE("FlatHashMap inserts, finds and erases") {
+    IdMap map(4);
+
+    REQUIRE(map.emplace(1, 100).second);
+    REQUIRE(map.emplace(2, 200).second);
+    REQUIRE_FALSE(map.emplace(1, 999).second); // existing entry is kept
+    REQUIRE(map.size() == 2);
+    REQUIRE(map.find(1)->second == 100);
+    REQUIRE(map.find(3) == map.end());
+
+    REQUIRE(map.erase(1) == 1);
+    REQUIRE(map.erase(1) == 0);
+    REQUIRE_FALSE(map.contains(1));
+    REQUIRE(map.find(2)->second == 200);
+    REQUIRE(map.size() == 1);
+}
+
+TEST_CASE("FlatHashMap erase keeps later entries of the probe run reachable") {
+    FlatHashMap<std::uint64_t, std::uint64_t, 0, CollidingHash> map(16);
+    for (std::uint64_t key = 0; key < 10; ++key) {
+        map.emplace(key, key + 1);
+    }
+
+    map.erase(map.find(3));
+    map.erase(0);
+    map.erase(9);
+
+    for (std::uint64_t key = 0; key < 10; ++key) {
+        bool erased = key == 0 || key == 3 || key == 9;
+        REQUIRE(map.contains(key) == !erased);
+    }
+    REQUIRE(map.size() == 7);
+}
+
+TEST_CASE("FlatHashMap only grows past its capacity hint") {
+    IdMap map(1000);
+    auto capacity = map.capacity();
+    REQUIRE(capacity >= 1000);
+
+    for (std::uint64_t key = 0; key < 1000; ++key) {
+        map.emplace(key, key + 1);
+    }
+    REQUIRE(map.capacity() == capacity);
+
+    for (std::uint64_t key = 1000; key < 5000; ++key) {
+        map.emplace(key, key + 1);
+    }
+    REQUIRE(map.capacity() >= 5000);
+    for (std::uint64_t key = 0; key < 5000; ++key) {
+        REQUIRE(map.find(key)->second == key + 1);
+    }
+}
+
+TEST_CASE("FlatHashMap matches std::unordered_map under random churn") {
+    IdMap map;
+    std::unordered_map<std::uint64_t, std::uint64_t> reference;
+    std::mt19937_64 rng(42);
+
+    for (int i = 0; i < 20000; ++i) {
+        std::uint64_t key = rng() % 2000;
+        if (rng() % 3 == 0) {
+            REQUIRE(map.erase(key) == reference.erase(key));
+        } else {
+            REQUIRE(map.emplace(key, key + 1).second == reference.emplace(key, key + 1).second);
+        }
+    }
+
+    REQUIRE(map.size() == reference.size());
+    std::size_t visited = 0;
+    for (const auto& [key, value] : map) {
+        REQUIRE(reference.at(key) == value);
+        ++visited;
+    }
+    REQUIRE(visited == reference.size());
+}
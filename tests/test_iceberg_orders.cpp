@@ -0,0 +1,76 @@
+#include <catch2/catch_all.hpp>
+#include "matching_engine.h"
+#include "order.h"
+#include "order_events.h"
+#include "order_gateway.h"
+#include "orderbook.h"
+#include "tradehistory.h"
+#include "utils/object_pool.h"
+
+using namespace ob;
+
+static OrderPointer make_order(OrderId id, OrderSide side, Price price, Quantity qty, Quantity display = 0) {
+    OrderPointer order = ObjectPool::allocate(id, OrderType::Limit, side, TimeInForce::GoodTillCancel, price, qty);
+    if (display > 0) {
+        order->setDisplayQuantity(display);
+    }
+    return order;
+}
+
+TEST_CASE("An iceberg shows one slice at a time and refills from the back of the level") {
+    OrderBook book; TradeHistory history; MatchingEngine engine(book, history); OrderGateway gateway(engine);
+
+    OrderPointer iceberg = make_order(1, OrderSide::Sell, 101, 100, 10);
+    gateway.submitOrder(iceberg);
+    gateway.submitOrder(make_order(2, OrderSide::Sell, 101, 5));
+    REQUIRE(book.getSellDepth()[0].quantity == 15);
+    REQUIRE(book.getSellOrders().at(101).totalQuantity() == 15);
+
+    // Taking the whole slice sends the iceberg behind the order that queued after it
+    gateway.submitOrder(make_order(3, OrderSide::Buy, 101, 10));
+    auto& level = book.getSellOrders().at(101);
+    REQUIRE(level.front()->getOrderId() == 2);
+    REQUIRE(level.back() == iceberg);
+    REQUIRE(iceberg->getRemainingQuantity() == 90);
+    REQUIRE(iceberg->getVisibleQuantity() == 10);
+    REQUIRE(book.getSellDepth()[0].quantity == 15);
+    // Same order, same index slot
+    REQUIRE(book.getOrders().size() == 2);
+    REQUIRE(book.getOrders().find(1)->second == iceberg);
+
+    // A larger order keeps trading against fresh slices
+    gateway.submitOrder(make_order(4, OrderSide::Buy, 101, 30));
+    REQUIRE(history.getTrades().size() == 5);
+    REQUIRE(history.getTrades()[1]->sellOrderId_ == 2);
+    REQUIRE(history.getTrades()[4]->tradeQuantity_ == 5);
+    REQUIRE(iceberg->getRemainingQuantity() == 65);
+    REQUIRE(book.getSellDepth()[0].quantity == 5);
+    REQUIRE(book.getSellDepth()[0].orderCount == 1);
+}
+
+TEST_CASE("An incoming iceberg trades in full and rests with a fresh slice") {
+    OrderBook book; TradeHistory history; MatchingEngine engine(book, history); OrderGateway gateway(engine);
+
+    gateway.submitOrder(make_order(1, OrderSide::Sell, 100, 25));
+    OrderPointer iceberg = make_order(2, OrderSide::Buy, 100, 60, 20);
+    REQUIRE(gateway.submitOrder(iceberg).accepted);
+
+    REQUIRE(history.getTrades().size() == 1);
+    REQUIRE(history.getTrades()[0]->tradeQuantity_ == 25);
+    REQUIRE(iceberg->getRemainingQuantity() == 35);
+    REQUIRE(book.getBuyDepth()[0].quantity == 20);
+
+    // Cutting the order below its slice shrinks what is shown
+    REQUIRE(gateway.amendOrder(2, 100, 12).accepted);
+    REQUIRE(book.getBuyDepth()[0].quantity == 12);
+    REQUIRE(book.getBuyOrders().at(100).front() == iceberg);
+}
+
+TEST_CASE("Only resting limit orders can be icebergs") {
+    OrderBook book; TradeHistory history; MatchingEngine engine(book, history); OrderGateway gateway(engine);
+
+    OrderPointer ioc = ObjectPool::allocate(1, OrderType::Limit, OrderSide::Buy, TimeInForce::ImmediateOrCancel, 100, 50);
+    ioc->setDisplayQuantity(10);
+    REQUIRE(gateway.submitOrder(ioc).reason == OrderRejectionReason::InvalidQuantity);
+    ObjectPool::release(ioc);
+}
@@ -0,0 +1,165 @@
+#include <catch2/catch_all.hpp>
+#include "journal.h"
+#include "matching_engine.h"
+#include "order.h"
+#include "order_events.h"
+#include "order_gateway.h"
+#include "orderbook.h"
+#include "tradehistory.h"
+#include "utils/object_pool.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace ob;
+
+static std::string journal_path(const std::string& name) {
+    auto path = std::filesystem::temp_directory_path() / ("orderbook_" + name + ".journal");
+    std::filesystem::remove(path);
+    return path.string();
+}
+
+// Every resting order, side by side and level by level in queue order
+static std::vector<std::tuple<OrderId, Price, Quantity>> resting_orders(OrderBook& book) {
+    std::vector<std::tuple<OrderId, Price, Quantity>> orders;
+    for (const auto& [price, level] : book.getBuyOrders()) {
+        for (OrderPointer order : level) {
+            orders.emplace_back(order->getOrderId(), price, order->getRemainingQuantity());
+        }
+    }
+    for (const auto& [price, level] : book.getSellOrders()) {
+        for (OrderPointer order : level) {
+            orders.emplace_back(order->getOrderId(), price, order->getRemainingQuantity());
+        }
+    }
+    return orders;
+}
+
+TEST_CASE("Replaying the journal rebuilds an identical book") {
+    std::string path = journal_path("replay");
+
+    OrderBook book; TradeHistory history; MatchingEngine engine(book, history); OrderGateway gateway(engine);
+    {
+        // A small buffer so the journal is written in several batches
+        JournalWriter journal(path, 64);
+        gateway.setJournal(&journal);
+
+        std::mt19937 rng(7);
+        std::vector<OrderId> live;
+        for (OrderId id = 1; id <= 2000; ++id) {
+            if (!live.empty() && rng() % 4 == 0) {
+                OrderId victim = live[rng() % live.size()];
+                gateway.cancelOrder(victim);
+                continue;
+            }
+            if (!live.empty() && rng() % 5 == 0) {
+                OrderId amended = live[rng() % live.size()];
+                gateway.amendOrder(amended, 95 + rng() % 10, 1 + rng() % 20);
+                continue;
+            }
+            OrderSide side = (rng() % 2 == 0) ? OrderSide::Buy : OrderSide::Sell;
+            TimeInForce tif = (rng() % 8 == 0) ? TimeInForce::ImmediateOrCancel : TimeInForce::GoodTillCancel;
+            Price price = 95 + rng() % 10;
+            gateway.submitOrder(ObjectPool::allocate(id, OrderType::Limit, side, tif, price, 1 + rng() % 20));
+            live.push_back(id);
+        }
+        // Rejected orders never reach the journal
+        gateway.submitOrder(ObjectPool::allocate(5000, OrderType::Limit, OrderSide::Buy, TimeInForce::GoodTillCancel, 100, 0));
+        gateway.setJournal(nullptr);
+    }
+
+    OrderBook replayedBook; TradeHistory replayedHistory; MatchingEngine replayEngine(replayedBook, replayedHistory);
+    JournalReader reader(path);
+    REQUIRE(replayJournal(reader, replayEngine) == 2000);
+
+    REQUIRE(resting_orders(replayedBook) == resting_orders(book));
+    REQUIRE(replayedHistory.getTrades().size() == history.getTrades().size());
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Reopening a journal continues its sequence numbers") {
+    std::string path = journal_path("reopen");
+    {
+        JournalWriter journal(path, 4);
+        journal.append(JournalRecord::cancelOrder(1));
+        journal.append(JournalRecord::cancelOrder(2));
+    }
+    {
+        JournalWriter journal(path, 4);
+        REQUIRE(journal.lastSequence() == 2);
+        journal.append(JournalRecord::cancelOrder(3));
+    }
+
+    JournalReader reader(path);
+    JournalRecord record;
+    std::vector<OrderId> ids;
+    while (reader.next(record)) {
+        ids.push_back(record.orderId);
+    }
+    REQUIRE(ids == std::vector<OrderId>{1, 2, 3});
+    REQUIRE(record.sequence == 3);
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Reopening a journal with a torn tail drops the torn record before appending") {
+    std::string path = journal_path("torn");
+    {
+        JournalWriter journal(path, 4);
+        journal.append(JournalRecord::cancelOrder(1));
+        journal.append(JournalRecord::cancelOrder(2));
+    }
+    // A crash part way through the second record
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - sizeof(JournalRecord) / 2);
+    {
+        JournalWriter journal(path, 4);
+        REQUIRE(journal.lastSequence() == 1);
+        journal.append(JournalRecord::cancelOrder(3));
+    }
+    REQUIRE((std::filesystem::file_size(path) - sizeof(JournalHeader)) % sizeof(JournalRecord) == 0);
+
+    JournalReader reader(path);
+    JournalRecord record;
+    std::vector<OrderId> ids;
+    while (reader.next(record)) {
+        ids.push_back(record.orderId);
+    }
+    REQUIRE(ids == std::vector<OrderId>{1, 3});
+    REQUIRE(record.sequence == 2);
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("A journal in another format is refused instead of misread") {
+    std::string path = journal_path("format");
+    {
+        JournalWriter journal(path, 4);
+        journal.append(JournalRecord::cancelOrder(1));
+    }
+    {
+        // Same records under an older layout's header
+        std::FILE* file = std::fopen(path.c_str(), "r+b");
+        JournalHeader header;
+        REQUIRE(std::fread(&header, sizeof(header), 1, file) == 1);
+        header.recordSize = 32;
+        std::fseek(file, 0, SEEK_SET);
+        std::fwrite(&header, sizeof(header), 1, file);
+        std::fclose(file);
+    }
+    REQUIRE_THROWS_AS(JournalReader(path), std::runtime_error);
+    REQUIRE_THROWS_AS(JournalWriter(path), std::runtime_error);
+
+    // A journal from before the header existed starts straight with a record
+    std::filesystem::remove(path);
+    {
+        std::FILE* file = std::fopen(path.c_str(), "wb");
+        JournalRecord record = JournalRecord::cancelOrder(1);
+        record.sequence = 1;
+        std::fwrite(&record, sizeof(record), 1, file);
+        std::fclose(file);
+    }
+    REQUIRE_THROWS_AS(JournalReader(path), std::runtime_error);
+    REQUIRE_THROWS_AS(JournalWriter(path), std::runtime_error);
+    std::filesystem::remove(path);
+}
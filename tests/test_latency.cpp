@@ -0,0 +1,63 @@
+#include <catch2/catch_all.hpp>
+#include "matching_engine.h"
+#include "order.h"
+#include "order_gateway.h"
+#include "orderbook.h"
+#include "tradehistory.h"
+#include "utils/latency.h"
+#include "utils/object_pool.h"
+
+#include <sstream>
+
+using namespace ob;
+
+TEST_CASE("LatencyHistogram buckets are exact for small values and within 1/32 above") {
+    for (std::uint64_t value : {0ull, 1ull, 31ull, 32ull, 33ull, 1000ull, 123456789ull, ~0ull}) {
+        std::size_t bucket = LatencyHistogram::bucketOf(value);
+        REQUIRE(bucket < LatencyHistogram::kBucketCount);
+        std::uint64_t upper = LatencyHistogram::bucketUpperBound(bucket);
+        REQUIRE(upper >= value);
+        REQUIRE(upper - value <= value / LatencyHistogram::kSubBuckets);
+    }
+    REQUIRE(LatencyHistogram::bucketOf(64) == LatencyHistogram::bucketOf(65));
+    REQUIRE(LatencyHistogram::bucketOf(65) != LatencyHistogram::bucketOf(66));
+}
+
+TEST_CASE("LatencyHistogram reports percentiles and max") {
+    LatencyHistogram histogram;
+    REQUIRE(histogram.percentile(0.5) == 0);
+
+    for (std::uint64_t value = 1; value <= 1000; ++value) {
+        histogram.record(value);
+    }
+    histogram.record(1'000'000);
+
+    REQUIRE(histogram.count() == 1001);
+    REQUIRE(histogram.max() == 1'000'000);
+    REQUIRE(histogram.percentile(0.5) >= 500);
+    REQUIRE(histogram.percentile(0.5) <= 500 + 500 / 32);
+    REQUIRE(histogram.percentile(0.99) >= 990);
+    REQUIRE(histogram.percentile(0.99) <= 990 + 990 / 32);
+    REQUIRE(histogram.percentile(1.0) == 1'000'000);
+
+    histogram.reset();
+    REQUIRE(histogram.count() == 0);
+}
+
+#ifdef OB_LATENCY_STATS
+TEST_CASE("Instrumented build records every stage") {
+    LatencyStats::reset();
+    OrderBook book; TradeHistory history; MatchingEngine engine(book, history); OrderGateway gateway(engine);
+    gateway.submitOrder(ObjectPool::allocate(1, OrderType::Limit, OrderSide::Sell, TimeInForce::GoodTillCancel, 100, 10));
+    gateway.submitOrder(ObjectPool::allocate(2, OrderType::Limit, OrderSide::Buy, TimeInForce::GoodTillCancel, 100, 10));
+
+    REQUIRE(LatencyStats::summary(LatencyStage::GatewaySubmit).count == 2);
+    REQUIRE(LatencyStats::summary(LatencyStage::MatchOrders).count == 2);
+    REQUIRE(LatencyStats::summary(LatencyStage::ExecuteTrade).count == 1);
+    REQUIRE(LatencyStats::summary(LatencyStage::BookInsert).count == 1);
+
+    std::ostringstream report;
+    LatencyStats::writeReport(report);
+    REQUIRE(report.str().find("execute_trade count=1") != std::string::npos);
+}
+#endif
@@ -0,0 +1,96 @@
+#include <catch2/catch_all.hpp>
+#include "market_depth.h"
+#include "matching_engine.h"
+#include "order.h"
+#include "orderbook.h"
+#include "price_ladder.h"
+#include "tradehistory.h"
+#include "utils/object_pool.h"
+
+#include <map>
+#include <vector>
+
+using namespace ob;
+
+static OrderPointer make_limit(OrderId id, OrderSide side, Price price, Quantity qty) {
+    return ObjectPool::allocate(id, OrderType::Limit, side, TimeInForce::GoodTillCancel, price, qty);
+}
+
+// The cached view has to match a fresh aggregation of the book
+template <typename Levels>
+static void require_depth_matches(std::span<const DepthLevel> depth, const Levels& levels, std::size_t maxLevels) {
+    std::vector<DepthLevel> expected;
+    for (auto it = levels.begin(); it != levels.end() && expected.size() < maxLevels; ++it) {
+        const auto& [price, orders] = *it;
+        expected.push_back({price, orders.totalQuantity(), static_cast<std::uint32_t>(orders.size())});
+    }
+    REQUIRE(depth.size() == expected.size());
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+        REQUIRE(depth[i].price == expected[i].price);
+        REQUIRE(depth[i].quantity == expected[i].quantity);
+        REQUIRE(depth[i].orderCount == expected[i].orderCount);
+    }
+}
+
+TEMPLATE_TEST_CASE("Book keeps its top-N depth in step with adds, fills and removes", "", OrderBook, LadderOrderBook) {
+    TestType book = [] {
+        if constexpr (std::is_same_v<TestType, LadderOrderBook>) {
+            return TestType{PriceBand{1, 1000, 1}};
+        } else {
+            return TestType{};
+        }
+    }();
+    book.setDepthLevels(3);
+    TradeHistory history;
+    BasicMatchingEngine<TestType> engine(book, history);
+
+    OrderId id = 1;
+    for (Price price : {100, 101, 102, 103, 104}) {
+        book.addOrder(make_limit(id++, OrderSide::Sell, price, 10));
+        book.addOrder(make_limit(id++, OrderSide::Buy, price - 10, 5));
+    }
+    book.addOrder(make_limit(id++, OrderSide::Sell, 101, 7));
+    require_depth_matches(book.getSellDepth(), book.getSellOrders(), 3);
+    require_depth_matches(book.getBuyDepth(), book.getBuyOrders(), 3);
+    REQUIRE(book.getSellDepth()[1].quantity == 17);
+    REQUIRE(book.getBuyDepth()[0].price == 94);
+
+    // Sweep 100 fully and part of 101; levels below move up into the cache
+    engine.onNewOrder(make_limit(id++, OrderSide::Buy, 101, 15));
+    require_depth_matches(book.getSellDepth(), book.getSellOrders(), 3);
+    REQUIRE(book.getSellDepth()[0].price == 101);
+    REQUIRE(book.getSellDepth()[0].quantity == 12);
+    REQUIRE(book.getSellDepth()[2].price == 103);
+
+    book.cancelOrder(4);    // the buy at 91
+    book.cancelOrder(10);   // the buy at 94
+    require_depth_matches(book.getBuyDepth(), book.getBuyOrders(), 3);
+    REQUIRE(book.getBuyDepth().size() == 3);
+    REQUIRE(book.getBuyDepth()[0].price == 93);
+}
+
+TEST_CASE("Depth listener receives one update per level change") {
+    OrderBook book;
+    TradeHistory history;
+    MatchingEngine engine(book, history);
+
+    std::vector<DepthUpdate> updates;
+    book.setDepthListener([&](const DepthUpdate& update) { updates.push_back(update); });
+
+    book.addOrder(make_limit(1, OrderSide::Sell, 100, 10));
+    book.addOrder(make_limit(2, OrderSide::Sell, 100, 5));
+    engine.onNewOrder(make_limit(3, OrderSide::Buy, 100, 12));
+
+    REQUIRE(updates.size() == 4);
+    REQUIRE(updates[1].level.quantity == 15);
+    REQUIRE(updates[1].level.orderCount == 2);
+    // Order 1 fully filled and removed, then order 2 partially filled
+    REQUIRE(updates[2].level.quantity == 5);
+    REQUIRE(updates[2].level.orderCount == 1);
+    REQUIRE(updates[3].level.quantity == 3);
+
+    book.cancelOrder(2);
+    REQUIRE(updates.back().side == OrderSide::Sell);
+    REQUIRE(updates.back().level.orderCount == 0);
+    REQUIRE(book.getSellDepth().empty());
+}
@@ -0,0 +1,138 @@
+#include <catch2/catch_all.hpp>
+#include "execution_report.h"
+#include "matching_engine.h"
+#include "order.h"
+#include "orderbook.h"
+#include "tradehistory.h"
+#include "utils/object_pool.h"
+
+#include <type_traits>
+
+using namespace ob;
+
+static OrderPointer make_order(OrderId id, OrderSide side, Price price, Quantity qty, ParticipantId participant = 0) {
+    OrderPointer order = ObjectPool::allocate(id, OrderType::Limit, side, TimeInForce::GoodTillCancel, price, qty);
+    order->setParticipant(participant);
+    return order;
+}
+
+static OrderPointer make_stop(OrderId id, OrderSide side, Price stopPrice, ParticipantId participant = 0) {
+    OrderPointer order = ObjectPool::allocate(id, OrderType::Stop, side, TimeInForce::ImmediateOrCancel, 1, 5);
+    order->setStopPrice(stopPrice);
+    order->setParticipant(participant);
+    return order;
+}
+
+template <typename Book>
+static Book make_book() {
+    if constexpr (std::is_same_v<Book, LadderOrderBook>) {
+        return Book{PriceBand{1, 200, 1}};
+    } else {
+        return Book{};
+    }
+}
+
+// Buys at 98-100 and sells at 101-103, alternating between participants 1 and 2 within each level
+template <typename Engine>
+static void setup_book(Engine& engine) {
+    OrderId id = 1;
+    for (Price price = 98; price <= 100; ++price) {
+        engine.onNewOrder(make_order(id++, OrderSide::Buy, price, 10, 1));
+        engine.onNewOrder(make_order(id++, OrderSide::Buy, price, 10, 2));
+    }
+    for (Price price = 101; price <= 103; ++price) {
+        engine.onNewOrder(make_order(id++, OrderSide::Sell, price, 10, 1));
+        engine.onNewOrder(make_order(id++, OrderSide::Sell, price, 10, 2));
+    }
+}
+
+TEMPLATE_TEST_CASE("An empty filter cancels everything", "", OrderBook, LadderOrderBook) {
+    TestType book = make_book<TestType>(); TradeHistory history; BasicMatchingEngine<TestType> engine(book, history);
+    setup_book(engine);
+    engine.onNewOrder(make_stop(20, OrderSide::Buy, 150));
+
+    REQUIRE(engine.onMassCancel({}) == 13);
+    REQUIRE(book.getBuyOrders().empty());
+    REQUIRE(book.getSellOrders().empty());
+    REQUIRE(book.getOrders().size() == 0);
+    REQUIRE(book.getStops().empty());
+    REQUIRE(book.getBuyDepth().empty());
+    REQUIRE(book.getSellDepth().empty());
+    REQUIRE(engine.onMassCancel({}) == 0);
+
+    // The book still works afterwards
+    engine.onNewOrder(make_order(30, OrderSide::Sell, 100, 10));
+    engine.onNewOrder(make_order(31, OrderSide::Buy, 100, 4));
+    REQUIRE(history.getTrades().size() == 1);
+    REQUIRE(book.getOrders().size() == 1);
+}
+
+TEST_CASE("A side filter leaves the other side alone") {
+    OrderBook book; TradeHistory history; MatchingEngine engine(book, history);
+    setup_book(engine);
+
+    REQUIRE(engine.onMassCancel({ OrderSide::Sell }) == 6);
+    REQUIRE(book.getSellOrders().empty());
+    REQUIRE(book.getBuyOrders().size() == 3);
+    REQUIRE(book.getOrders().size() == 6);
+    REQUIRE(book.getOrders().find(7) == book.getOrders().end());
+    REQUIRE(book.getBuyDepth().size() == 3);
+}
+
+TEMPLATE_TEST_CASE("A price range takes only the levels inside it", "", OrderBook, LadderOrderBook) {
+    TestType book = make_book<TestType>(); TradeHistory history; BasicMatchingEngine<TestType> engine(book, history);
+    setup_book(engine);
+
+    // 99 and 100 on the buy side, 101 on the sell side
+    REQUIRE(engine.onMassCancel({ std::nullopt, 99, 101 }) == 6);
+    REQUIRE(book.getBuyOrders().begin()->first == 98);
+    REQUIRE(book.getBuyOrders().size() == 1);
+    REQUIRE(book.getSellOrders().begin()->first == 102);
+    REQUIRE(book.getSellOrders().size() == 2);
+    REQUIRE(book.getOrders().size() == 6);
+    REQUIRE(book.getBuyDepth()[0].price == 98);
+    REQUIRE(book.getSellDepth()[0].price == 102);
+
+    REQUIRE(engine.onMassCancel({ OrderSide::Buy, 50, 60 }) == 0);
+    REQUIRE(book.getOrders().size() == 6);
+}
+
+TEST_CASE("An owner filter keeps everyone else's orders and their priority") {
+    OrderBook book; TradeHistory history; MatchingEngine engine(book, history);
+    setup_book(engine);
+    engine.onNewOrder(make_stop(20, OrderSide::Buy, 150, 1));
+    engine.onNewOrder(make_stop(21, OrderSide::Sell, 50, 2));
+
+    REQUIRE(engine.onMassCancel({ std::nullopt, 0, 200, 1 }) == 7);
+    REQUIRE(book.getOrders().size() == 6);
+    REQUIRE(book.getStops().size() == 1);
+    REQUIRE(book.getStops().find(21) != nullptr);
+    for (const auto& [price, level] : book.getBuyOrders()) {
+        REQUIRE(level.size() == 1);
+        REQUIRE(level.front()->getParticipant() == 2);
+        REQUIRE(level.totalQuantity() == 10);
+    }
+    REQUIRE(book.getBuyDepth()[0].orderCount == 1);
+    REQUIRE(book.getBuyDepth()[0].quantity == 10);
+
+    // Emptying a level with an owner filter removes it
+    REQUIRE(engine.onMassCancel({ OrderSide::Sell, 101, 101, 2 }) == 1);
+    REQUIRE(book.getSellOrders().begin()->first == 102);
+}
+
+TEST_CASE("Every mass cancelled order gets a Cancelled report") {
+    OrderBook book; RingExecutionSink sink(64); BasicMatchingEngine<OrderBook, RingExecutionSink> engine(book, sink);
+    setup_book(engine);
+    sink.clear();
+
+    REQUIRE(engine.onMassCancel({ OrderSide::Buy, 100, 100 }) == 2);
+    REQUIRE(sink.size() == 2);
+    for (std::size_t i = 0; i < sink.size(); ++i) {
+        REQUIRE(sink[i].type == ExecutionType::Cancelled);
+        REQUIRE(sink[i].price == 100);
+        REQUIRE(sink[i].quantity == 10);
+        REQUIRE(sink[i].leavesQuantity == 0);
+    }
+    REQUIRE(sink[0].orderId == 5);
+    REQUIRE(sink[1].orderId == 6);
+}
@@ -1,6 +1,14 @@
 #include <catch2/catch_all.hpp>
 
+#include "matching_engine.h"
+#include "order_gateway.h"
+#include "orderbook.h"
+#include "tradehistory.h"
 #include "utils/object_pool.h"
+#include "utils/order_arena.h"
+
+#include <thread>
+#include <vector>
 
 using namespace ob;
 
@@ -61,3 +69,117 @@ TEST_CASE("ObjectPool reuses expired orders and rewrites fields") {
     REQUIRE(o2->getRemainingQuantity() == 75);
     REQUIRE(o2->getOrderStatus() == OrderStatus::New);
 }
+
+TEST_CASE("OrderArena hands out stable handles across slabs") {
+    OrderArena arena;
+    std::vector<OrderHandle> handles;
+    std::vector<Order*> addresses;
+    for (OrderId id = 0; id < OrderArena::kSlabSize + 10; ++id) {
+        OrderHandle handle = arena.allocate(id, OrderType::Limit, OrderSide::Buy, TimeInForce::GoodTillCancel, 100, 10);
+        handles.push_back(handle);
+        addresses.push_back(&arena.get(handle));
+    }
+
+    REQUIRE(arena.slabCount() == 2);
+    REQUIRE(arena.liveCount() == OrderArena::kSlabSize + 10);
+    for (std::size_t i = 0; i < handles.size(); ++i) {
+        REQUIRE(&arena.get(handles[i]) == addresses[i]);
+        REQUIRE(arena.get(handles[i]).getOrderId() == i);
+        REQUIRE(arena.get(handles[i]).getHandle() == handles[i]);
+    }
+}
+
+TEST_CASE("OrderArena reuses released slots without growing") {
+    OrderArena arena(OrderArena::kSlabSize);
+    auto first = arena.allocate(1, OrderType::Limit, OrderSide::Buy, TimeInForce::GoodTillCancel, 100, 10);
+    auto second = arena.allocate(2, OrderType::Limit, OrderSide::Sell, TimeInForce::GoodTillCancel, 101, 20);
+    arena.release(first);
+    arena.release(second);
+
+    for (int burst = 0; burst < 10; ++burst) {
+        std::vector<OrderHandle> handles;
+        for (OrderId id = 0; id < OrderArena::kSlabSize; ++id) {
+            handles.push_back(arena.allocate(id, OrderType::Limit, OrderSide::Buy, TimeInForce::GoodTillCancel, 100, 10));
+        }
+        for (auto handle : handles) {
+            arena.release(handle);
+        }
+    }
+
+    REQUIRE(arena.slabCount() == 1);
+    REQUIRE(arena.liveCount() == 0);
+}
+
+TEST_CASE("ObjectPool leaves orders it did not allocate alone") {
+    Order external{1, OrderType::Limit, OrderSide::Buy, TimeInForce::GoodTillCancel, 100, 10};
+    auto live = ObjectPool::arena().liveCount();
+
+    ObjectPool::release(&external);
+
+    REQUIRE(external.getHandle() == kInvalidOrderHandle);
+    REQUIRE(ObjectPool::arena().liveCount() == live);
+}
+
+TEST_CASE("Book, engine and gateway accept handles") {
+    OrderBook book; TradeHistory history; MatchingEngine engine(book, history); OrderGateway gateway(engine);
+
+    auto restingSell = ObjectPool::allocateHandle(1, OrderType::Limit, OrderSide::Sell, TimeInForce::GoodTillCancel, 100, 30);
+    book.addOrder(restingSell);
+
+    auto buy = ObjectPool::allocateHandle(2, OrderType::Limit, OrderSide::Buy, TimeInForce::GoodTillCancel, 100, 10);
+    REQUIRE(gateway.submitOrder(buy).accepted);
+
+    REQUIRE(ObjectPool::resolve(restingSell)->getRemainingQuantity() == 20);
+    REQUIRE(history.getTrades().size() == 1);
+}
+
+TEST_CASE("Orders released on another thread go back to their own arena in batches") {
+    ObjectPool pool(0);
+    OrderArena& arena = ObjectPool::arena();
+    auto live = arena.liveCount();
+
+    std::vector<OrderPointer> orders;
+    for (OrderId id = 0; id < ObjectPool::kReturnBatch + 10; ++id) {
+        orders.push_back(make_order(id, OrderSide::Buy));
+    }
+    REQUIRE(arena.liveCount() == live + ObjectPool::kReturnBatch + 10);
+
+    std::uint32_t beforeFlush = 0;
+    std::uint32_t releaserLive = 0;
+    std::thread releaser([&] {
+        for (OrderPointer order : orders) {
+            ObjectPool::release(order);
+        }
+        beforeFlush = arena.liveCount();
+        ObjectPool::flushReleases();
+        releaserLive = ObjectPool::arena().liveCount();
+    });
+    releaser.join();
+
+    // One full batch went back on its own, the last ten waited for the flush
+    REQUIRE(beforeFlush == live + 10);
+    REQUIRE(arena.liveCount() == live);
+    REQUIRE(releaserLive == 0);
+
+    // The owner picks the returned slots up again instead of growing
+    auto slabs = arena.slabCount();
+    for (OrderId id = 0; id < ObjectPool::kReturnBatch + 10; ++id) {
+        OrderPointer order = make_order(id, OrderSide::Sell);
+        REQUIRE(order->getArenaId() == arena.id());
+        orders[id] = order;
+    }
+    REQUIRE(arena.slabCount() == slabs);
+    for (OrderPointer order : orders) {
+        ObjectPool::release(order);
+    }
+    REQUIRE(arena.liveCount() == live);
+}
+
+TEST_CASE("A thread's staged releases are returned when it exits") {
+    OrderArena& arena = ObjectPool::arena();
+    auto live = arena.liveCount();
+    OrderPointer order = make_order(1, OrderSide::Buy);
+
+    std::thread([order] { ObjectPool::release(order); }).join();
+    REQUIRE(arena.liveCount() == live);
+}
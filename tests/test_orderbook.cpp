@@ -91,6 +91,45 @@ TEST_CASE("Cancelling a filled order throws") {
     REQUIRE_THROWS_AS(filled->cancel(), std::logic_error);
 }
 
+TEST_CASE("Cancel from middle of a level keeps FIFO order of the rest") {
+    OrderBook book; TradeHistory history; MatchingEngine engine(book, history);
+    auto sellA = make_order(410, OrderType::Limit, TimeInForce::GoodTillCancel, OrderSide::Sell, 100, 10);
+    auto sellB = make_order(411, OrderType::Limit, TimeInForce::GoodTillCancel, OrderSide::Sell, 100, 10);
+    auto sellC = make_order(412, OrderType::Limit, TimeInForce::GoodTillCancel, OrderSide::Sell, 100, 10);
+    auto sellD = make_order(413, OrderType::Limit, TimeInForce::GoodTillCancel, OrderSide::Sell, 100, 10);
+    book.addOrder(sellA);
+    book.addOrder(sellB);
+    book.addOrder(sellC);
+    book.addOrder(sellD);
+
+    book.cancelOrder(412);
+    book.cancelOrder(410);
+
+    auto& level = book.getSellOrders().begin()->second;
+    REQUIRE(level.size() == 2);
+    REQUIRE(level.front() == sellB);
+    REQUIRE(level.back() == sellD);
+
+    auto incomingBuy = make_order(414, OrderType::Limit, TimeInForce::GoodTillCancel, OrderSide::Buy, 100, 15);
+    engine.onNewOrder(incomingBuy);
+    REQUIRE(sellB->getRemainingQuantity() == 0);
+    REQUIRE(sellD->getRemainingQuantity() == 5);
+}
+
+TEST_CASE("Cancelling the only order in a level removes the level") {
+    OrderBook book;
+    book.addOrder(make_order(420, OrderType::Limit, TimeInForce::GoodTillCancel, OrderSide::Buy, 101, 10));
+    book.addOrder(make_order(421, OrderType::Limit, TimeInForce::GoodTillCancel, OrderSide::Buy, 100, 10));
+    book.addOrder(make_order(422, OrderType::Limit, TimeInForce::GoodTillCancel, OrderSide::Buy, 100, 10));
+
+    book.cancelOrder(420);
+    auto& buys = book.getBuyOrders();
+    REQUIRE(buys.size() == 1);
+    REQUIRE(buys.begin()->first == 100);
+    REQUIRE(buys.begin()->second.front()->getOrderId() == 421);
+    REQUIRE(buys.begin()->second.back()->getOrderId() == 422);
+}
+
 TEST_CASE("No match when buy below best ask") {
     OrderBook book; TradeHistory history; MatchingEngine engine(book, history);
     book.addOrder(make_order(100, OrderType::Limit, TimeInForce::GoodTillCancel, OrderSide::Sell, 100, 20));
@@ -506,6 +545,47 @@ TEST_CASE("FOK Limit or Market order rejects if full fill not available") {
     REQUIRE(book.getSellOrders().begin()->second.size() == 2); 
 }
 
+TEST_CASE("Price level tracks total quantity and order count") {
+    OrderBook book; TradeHistory history; MatchingEngine engine(book, history);
+    book.addOrder(make_order(1750, OrderType::Limit, TimeInForce::GoodTillCancel, OrderSide::Sell, 100, 20));
+    book.addOrder(make_order(1751, OrderType::Limit, TimeInForce::GoodTillCancel, OrderSide::Sell, 100, 30));
+    book.addOrder(make_order(1752, OrderType::Limit, TimeInForce::GoodTillCancel, OrderSide::Sell, 100, 40));
+
+    auto& level = book.getSellOrders().begin()->second;
+    REQUIRE(level.size() == 3);
+    REQUIRE(level.totalQuantity() == 90);
+
+    // Fills the first order and part of the second
+    engine.onNewOrder(make_order(1753, OrderType::Limit, TimeInForce::GoodTillCancel, OrderSide::Buy, 100, 25));
+    REQUIRE(level.size() == 2);
+    REQUIRE(level.totalQuantity() == 65);
+
+    book.cancelOrder(1751);
+    REQUIRE(level.size() == 1);
+    REQUIRE(level.totalQuantity() == 40);
+}
+
+TEST_CASE("FOK is checked against level totals at or better than its price") {
+    OrderBook book; TradeHistory history; MatchingEngine engine(book, history);
+    book.addOrder(make_order(1760, OrderType::Limit, TimeInForce::GoodTillCancel, OrderSide::Buy, 101, 10));
+    book.addOrder(make_order(1761, OrderType::Limit, TimeInForce::GoodTillCancel, OrderSide::Buy, 100, 10));
+    book.addOrder(make_order(1762, OrderType::Limit, TimeInForce::GoodTillCancel, OrderSide::Buy, 99, 50));
+
+    // 20 available at 100 or better, the 50 at 99 is out of reach
+    auto fokSell = make_order(1763, OrderType::Limit, TimeInForce::FillOrKill, OrderSide::Sell, 100, 25);
+    engine.onNewOrder(fokSell);
+    REQUIRE(fokSell->getOrderStatus() == OrderStatus::Cancelled);
+    REQUIRE(history.getTrades().empty());
+    REQUIRE(book.getBuyOrders().size() == 3);
+
+    auto fokSellExact = make_order(1764, OrderType::Limit, TimeInForce::FillOrKill, OrderSide::Sell, 100, 20);
+    engine.onNewOrder(fokSellExact);
+    REQUIRE(fokSellExact->getOrderStatus() == OrderStatus::Filled);
+    REQUIRE(history.getTrades().size() == 2);
+    REQUIRE(book.getBuyOrders().size() == 1);
+    REQUIRE(book.getBuyOrders().begin()->second.totalQuantity() == 50);
+}
+
 TEST_CASE("FOK with multiple price levels - fills nothing") {
     OrderBook book; TradeHistory history; MatchingEngine engine(book, history);
     
@@ -602,3 +682,172 @@ TEST_CASE("IOC and FOK orders do not rest on book") {
     REQUIRE(fokBuy->getOrderStatus() == OrderStatus::Cancelled);
 }
 
+
+TEST_CASE("OrderGateway batch submit validates up front and reports each order") {
+    OrderBook book; TradeHistory history; MatchingEngine engine(book, history); OrderGateway gateway(engine);
+
+    std::vector<OrderPointer> orders {
+        make_order(2200, OrderType::Limit, TimeInForce::GoodTillCancel, OrderSide::Sell, 100, 10),
+        make_order(2201, OrderType::Limit, TimeInForce::GoodTillCancel, OrderSide::Buy, 100, 0),
+        make_order(2202, OrderType::Limit, TimeInForce::FillOrKill, OrderSide::Buy, 100, 20),
+        make_order(2203, OrderType::Limit, TimeInForce::ImmediateOrCancel, OrderSide::Buy, 100, 4),
+    };
+    std::vector<OrderResult> results(orders.size());
+    gateway.submitOrders(orders, results);
+
+    REQUIRE(results[0].accepted);
+    REQUIRE(results[1].reason == OrderRejectionReason::InvalidQuantity);
+    REQUIRE(results[2].reason == OrderRejectionReason::InsufficientLiquidity);
+    REQUIRE(results[3].accepted);
+    REQUIRE(history.getTrades().size() == 1);
+    REQUIRE(book.getSellOrders().at(100).totalQuantity() == 6);
+
+    std::vector<OrderId> cancels { 2200 };
+    gateway.cancelOrders(cancels, results);
+    REQUIRE(results[0].id == 2200);
+    REQUIRE(book.getSellOrders().empty());
+
+    std::vector<OrderResult> tooFew(1);
+    REQUIRE_THROWS_AS(gateway.submitOrders(orders, tooFew), std::invalid_argument);
+}
+
+TEST_CASE("OrderGateway results keep the id of orders the engine has already released") {
+    // Arena orders: a filled or killed order's slot goes back on the free list before the
+    // gateway builds its result, and the free-list link overwrites the order id
+    ObjectPool pool(16);
+    OrderBook book; TradeHistory history; MatchingEngine engine(book, history); OrderGateway gateway(engine);
+
+    REQUIRE(gateway.submitOrder(ObjectPool::allocate(7, OrderType::Limit, OrderSide::Sell, TimeInForce::GoodTillCancel, 100, 10)).accepted);
+
+    OrderResult filled = gateway.submitOrder(ObjectPool::allocate(555, OrderType::Limit, OrderSide::Buy, TimeInForce::GoodTillCancel, 100, 4));
+    REQUIRE(filled.id == 555);
+    REQUIRE(filled.accepted);
+
+    OrderResult killed = gateway.submitOrder(ObjectPool::allocate(12345678901, OrderType::Limit, OrderSide::Buy, TimeInForce::ImmediateOrCancel, 100, 10));
+    REQUIRE(killed.id == 12345678901);
+    REQUIRE(killed.reason == OrderRejectionReason::InsufficientLiquidity);
+    REQUIRE(book.getOrders().empty());
+
+    std::vector<OrderPointer> orders {
+        ObjectPool::allocate(8, OrderType::Limit, OrderSide::Sell, TimeInForce::GoodTillCancel, 100, 5),
+        ObjectPool::allocate(9001, OrderType::Limit, OrderSide::Buy, TimeInForce::FillOrKill, 100, 5),
+        ObjectPool::allocate(9002, OrderType::Limit, OrderSide::Buy, TimeInForce::FillOrKill, 100, 5),
+    };
+    std::vector<OrderResult> results(orders.size());
+    gateway.submitOrders(orders, results);
+    REQUIRE(results[1].id == 9001);
+    REQUIRE(results[1].accepted);
+    REQUIRE(results[2].id == 9002);
+    REQUIRE(results[2].reason == OrderRejectionReason::InsufficientLiquidity);
+}
+
+TEST_CASE("Matching path reports errors as codes instead of throwing") {
+    OrderBook book; TradeHistory history; MatchingEngine engine(book, history); OrderGateway gateway(engine);
+
+    auto order = make_order(2300, OrderType::Limit, TimeInForce::GoodTillCancel, OrderSide::Buy, 100, 10);
+    REQUIRE(order->tryFill(11) == OrderError::FillExceedsRemaining);
+    REQUIRE(order->getRemainingQuantity() == 10);
+    REQUIRE(order->tryFill(10) == OrderError::None);
+    REQUIRE(order->tryCancel() == OrderError::AlreadyFilled);
+
+    // e.g. a corrupt journal record
+    auto corrupt = make_order(2301, OrderType::Limit, static_cast<TimeInForce>(7), OrderSide::Buy, 100, 10);
+    REQUIRE(engine.onNewOrder(corrupt) == OrderError::UnsupportedTimeInForce);
+    REQUIRE(corrupt->getOrderStatus() == OrderStatus::New);
+    REQUIRE(book.getBuyOrders().empty());
+
+    OrderResult result = gateway.submitOrder(corrupt);
+    REQUIRE(result.reason == OrderRejectionReason::Other);
+}
+
+TEST_CASE("Every side, type and time-in-force combination is dispatched to its own routine") {
+    OrderBook book; TradeHistory history;
+    BasicMatchingEngine<OrderBook, TradeHistory, ValidationLevel::Full> engine(book, history);
+
+    book.addOrder(make_order(2400, OrderType::Limit, TimeInForce::GoodTillCancel, OrderSide::Sell, 101, 10));
+    book.addOrder(make_order(2401, OrderType::Limit, TimeInForce::GoodTillCancel, OrderSide::Buy, 99, 10));
+
+    // Crossing is decided per side: neither of these reaches the opposite best price
+    REQUIRE(engine.onNewOrder(make_order(2402, OrderType::Limit, TimeInForce::GoodTillCancel, OrderSide::Buy, 100, 5)) == OrderError::None);
+    REQUIRE(engine.onNewOrder(make_order(2403, OrderType::Limit, TimeInForce::GoodTillCancel, OrderSide::Sell, 102, 5)) == OrderError::None);
+    REQUIRE(history.getTrades().empty());
+    REQUIRE(book.getBuyOrders().begin()->first == 100);
+    REQUIRE(book.getSellOrders().size() == 2);
+
+    // A sell market order ignores its price and sweeps both bid levels
+    auto marketSell = make_order(2404, OrderType::Market, TimeInForce::ImmediateOrCancel, OrderSide::Sell, 200, 12);
+    REQUIRE(engine.onNewOrder(marketSell) == OrderError::None);
+    REQUIRE(history.getTrades().size() == 2);
+    REQUIRE(book.getBuyOrders().begin()->second.totalQuantity() == 3);
+
+    // A buy FOK that would need more than the crossing levels hold leaves the book alone
+    auto fok = make_order(2405, OrderType::Limit, TimeInForce::FillOrKill, OrderSide::Buy, 101, 11);
+    REQUIRE(engine.onNewOrder(fok) == OrderError::None);
+    REQUIRE(history.getTrades().size() == 2);
+    REQUIRE(book.getSellOrders().begin()->second.totalQuantity() == 10);
+
+    auto badSide = make_order(2406, OrderType::Limit, TimeInForce::GoodTillCancel, static_cast<OrderSide>(5), 100, 1);
+    REQUIRE(engine.onNewOrder(badSide) == OrderError::UnsupportedOrderType);
+    auto badType = make_order(2407, static_cast<OrderType>(5), TimeInForce::GoodTillCancel, OrderSide::Buy, 100, 1);
+    REQUIRE(engine.onNewOrder(badType) == OrderError::UnsupportedOrderType);
+    delete badSide;
+    delete badType;
+}
+
+TEST_CASE("Amending a resting order") {
+    OrderBook book; TradeHistory history; MatchingEngine engine(book, history); OrderGateway gateway(engine);
+
+    gateway.submitOrder(make_order(2500, OrderType::Limit, TimeInForce::GoodTillCancel, OrderSide::Buy, 100, 10));
+    gateway.submitOrder(make_order(2501, OrderType::Limit, TimeInForce::GoodTillCancel, OrderSide::Buy, 100, 10));
+
+    SECTION("Reducing quantity at the same price keeps queue priority") {
+        REQUIRE(gateway.amendOrder(2500, 100, 4).accepted);
+        auto& level = book.getBuyOrders().at(100);
+        REQUIRE(level.front()->getOrderId() == 2500);
+        REQUIRE(level.front()->getRemainingQuantity() == 4);
+        REQUIRE(level.totalQuantity() == 14);
+        REQUIRE(book.getBuyDepth()[0].quantity == 14);
+    }
+
+    SECTION("Increasing quantity loses queue priority") {
+        REQUIRE(gateway.amendOrder(2500, 100, 15).accepted);
+        auto& level = book.getBuyOrders().at(100);
+        REQUIRE(level.front()->getOrderId() == 2501);
+        REQUIRE(level.back()->getOrderId() == 2500);
+        REQUIRE(level.totalQuantity() == 25);
+    }
+
+    SECTION("A price change moves the order between levels") {
+        REQUIRE(gateway.amendOrder(2500, 99, 10).accepted);
+        REQUIRE(book.getBuyOrders().at(100).size() == 1);
+        REQUIRE(book.getBuyOrders().at(99).front()->getOrderId() == 2500);
+        REQUIRE(book.getOrders().find(2500)->second->getPrice() == 99);
+
+        REQUIRE(gateway.amendOrder(2501, 99, 10).accepted);
+        REQUIRE(book.getBuyOrders().size() == 1);
+        REQUIRE(book.getBuyDepth()[0].orderCount == 2);
+    }
+
+    SECTION("A price that crosses the spread trades like a new order") {
+        gateway.submitOrder(make_order(2502, OrderType::Limit, TimeInForce::GoodTillCancel, OrderSide::Sell, 102, 6));
+        REQUIRE(gateway.amendOrder(2501, 102, 10).accepted);
+        REQUIRE(history.getTrades().size() == 1);
+        REQUIRE(book.getSellOrders().empty());
+        REQUIRE(book.getBuyOrders().at(102).front()->getRemainingQuantity() == 4);
+        REQUIRE(book.getBuyOrders().at(102).front()->getFilledQuantity() == 6);
+    }
+
+    SECTION("Amends that cannot be applied are rejected") {
+        REQUIRE(gateway.amendOrder(9999, 100, 5).reason == OrderRejectionReason::UnknownOrder);
+        REQUIRE(gateway.amendOrder(9999, 100, 0).reason == OrderRejectionReason::UnknownOrder);
+        REQUIRE(gateway.amendOrder(2500, 0, 5).reason == OrderRejectionReason::InvalidPrice);
+    }
+
+    SECTION("Amending to zero cancels, through the gateway as through the engine") {
+        REQUIRE(gateway.amendOrder(2500, 0, 0).accepted);
+        REQUIRE(book.getOrders().find(2500) == book.getOrders().end());
+        REQUIRE(book.getBuyOrders().at(100).totalQuantity() == 10);
+        REQUIRE(engine.onAmendOrder(2501, 100, 0) == OrderError::None);
+        REQUIRE(book.getBuyOrders().empty());
+    }
+}
@@ -0,0 +1,96 @@
+#include <catch2/catch_all.hpp>
+#include "order.h"
+#include "orderbook.h"
+#include "order_events.h"
+#include "order_gateway.h"
+#include "matching_engine.h"
+#include "price_ladder.h"
+#include "tradehistory.h"
+
+using namespace ob;
+
+static OrderPointer make_order(OrderId id, OrderType type, TimeInForce timeInForce, OrderSide side, Price price, Quantity qty) {
+    return new Order{id, type, side, timeInForce, price, qty};
+}
+
+TEST_CASE("PriceLadder iterates active levels in priority order") {
+    PriceLadder<std::greater<Price>> bids{PriceBand{100, 1000, 5}};
+    PriceLadder<std::less<Price>> asks{PriceBand{100, 1000, 5}};
+
+    for (Price price : {500, 105, 995, 300}) {
+        bids[price];
+        asks[price];
+    }
+
+    std::vector<Price> bidPrices, askPrices;
+    for (const auto& [price, _] : bids) bidPrices.push_back(price);
+    for (const auto& [price, _] : asks) askPrices.push_back(price);
+
+    REQUIRE(bids.size() == 4);
+    REQUIRE(bidPrices == std::vector<Price>{995, 500, 300, 105});
+    REQUIRE(askPrices == std::vector<Price>{105, 300, 500, 995});
+}
+
+TEST_CASE("PriceLadder moves best level when the best is erased") {
+    PriceLadder<std::greater<Price>> bids{PriceBand{1, 1000, 1}};
+    bids[10];
+    bids[900];
+    REQUIRE(bids.begin()->first == 900);
+
+    bids.erase(900);
+    REQUIRE(bids.begin()->first == 10);
+
+    bids.erase(10);
+    REQUIRE(bids.empty());
+    REQUIRE(bids.begin() == bids.end());
+}
+
+TEST_CASE("PriceLadder rejects prices outside the band or off tick") {
+    PriceLadder<std::less<Price>> asks{PriceBand{100, 200, 5}};
+    REQUIRE(asks.isValidPrice(100));
+    REQUIRE(asks.isValidPrice(200));
+    REQUIRE_FALSE(asks.isValidPrice(99));
+    REQUIRE_FALSE(asks.isValidPrice(201));
+    REQUIRE_FALSE(asks.isValidPrice(102));
+    REQUIRE_THROWS_AS(asks[102], std::out_of_range);
+}
+
+TEST_CASE("Ladder book matches across levels like the map book") {
+    LadderOrderBook book{PriceBand{1, 1000, 1}}; TradeHistory history; LadderMatchingEngine engine(book, history);
+    book.addOrder(make_order(1, OrderType::Limit, TimeInForce::GoodTillCancel, OrderSide::Sell, 98, 10));
+    book.addOrder(make_order(2, OrderType::Limit, TimeInForce::GoodTillCancel, OrderSide::Sell, 99, 15));
+    book.addOrder(make_order(3, OrderType::Limit, TimeInForce::GoodTillCancel, OrderSide::Sell, 100, 20));
+
+    auto incomingBuy = make_order(4, OrderType::Limit, TimeInForce::GoodTillCancel, OrderSide::Buy, 100, 35);
+    engine.onNewOrder(incomingBuy);
+
+    const auto& trades = history.getTrades();
+    REQUIRE(trades.size() == 3);
+    REQUIRE(trades[0]->tradePrice_ == 98);
+    REQUIRE(trades[1]->tradePrice_ == 99);
+    REQUIRE(trades[2]->tradePrice_ == 100);
+    REQUIRE(trades[2]->tradeQuantity_ == 10);
+
+    auto& sells = book.getSellOrders();
+    REQUIRE(sells.size() == 1);
+    REQUIRE(sells.begin()->first == 100);
+    REQUIRE(sells.begin()->second.front()->getRemainingQuantity() == 10);
+    REQUIRE(book.getBuyOrders().empty());
+}
+
+TEST_CASE("Ladder gateway rejects limit prices outside the band") {
+    LadderOrderBook book{PriceBand{100, 200, 5}}; TradeHistory history; LadderMatchingEngine engine(book, history);
+    LadderOrderGateway gateway(engine);
+
+    OrderResult offTick = gateway.submitOrder(make_order(1, OrderType::Limit, TimeInForce::GoodTillCancel, OrderSide::Buy, 102, 10));
+    REQUIRE(offTick.accepted == false);
+    REQUIRE(offTick.reason == OrderRejectionReason::InvalidPrice);
+
+    OrderResult outOfBand = gateway.submitOrder(make_order(2, OrderType::Limit, TimeInForce::GoodTillCancel, OrderSide::Sell, 300, 10));
+    REQUIRE(outOfBand.accepted == false);
+    REQUIRE(outOfBand.reason == OrderRejectionReason::InvalidPrice);
+
+    OrderResult valid = gateway.submitOrder(make_order(3, OrderType::Limit, TimeInForce::GoodTillCancel, OrderSide::Buy, 150, 10));
+    REQUIRE(valid.accepted);
+    REQUIRE(book.getBuyOrders().begin()->first == 150);
+}
@@ -0,0 +1,85 @@
+#include <catch2/catch_all.hpp>
+#include "matching_algorithm.h"
+#include "matching_engine.h"
+#include "order.h"
+#include "orderbook.h"
+#include "tradehistory.h"
+#include "utils/object_pool.h"
+
+#include <numeric>
+#include <random>
+#include <vector>
+
+using namespace ob;
+
+static OrderPointer make_order(OrderId id, OrderSide side, Price price, Quantity qty) {
+    return ObjectPool::allocate(id, OrderType::Limit, side, TimeInForce::GoodTillCancel, price, qty);
+}
+
+static std::vector<std::pair<OrderId, Quantity>> fills(const TradeHistory& history) {
+    std::vector<std::pair<OrderId, Quantity>> result;
+    for (TradePointer trade : history.getTrades()) {
+        result.emplace_back(trade->sellOrderId_, trade->tradeQuantity_);
+    }
+    return result;
+}
+
+TEST_CASE("Pro-rata shares add up and never exceed an order's size") {
+    std::mt19937 rng(3);
+    for (int round = 0; round < 200; ++round) {
+        std::vector<Quantity> sizes(1 + rng() % 300);
+        for (Quantity& size : sizes) {
+            size = 1 + rng() % 1000;
+        }
+        std::uint64_t total = std::accumulate(sizes.begin(), sizes.end(), std::uint64_t{0});
+        Quantity quantity = static_cast<Quantity>(rng() % total);
+        std::vector<Quantity> shares(sizes.size());
+
+        allocateProRata(sizes, shares, quantity, total);
+        REQUIRE(std::accumulate(shares.begin(), shares.end(), std::uint64_t{0}) == quantity);
+        for (std::size_t i = 0; i < sizes.size(); ++i) {
+            REQUIRE(shares[i] <= sizes[i]);
+        }
+    }
+}
+
+TEST_CASE("Pro-rata levels are shared by size, leftovers by time") {
+    OrderBook book; TradeHistory history; MatchingEngine engine(book, history);
+    engine.setMatchingAlgorithm(MatchingAlgorithm::ProRata);
+
+    engine.onNewOrder(make_order(1, OrderSide::Sell, 100, 30));
+    engine.onNewOrder(make_order(2, OrderSide::Sell, 100, 60));
+    engine.onNewOrder(make_order(3, OrderSide::Sell, 100, 10));
+
+    engine.onNewOrder(make_order(10, OrderSide::Buy, 100, 50));
+    std::vector<std::pair<OrderId, Quantity>> expected { {1, 15}, {2, 30}, {3, 5} };
+    REQUIRE(fills(history) == expected);
+
+    // 15/30/5 against 7: 2.1, 4.2 and 0.7 round down to 2, 4 and 0, the spare lot goes to the first
+    engine.onNewOrder(make_order(11, OrderSide::Buy, 100, 7));
+    expected.insert(expected.end(), { {1, 3}, {2, 4} });
+    REQUIRE(fills(history) == expected);
+    REQUIRE(book.getSellOrders().at(100).totalQuantity() == 43);
+    REQUIRE(book.getSellDepth()[0].quantity == 43);
+
+    // An order that takes the whole level needs no allocation
+    engine.onNewOrder(make_order(12, OrderSide::Buy, 100, 50));
+    REQUIRE(book.getSellOrders().empty());
+    REQUIRE(book.getBuyOrders().at(100).totalQuantity() == 7);
+}
+
+TEST_CASE("Pro-rata with top-order priority fills the first order first") {
+    OrderBook book; TradeHistory history; MatchingEngine engine(book, history);
+    engine.setMatchingAlgorithm(MatchingAlgorithm::ProRataTopOrder);
+
+    engine.onNewOrder(make_order(1, OrderSide::Sell, 100, 30));
+    engine.onNewOrder(make_order(2, OrderSide::Sell, 100, 60));
+    engine.onNewOrder(make_order(3, OrderSide::Sell, 100, 10));
+    engine.onNewOrder(make_order(10, OrderSide::Buy, 100, 50));
+
+    // 20 left after the top order, over 60 and 10: 17.1 and 2.9 round down, the spare lot goes to 2
+    std::vector<std::pair<OrderId, Quantity>> expected { {1, 30}, {2, 18}, {3, 2} };
+    REQUIRE(fills(history) == expected);
+    REQUIRE(book.getOrders().find(1) == book.getOrders().end());
+    REQUIRE(book.getSellOrders().at(100).size() == 2);
+}
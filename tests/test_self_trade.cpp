@@ -0,0 +1,180 @@
+#include <catch2/catch_all.hpp>
+#include "matching_algorithm.h"
+#include "matching_engine.h"
+#include "order.h"
+#include "orderbook.h"
+#include "tradehistory.h"
+#include "utils/object_pool.h"
+
+using namespace ob;
+
+static OrderPointer make_order(OrderId id, OrderSide side, Price price, Quantity qty, ParticipantId participant,
+                               TimeInForce tif = TimeInForce::GoodTillCancel) {
+    OrderPointer order = ObjectPool::allocate(id, OrderType::Limit, side, tif, price, qty);
+    order->setParticipant(participant);
+    return order;
+}
+
+// Participant 1 rests 10 at 100 behind participant 2's 10, then buys 30 at 101
+static void setup_level(MatchingEngine& engine) {
+    engine.onNewOrder(make_order(1, OrderSide::Sell, 100, 10, 2));
+    engine.onNewOrder(make_order(2, OrderSide::Sell, 100, 10, 1));
+    engine.onNewOrder(make_order(3, OrderSide::Sell, 101, 10, 2));
+}
+
+TEST_CASE("Without self-trade prevention own orders trade") {
+    OrderBook book; TradeHistory history; MatchingEngine engine(book, history);
+    setup_level(engine);
+
+    engine.onNewOrder(make_order(10, OrderSide::Buy, 101, 30, 1));
+    REQUIRE(history.getTrades().size() == 3);
+    REQUIRE(history.getTrades()[1]->sellOrderId_ == 2);
+}
+
+TEST_CASE("Cancel resting removes own orders and keeps matching") {
+    OrderBook book; TradeHistory history; MatchingEngine engine(book, history);
+    engine.setSelfTradePrevention(SelfTradePrevention::CancelResting);
+    setup_level(engine);
+
+    engine.onNewOrder(make_order(10, OrderSide::Buy, 101, 30, 1));
+    REQUIRE(history.getTrades().size() == 2);
+    REQUIRE(history.getTrades()[0]->sellOrderId_ == 1);
+    REQUIRE(history.getTrades()[1]->sellOrderId_ == 3);
+    REQUIRE(book.getSellOrders().empty());
+    REQUIRE(book.getBuyOrders().at(101).totalQuantity() == 10);
+    REQUIRE(book.getOrders().find(2) == book.getOrders().end());
+}
+
+TEST_CASE("Cancel incoming stops the order at its first own order") {
+    OrderBook book; TradeHistory history; MatchingEngine engine(book, history);
+    engine.setSelfTradePrevention(SelfTradePrevention::CancelIncoming);
+    setup_level(engine);
+
+    OrderPointer buy = make_order(10, OrderSide::Buy, 101, 30, 1);
+    engine.onNewOrder(buy);
+    REQUIRE(history.getTrades().size() == 1);
+    REQUIRE(book.getBuyOrders().empty());
+    REQUIRE(book.getSellOrders().at(100).front()->getOrderId() == 2);
+    REQUIRE(book.getOrders().size() == 2);
+}
+
+TEST_CASE("Cancel both removes the resting order and the incoming one") {
+    OrderBook book; TradeHistory history; MatchingEngine engine(book, history);
+    engine.setSelfTradePrevention(SelfTradePrevention::CancelBoth);
+    setup_level(engine);
+
+    engine.onNewOrder(make_order(10, OrderSide::Buy, 101, 30, 1));
+    REQUIRE(history.getTrades().size() == 1);
+    REQUIRE(book.getBuyOrders().empty());
+    REQUIRE(book.getSellOrders().count(100) == 0);
+    REQUIRE(book.getOrders().size() == 1);
+}
+
+TEST_CASE("Decrement takes the smaller quantity off both orders without a trade") {
+    OrderBook book; TradeHistory history; MatchingEngine engine(book, history);
+    engine.setSelfTradePrevention(SelfTradePrevention::Decrement);
+    setup_level(engine);
+
+    // 10 trades with participant 2, 10 is decremented away against the own order, 5 trades at 101
+    engine.onNewOrder(make_order(10, OrderSide::Buy, 101, 25, 1));
+    REQUIRE(history.getTrades().size() == 2);
+    REQUIRE(history.getTrades()[1]->sellOrderId_ == 3);
+    REQUIRE(history.getTrades()[1]->tradeQuantity_ == 5);
+    REQUIRE(book.getSellOrders().count(100) == 0);
+    REQUIRE(book.getBuyOrders().empty());
+
+    // The incoming order runs out first: the resting one is left smaller, in place
+    engine.onNewOrder(make_order(4, OrderSide::Sell, 101, 10, 1));
+    REQUIRE(book.getSellOrders().at(101).front()->getOrderId() == 3);
+    engine.onNewOrder(make_order(11, OrderSide::Buy, 101, 5, 3));
+    engine.onNewOrder(make_order(12, OrderSide::Buy, 101, 4, 1));
+    REQUIRE(history.getTrades().size() == 3);
+    auto& level = book.getSellOrders().at(101);
+    REQUIRE(level.front()->getOrderId() == 4);
+    REQUIRE(level.front()->getRemainingQuantity() == 6);
+    REQUIRE(level.totalQuantity() == 6);
+    REQUIRE(book.getBuyOrders().empty());
+}
+
+TEST_CASE("Orders without a participant are never treated as a self-match") {
+    OrderBook book; TradeHistory history; MatchingEngine engine(book, history);
+    engine.setSelfTradePrevention(SelfTradePrevention::CancelBoth);
+
+    engine.onNewOrder(make_order(1, OrderSide::Sell, 100, 10, 0));
+    engine.onNewOrder(make_order(2, OrderSide::Buy, 100, 10, 0, TimeInForce::ImmediateOrCancel));
+    REQUIRE(history.getTrades().size() == 1);
+}
+
+TEST_CASE("Self-trade prevention runs before a pro-rata level is shared out") {
+    OrderBook book; TradeHistory history; MatchingEngine engine(book, history);
+    engine.setMatchingAlgorithm(MatchingAlgorithm::ProRata);
+    engine.setSelfTradePrevention(SelfTradePrevention::CancelResting);
+
+    engine.onNewOrder(make_order(1, OrderSide::Sell, 100, 30, 2));
+    engine.onNewOrder(make_order(2, OrderSide::Sell, 100, 60, 1));
+    engine.onNewOrder(make_order(3, OrderSide::Sell, 100, 10, 3));
+
+    engine.onNewOrder(make_order(10, OrderSide::Buy, 100, 20, 1));
+    REQUIRE(history.getTrades().size() == 2);
+    REQUIRE(history.getTrades()[0]->sellOrderId_ == 1);
+    REQUIRE(history.getTrades()[0]->tradeQuantity_ == 15);
+    REQUIRE(history.getTrades()[1]->tradeQuantity_ == 5);
+    REQUIRE(book.getSellOrders().at(100).totalQuantity() == 20);
+}
+
+TEST_CASE("Fill-or-kill never part-fills because of self-trade prevention") {
+    auto mode = GENERATE(SelfTradePrevention::CancelResting, SelfTradePrevention::CancelIncoming,
+                         SelfTradePrevention::CancelBoth, SelfTradePrevention::Decrement);
+    auto algorithm = GENERATE(MatchingAlgorithm::Fifo, MatchingAlgorithm::ProRata);
+    OrderBook book; TradeHistory history; MatchingEngine engine(book, history);
+    engine.setSelfTradePrevention(mode);
+    engine.setMatchingAlgorithm(algorithm);
+    setup_level(engine);
+
+    // Only 20 of the 30 at or below 101 belong to someone else: killed whole, nothing touched
+    engine.onNewOrder(make_order(10, OrderSide::Buy, 101, 30, 1, TimeInForce::FillOrKill));
+    REQUIRE(history.getTrades().empty());
+    REQUIRE(book.getOrders().size() == 3);
+    REQUIRE(book.getBuyOrders().empty());
+
+    // 20 could fill, but only CancelResting gets past the own order in the way
+    engine.onNewOrder(make_order(11, OrderSide::Buy, 101, 20, 1, TimeInForce::FillOrKill));
+    if (mode == SelfTradePrevention::CancelResting) {
+        REQUIRE(history.getTrades().size() == 2);
+        REQUIRE(history.getTrades()[0]->sellOrderId_ == 1);
+        REQUIRE(history.getTrades()[1]->sellOrderId_ == 3);
+        REQUIRE(book.getOrders().empty());
+    } else {
+        REQUIRE(history.getTrades().empty());
+        REQUIRE(book.getOrders().size() == 3);
+    }
+    REQUIRE(book.getBuyOrders().empty());
+
+    // Filled ahead of the own order, every mode trades it
+    engine.onNewOrder(make_order(12, OrderSide::Sell, 99, 10, 3));
+    engine.onNewOrder(make_order(13, OrderSide::Buy, 101, 10, 1, TimeInForce::FillOrKill));
+    REQUIRE(history.getTrades().back()->sellOrderId_ == 12);
+    REQUIRE(history.getTrades().back()->tradeQuantity_ == 10);
+}
+
+TEST_CASE("Decrement against an iceberg comes off its shown slice") {
+    OrderBook book; TradeHistory history; MatchingEngine engine(book, history);
+    engine.setSelfTradePrevention(SelfTradePrevention::Decrement);
+
+    OrderPointer iceberg = make_order(1, OrderSide::Sell, 100, 50, 1);
+    iceberg->setDisplayQuantity(10);
+    engine.onNewOrder(iceberg);
+    engine.onNewOrder(make_order(2, OrderSide::Sell, 100, 10, 2));
+
+    // 10 decremented off the slice sends the iceberg behind participant 2 with a fresh slice, 10
+    // trades with participant 2, and the last 5 come off the new slice
+    engine.onNewOrder(make_order(10, OrderSide::Buy, 100, 25, 1));
+    REQUIRE(history.getTrades().size() == 1);
+    REQUIRE(history.getTrades()[0]->sellOrderId_ == 2);
+    REQUIRE(history.getTrades()[0]->tradeQuantity_ == 10);
+    REQUIRE(iceberg->getRemainingQuantity() == 35);
+    REQUIRE(iceberg->getFilledQuantity() == 0);
+    REQUIRE(iceberg->getVisibleQuantity() == 5);
+    REQUIRE(book.getSellOrders().at(100).totalQuantity() == 5);
+    REQUIRE(book.getBuyOrders().empty());
+}
@@ -0,0 +1,156 @@
+#include <catch2/catch_all.hpp>
+#include "order.h"
+#include "order_events.h"
+#include "orderbook.h"
+#include "sharded_matching_engine.h"
+#include "tradehistory.h"
+
+#include <memory>
+
+using namespace ob;
+
+static OrderRequest make_request(OrderId id, SymbolId symbol, OrderSide side, Price price, Quantity qty) {
+    return OrderRequest{id, symbol, OrderType::Limit, side, TimeInForce::GoodTillCancel, price, qty};
+}
+
+static void add_instruments(ShardedMatchingEngine<>& engine, SymbolId count) {
+    for (SymbolId symbol = 0; symbol < count; ++symbol) {
+        engine.addInstrument(symbol, std::make_unique<OrderBook>(), std::make_unique<RingTradeHistory>(64));
+    }
+}
+
+TEST_CASE("ShardedMatchingEngine matches each symbol in its own book") {
+    ShardedMatchingEngine<> engine({.numShards = 2, .queueCapacity = 16, .pinThreads = false});
+    add_instruments(engine, 4);
+    REQUIRE(engine.shardOf(3) == 1);
+
+    engine.start();
+    // Same price on every symbol, but only symbols 1 and 2 receive a crossing order
+    for (SymbolId symbol = 0; symbol < 4; ++symbol) {
+        engine.onNewOrder(make_request(100 + symbol, symbol, OrderSide::Sell, 100, 10));
+    }
+    engine.onNewOrder(make_request(201, 1, OrderSide::Buy, 100, 10));
+    engine.onNewOrder(make_request(202, 2, OrderSide::Buy, 100, 4));
+    engine.waitUntilIdle();
+
+    REQUIRE(engine.getHistory(0).empty());
+    REQUIRE(engine.getHistory(3).empty());
+    REQUIRE(engine.getHistory(1).size() == 1);
+    REQUIRE(engine.getHistory(1)[0].sellOrderId_ == 101);
+    REQUIRE(engine.getHistory(2)[0].tradeQuantity_ == 4);
+    REQUIRE(engine.getBook(1).getSellOrders().empty());
+    REQUIRE(engine.getBook(2).getSellOrders().at(100).totalQuantity() == 6);
+
+    engine.stop();
+    REQUIRE(engine.getHistory(2).size() == 1);
+}
+
+TEST_CASE("ShardedMatchingEngine routes cancels to the owning shard") {
+    ShardedMatchingEngine<> engine({.numShards = 3, .queueCapacity = 4, .pinThreads = false});
+    add_instruments(engine, 6);
+    engine.start();
+
+    // More messages than the queue holds, so the producer has to wait on the worker
+    for (OrderId id = 1; id <= 20; ++id) {
+        engine.onNewOrder(make_request(id, 5, OrderSide::Buy, 50 + static_cast<Price>(id), 1));
+    }
+    for (OrderId id = 1; id <= 19; ++id) {
+        engine.onCancelOrder(5, id);
+    }
+    engine.waitUntilIdle();
+
+    REQUIRE(engine.getBook(5).getOrders().size() == 1);
+    REQUIRE(engine.getBook(5).getBuyOrders().begin()->first == 70);
+    engine.stop();
+}
+
+TEST_CASE("ShardedMatchingEngine moves every shard's clock") {
+    ShardedMatchingEngine<> engine({.numShards = 2, .queueCapacity = 16, .pinThreads = false});
+    add_instruments(engine, 4);
+    engine.start();
+
+    engine.setSessionEnd(500);
+    for (SymbolId symbol = 0; symbol < 4; ++symbol) {
+        OrderRequest gtd = make_request(10 + symbol, symbol, OrderSide::Buy, 100, 10);
+        gtd.timeInForce = TimeInForce::GoodTillDate;
+        gtd.expireTime = 100 * (symbol + 1);
+        engine.onNewOrder(gtd);
+        OrderRequest day = make_request(20 + symbol, symbol, OrderSide::Buy, 99, 10);
+        day.timeInForce = TimeInForce::Day;
+        engine.onNewOrder(day);
+    }
+    engine.advanceTime(250);
+    engine.waitUntilIdle();
+
+    REQUIRE(engine.getBook(0).getOrders().size() == 1);
+    REQUIRE(engine.getBook(1).getOrders().size() == 1);
+    REQUIRE(engine.getBook(2).getOrders().size() == 2);
+    REQUIRE(engine.getBook(3).getOrders().size() == 2);
+
+    engine.advanceTime(500);
+    engine.waitUntilIdle();
+    for (SymbolId symbol = 0; symbol < 4; ++symbol) {
+        REQUIRE(engine.getBook(symbol).getOrders().size() == 0);
+    }
+    engine.stop();
+}
+
+TEST_CASE("ShardedMatchingEngine routes amends and mass cancels") {
+    ShardedMatchingEngine<> engine({.numShards = 2, .queueCapacity = 16, .pinThreads = false});
+    add_instruments(engine, 4);
+    engine.start();
+
+    for (SymbolId symbol = 0; symbol < 4; ++symbol) {
+        engine.onNewOrder(make_request(10 + symbol, symbol, OrderSide::Buy, 100, 10));
+        engine.onNewOrder(make_request(20 + symbol, symbol, OrderSide::Sell, 110, 10));
+    }
+    engine.onAmendOrder(1, 11, 101, 5);
+    engine.onAmendOrder(2, 12, 100, 0);
+    engine.onMassCancel(3, MassCancelFilter{ .side = OrderSide::Sell });
+    engine.waitUntilIdle();
+
+    REQUIRE(engine.getBook(1).getBuyOrders().begin()->first == 101);
+    REQUIRE(engine.getBook(1).getOrders().find(11)->second->getRemainingQuantity() == 5);
+    REQUIRE(engine.getBook(2).getBuyOrders().empty());
+    REQUIRE(engine.getBook(3).getSellOrders().empty());
+    REQUIRE(engine.getBook(3).getOrders().size() == 1);
+    REQUIRE(engine.getBook(0).getOrders().size() == 2);
+
+    // Without a symbol, every instrument on every shard
+    engine.onMassCancel(MassCancelFilter{ .side = OrderSide::Buy });
+    engine.waitUntilIdle();
+    for (SymbolId symbol = 0; symbol < 4; ++symbol) {
+        REQUIRE(engine.getBook(symbol).getBuyOrders().empty());
+    }
+    REQUIRE(engine.getBook(0).getOrders().size() == 1);
+    engine.stop();
+}
+
+TEST_CASE("ShardedOrderGateway rejects unknown symbols and validates before routing") {
+    ShardedMatchingEngine<> engine({.numShards = 2, .queueCapacity = 16, .pinThreads = false});
+    add_instruments(engine, 2);
+    ShardedOrderGateway gateway(engine);
+    engine.start();
+
+    REQUIRE(gateway.submitOrder(make_request(1, 7, OrderSide::Buy, 100, 10)).reason == OrderRejectionReason::InvalidSymbol);
+    REQUIRE(gateway.submitOrder(make_request(2, 1, OrderSide::Buy, 100, 0)).reason == OrderRejectionReason::InvalidQuantity);
+    REQUIRE(gateway.cancelOrder(9, 1).reason == OrderRejectionReason::InvalidSymbol);
+
+    REQUIRE(gateway.submitOrder(make_request(3, 1, OrderSide::Buy, 100, 10)).accepted);
+    REQUIRE(gateway.submitOrder(make_request(4, 1, OrderSide::Sell, 100, 10)).accepted);
+    engine.waitUntilIdle();
+
+    REQUIRE(engine.getHistory(1).size() == 1);
+    REQUIRE(engine.getHistory(0).empty());
+
+    REQUIRE(gateway.submitOrder(make_request(5, 0, OrderSide::Buy, 100, 10)).accepted);
+    REQUIRE(gateway.amendOrder(7, 5, 101, 4).reason == OrderRejectionReason::InvalidSymbol);
+    REQUIRE(gateway.amendOrder(0, 5, 0, 4).reason == OrderRejectionReason::InvalidPrice);
+    REQUIRE(gateway.amendOrder(0, 5, 101, 4).accepted);
+    engine.waitUntilIdle();
+    REQUIRE(engine.getBook(0).getBuyOrders().begin()->first == 101);
+    REQUIRE(gateway.amendOrder(0, 5, 0, 0).accepted);
+    engine.waitUntilIdle();
+    REQUIRE(engine.getBook(0).getOrders().empty());
+    engine.stop();
+}
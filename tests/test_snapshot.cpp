@@ -0,0 +1,114 @@
+#include <catch2/catch_all.hpp>
+#include "journal.h"
+#include "matching_engine.h"
+#include "order.h"
+#include "order_gateway.h"
+#include "orderbook.h"
+#include "snapshot.h"
+#include "tradehistory.h"
+#include "utils/object_pool.h"
+
+#include <filesystem>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace ob;
+
+static std::string temp_path(const std::string& name) {
+    auto path = std::filesystem::temp_directory_path() / ("orderbook_" + name);
+    std::filesystem::remove(path);
+    return path.string();
+}
+
+template <typename Book>
+static std::vector<std::tuple<OrderId, Price, Quantity, OrderStatus>> resting_orders(Book& book) {
+    std::vector<std::tuple<OrderId, Price, Quantity, OrderStatus>> orders;
+    for (const auto& [price, level] : book.getBuyOrders()) {
+        for (OrderPointer order : level) {
+            orders.emplace_back(order->getOrderId(), price, order->getRemainingQuantity(), order->getOrderStatus());
+        }
+    }
+    for (const auto& [price, level] : book.getSellOrders()) {
+        for (OrderPointer order : level) {
+            orders.emplace_back(order->getOrderId(), price, order->getRemainingQuantity(), order->getOrderStatus());
+        }
+    }
+    return orders;
+}
+
+static void submit_random_orders(OrderGateway& gateway, std::mt19937& rng, OrderId firstId, OrderId lastId) {
+    for (OrderId id = firstId; id <= lastId; ++id) {
+        if (id % 5 == 0) {
+            gateway.cancelOrder(id - 1 - rng() % 50);
+            continue;
+        }
+        OrderSide side = (rng() % 2 == 0) ? OrderSide::Buy : OrderSide::Sell;
+        gateway.submitOrder(ObjectPool::allocate(id, OrderType::Limit, side, TimeInForce::GoodTillCancel, 95 + rng() % 10, 1 + rng() % 20));
+    }
+}
+
+TEST_CASE("Snapshot plus journal tail restores the book") {
+    std::string journalPath = temp_path("snapshot_test.journal");
+    std::string snapshotPath = temp_path("snapshot_test.snapshot");
+
+    OrderBook book; TradeHistory history; MatchingEngine engine(book, history); OrderGateway gateway(engine);
+    std::mt19937 rng(11);
+    {
+        JournalWriter journal(journalPath, 32);
+        gateway.setJournal(&journal);
+        submit_random_orders(gateway, rng, 1, 1000);
+        writeSnapshot(book, snapshotPath, journal.lastSequence(), engine.getSessionEnd());
+        submit_random_orders(gateway, rng, 1001, 1500);
+        gateway.setJournal(nullptr);
+    }
+
+    OrderBook restored; TradeHistory restoredHistory; MatchingEngine restoredEngine(restored, restoredHistory);
+    SnapshotInfo info = loadSnapshot(restored, snapshotPath);
+    REQUIRE(info.journalSequence == 1000);
+    REQUIRE(info.orderCount == restored.getOrders().size());
+
+    JournalReader reader(journalPath);
+    reader.skip(info.journalSequence);
+    REQUIRE(replayJournal(reader, restoredEngine) == 500);
+
+    REQUIRE(resting_orders(restored) == resting_orders(book));
+    REQUIRE(restored.getBuyDepth()[0].quantity == book.getBuyDepth()[0].quantity);
+
+    std::filesystem::remove(journalPath);
+    std::filesystem::remove(snapshotPath);
+}
+
+TEST_CASE("Snapshot loads into a ladder book and rejects bad files") {
+    std::string snapshotPath = temp_path("snapshot_ladder.snapshot");
+
+    LadderOrderBook book{PriceBand{1, 1000, 1}};
+    book.addOrder(ObjectPool::allocate(1, OrderType::Limit, OrderSide::Sell, TimeInForce::GoodTillCancel, 105, 10));
+    book.addOrder(ObjectPool::allocate(2, OrderType::Limit, OrderSide::Sell, TimeInForce::GoodTillCancel, 105, 7));
+    book.addOrder(ObjectPool::allocate(3, OrderType::Limit, OrderSide::Buy, TimeInForce::GoodTillCancel, 99, 4));
+    OrderPointer stop = ObjectPool::allocate(4, OrderType::StopLimit, OrderSide::Sell, TimeInForce::GoodTillCancel, 95, 6);
+    stop->setStopPrice(97);
+    book.getStops().add(stop);
+    book.getStops().setLastTradePrice(102);
+    OrderPointer iceberg = ObjectPool::allocate(5, OrderType::Limit, OrderSide::Sell, TimeInForce::GoodTillCancel, 106, 30);
+    iceberg->setDisplayQuantity(10);
+    iceberg->setDisplayedQuantity(4);
+    iceberg->setParticipant(42);
+    book.addOrder(iceberg);
+    writeSnapshot(book, snapshotPath, 0, 0);
+
+    LadderOrderBook restored{PriceBand{1, 1000, 1}};
+    REQUIRE(loadSnapshot(restored, snapshotPath).orderCount == 5);
+    REQUIRE(resting_orders(restored) == resting_orders(book));
+    REQUIRE(restored.getStops().getSellStops().at(97).front()->getPrice() == 95);
+    REQUIRE(restored.getStops().getLastTradePrice() == 102);
+    REQUIRE(restored.getSellDepth()[1].quantity == 4);
+    REQUIRE(restored.getOrders().find(5)->second->getParticipant() == 42);
+    REQUIRE_THROWS_AS(loadSnapshot(restored, snapshotPath), std::logic_error);
+
+    std::filesystem::resize_file(snapshotPath, std::filesystem::file_size(snapshotPath) - 1);
+    LadderOrderBook empty{PriceBand{1, 1000, 1}};
+    REQUIRE_THROWS_AS(loadSnapshot(empty, snapshotPath), std::runtime_error);
+    std::filesystem::remove(snapshotPath);
+}
@@ -0,0 +1,107 @@
+#include <catch2/catch_all.hpp>
+#include "matching_engine.h"
+#include "order.h"
+#include "order_events.h"
+#include "order_gateway.h"
+#include "orderbook.h"
+#include "tradehistory.h"
+#include "utils/object_pool.h"
+
+#include <vector>
+
+using namespace ob;
+
+static OrderPointer make_order(OrderId id, OrderType type, OrderSide side, Price price, Quantity qty) {
+    return ObjectPool::allocate(id, type, side, TimeInForce::GoodTillCancel, price, qty);
+}
+
+static OrderPointer make_stop(OrderId id, OrderType type, OrderSide side, Price stopPrice, Price price, Quantity qty) {
+    OrderPointer order = make_order(id, type, side, price, qty);
+    order->setStopPrice(stopPrice);
+    return order;
+}
+
+static std::vector<std::pair<OrderId, Price>> sells_by_price(const TradeHistory& history) {
+    std::vector<std::pair<OrderId, Price>> trades;
+    for (TradePointer trade : history.getTrades()) {
+        trades.emplace_back(trade->sellOrderId_, trade->tradePrice_);
+    }
+    return trades;
+}
+
+TEST_CASE("A stop waits until a trade reaches its stop price") {
+    OrderBook book; TradeHistory history; MatchingEngine engine(book, history); OrderGateway gateway(engine);
+
+    gateway.submitOrder(make_order(1, OrderType::Limit, OrderSide::Sell, 101, 10));
+    gateway.submitOrder(make_order(2, OrderType::Limit, OrderSide::Sell, 102, 10));
+    REQUIRE(gateway.submitOrder(make_stop(3, OrderType::Stop, OrderSide::Buy, 101, 1, 5)).accepted);
+    REQUIRE(book.getStops().size() == 1);
+    REQUIRE(history.getTrades().empty());
+
+    // A trade at 101 triggers it, and it buys at the market like a market order
+    gateway.submitOrder(make_order(4, OrderType::Limit, OrderSide::Buy, 101, 2));
+    REQUIRE(book.getStops().empty());
+    REQUIRE(history.getTrades().size() == 2);
+    REQUIRE(history.getTrades()[1]->buyOrderId_ == 3);
+    REQUIRE(history.getTrades()[1]->buyOrderType_ == OrderType::Market);
+    REQUIRE(book.getSellOrders().at(101).totalQuantity() == 3);
+}
+
+TEST_CASE("Triggered stops cascade in sequence") {
+    OrderBook book; TradeHistory history; MatchingEngine engine(book, history); OrderGateway gateway(engine);
+
+    gateway.submitOrder(make_order(1, OrderType::Limit, OrderSide::Buy, 100, 5));
+    gateway.submitOrder(make_order(2, OrderType::Limit, OrderSide::Buy, 99, 5));
+    gateway.submitOrder(make_order(3, OrderType::Limit, OrderSide::Buy, 98, 5));
+    gateway.submitOrder(make_order(4, OrderType::Limit, OrderSide::Buy, 97, 20));
+
+    // Same stop price: arrival order. Different stop prices: the one nearer the market first.
+    gateway.submitOrder(make_stop(10, OrderType::Stop, OrderSide::Sell, 98, 1, 5));
+    gateway.submitOrder(make_stop(11, OrderType::Stop, OrderSide::Sell, 99, 1, 3));
+    gateway.submitOrder(make_stop(12, OrderType::Stop, OrderSide::Sell, 99, 1, 2));
+    REQUIRE(book.getStops().size() == 3);
+
+    // Prints 100: nothing triggers. Prints 99: 11 and 12 sell into 98, which triggers 10.
+    gateway.submitOrder(make_order(20, OrderType::Limit, OrderSide::Sell, 100, 5));
+    REQUIRE(book.getStops().size() == 3);
+    gateway.submitOrder(make_order(21, OrderType::Limit, OrderSide::Sell, 99, 5));
+
+    std::vector<std::pair<OrderId, Price>> expected {
+        {20, 100}, {21, 99}, {11, 98}, {12, 98}, {10, 97}
+    };
+    REQUIRE(sells_by_price(history) == expected);
+    REQUIRE(book.getStops().empty());
+    REQUIRE(book.getBuyOrders().at(97).totalQuantity() == 15);
+}
+
+TEST_CASE("Stop-limit orders rest at their limit once triggered") {
+    OrderBook book; TradeHistory history; MatchingEngine engine(book, history); OrderGateway gateway(engine);
+
+    gateway.submitOrder(make_order(1, OrderType::Limit, OrderSide::Sell, 105, 1));
+    gateway.submitOrder(make_order(2, OrderType::Limit, OrderSide::Sell, 110, 10));
+    gateway.submitOrder(make_stop(3, OrderType::StopLimit, OrderSide::Buy, 105, 106, 4));
+    gateway.submitOrder(make_order(4, OrderType::Limit, OrderSide::Buy, 105, 1));
+
+    REQUIRE(book.getStops().empty());
+    REQUIRE(book.getBuyOrders().at(106).front()->getOrderId() == 3);
+    REQUIRE(book.getBuyOrders().at(106).front()->getOrderType() == OrderType::Limit);
+
+    // The last trade is already through this stop price, so it does not wait
+    gateway.submitOrder(make_stop(5, OrderType::StopLimit, OrderSide::Buy, 104, 104, 2));
+    REQUIRE(book.getStops().empty());
+    REQUIRE(book.getBuyOrders().at(104).size() == 1);
+}
+
+TEST_CASE("Dormant stops can be cancelled and are validated") {
+    OrderBook book; TradeHistory history; MatchingEngine engine(book, history); OrderGateway gateway(engine);
+
+    gateway.submitOrder(make_stop(1, OrderType::Stop, OrderSide::Sell, 90, 1, 5));
+    gateway.submitOrder(make_stop(2, OrderType::Stop, OrderSide::Sell, 90, 1, 5));
+    gateway.cancelOrder(1);
+    REQUIRE(book.getStops().size() == 1);
+    REQUIRE(book.getStops().getSellStops().at(90).front()->getOrderId() == 2);
+
+    OrderPointer noStopPrice = make_order(3, OrderType::StopLimit, OrderSide::Buy, 100, 5);
+    REQUIRE(gateway.submitOrder(noStopPrice).reason == OrderRejectionReason::InvalidPrice);
+    ObjectPool::release(noStopPrice);
+}
@@ -0,0 +1,78 @@
+#include <catch2/catch_all.hpp>
+#include "matching_engine.h"
+#include "order.h"
+#include "orderbook.h"
+#include "tradehistory.h"
+
+#include <vector>
+
+using namespace ob;
+
+static Trade make_trade(OrderId buyId, Quantity qty) {
+    return Trade{buyId, buyId + 1000, 100, qty,
+                 100, OrderType::Limit, TimeInForce::GoodTillCancel,
+                 100, OrderType::Limit, TimeInForce::GoodTillCancel};
+}
+
+TEST_CASE("RingTradeHistory overwrites the oldest trades when full") {
+    RingTradeHistory history(4);
+    for (OrderId id = 1; id <= 6; ++id) {
+        history.recordTrade(make_trade(id, 10));
+    }
+
+    REQUIRE(history.size() == 4);
+    REQUIRE(history.totalRecorded() == 6);
+
+    std::vector<OrderId> ids;
+    for (const Trade& trade : history) {
+        ids.push_back(trade.buyOrderId_);
+    }
+    REQUIRE(ids == std::vector<OrderId>{3, 4, 5, 6});
+
+    auto [first, second] = history.getTrades();
+    REQUIRE(first.size() + second.size() == 4);
+    REQUIRE(first.front().buyOrderId_ == 3);
+    REQUIRE(second.back().buyOrderId_ == 6);
+}
+
+TEST_CASE("RingTradeHistory flushes every buffered trade in order when full") {
+    std::vector<OrderId> flushed;
+    RingTradeHistory history(4, TradeOverflowPolicy::Flush, [&](std::span<const Trade> trades) {
+        for (const Trade& trade : trades) {
+            flushed.push_back(trade.buyOrderId_);
+        }
+    });
+
+    for (OrderId id = 1; id <= 9; ++id) {
+        history.recordTrade(make_trade(id, 10));
+    }
+
+    REQUIRE(flushed == std::vector<OrderId>{1, 2, 3, 4, 5, 6, 7, 8});
+    REQUIRE(history.size() == 1);
+    REQUIRE(history[0].buyOrderId_ == 9);
+
+    history.flush();
+    REQUIRE(flushed.back() == 9);
+    REQUIRE(history.empty());
+}
+
+TEST_CASE("RingTradeHistory with Flush policy requires a callback") {
+    REQUIRE_THROWS_AS(RingTradeHistory(4, TradeOverflowPolicy::Flush), std::invalid_argument);
+}
+
+TEST_CASE("Engine records trades by value into a RingTradeHistory") {
+    OrderBook book; RingTradeHistory history(16);
+    BasicMatchingEngine<OrderBook, RingTradeHistory> engine(book, history);
+
+    book.addOrder(new Order{1, OrderType::Limit, OrderSide::Sell, TimeInForce::GoodTillCancel, 99, 10});
+    book.addOrder(new Order{2, OrderType::Limit, OrderSide::Sell, TimeInForce::GoodTillCancel, 100, 10});
+    engine.onNewOrder(new Order{3, OrderType::Limit, OrderSide::Buy, TimeInForce::GoodTillCancel, 100, 15});
+
+    REQUIRE(history.size() == 2);
+    REQUIRE(history[0].sellOrderId_ == 1);
+    REQUIRE(history[0].tradePrice_ == 99);
+    REQUIRE(history[0].tradeQuantity_ == 10);
+    REQUIRE(history[1].sellOrderId_ == 2);
+    REQUIRE(history[1].buyOrderId_ == 3);
+    REQUIRE(history[1].tradeQuantity_ == 5);
+}